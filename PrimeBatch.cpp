@@ -0,0 +1,178 @@
+// 素数判定のバッチ処理（Linux用コマンドライン版）
+//
+// ファイルまたは標準入力から1行に1つずつ10進数を読み込み、
+// NTLのスレッドプールを使って全コアで素数判定を行う。
+// 各行について「行番号 判定結果 所要時間(ms)」を標準出力へ書き出し、
+// 最後に処理件数・スループット・レイテンシを標準エラー出力へ書き出す。
+//
+// 使い方:
+//   primebatch [-t スレッド数] [-n 試行回数] [-b バッチサイズ] [ファイル...]
+//
+// ビルド（同梱のWinNTLとともにビルドし、tests/primes.txt でスモークテストを行う）:
+//   cmake -S . -B build && cmake --build build && ctest --test-dir build
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace NTL;
+
+struct BatchStats
+{
+	long count;
+	long primes;
+	long invalid;
+	std::vector<double> latency;
+
+	BatchStats() : count(0), primes(0), invalid(0) {}
+};
+
+// 前後の空白を取り除き、10進数として正しければ1を返す
+static long ParseNumber(std::string& s)
+{
+	size_t b = s.find_first_not_of(" \t\r");
+	if (b == std::string::npos) { s.clear(); return 0; }
+	size_t e = s.find_last_not_of(" \t\r");
+	s = s.substr(b, e - b + 1);
+	for (size_t i = 0; i < s.size(); i++)
+		if (s[i] < '0' || s[i] > '9') return 0;
+	return 1;
+}
+
+// たまった数をまとめて判定し、結果を入力の順に書き出す
+// （line[i] < 0 は不正な行 -line[i] を表す）
+static void Flush(Vec<ZZ>& num, std::vector<long>& line, long trials, BatchStats& st)
+{
+	Vec<long> res;
+	Vec<double> tm;
+	ProbPrime(res, tm, num, trials);
+
+	long j = 0;
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		if (line[i] < 0)
+		{
+			printf("%ld\tinvalid\t0\n", -line[i]);
+			st.invalid++;
+			continue;
+		}
+		printf("%ld\t%s\t%.3f\n", line[i], res[j] ? "prime" : "not-prime", tm[j] * 1e3);
+		st.count++;
+		st.primes += res[j];
+		st.latency.push_back(tm[j]);
+		j++;
+	}
+
+	num.SetLength(0);
+	line.clear();
+}
+
+static void Process(std::istream& in, long& lineno, long batch, long trials, BatchStats& st)
+{
+	Vec<ZZ> num;
+	std::vector<long> line;
+	std::string s;
+
+	while (std::getline(in, s))
+	{
+		lineno++;
+		if (!ParseNumber(s))
+		{
+			// 空行と#で始まる行は読み飛ばす
+			if (!s.empty() && s[0] != '#')
+				line.push_back(-lineno);
+			continue;
+		}
+		num.append(conv<ZZ>(s.c_str()));
+		line.push_back(lineno);
+		if (num.length() >= batch)
+			Flush(num, line, trials, st);
+	}
+	Flush(num, line, trials, st);
+}
+
+static double Percentile(const std::vector<double>& v, double q)
+{
+	if (v.empty()) return 0;
+	size_t i = (size_t)(q * (v.size() - 1) + 0.5);
+	return v[i];
+}
+
+static void Usage()
+{
+	fprintf(stderr, "usage: primebatch [-t threads] [-n trials] [-b batch] [file...]\n");
+	exit(2);
+}
+
+int main(int argc, char** argv)
+{
+	long threads = std::thread::hardware_concurrency();
+	long trials = 10;
+	long batch = 4096;
+	std::vector<const char*> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-t") && i + 1 < argc) threads = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-n") && i + 1 < argc) trials = atol(argv[++i]);
+		else if (!strcmp(argv[i], "-b") && i + 1 < argc) batch = atol(argv[++i]);
+		else if (argv[i][0] == '-' && argv[i][1]) Usage();
+		else files.push_back(argv[i]);
+	}
+	if (threads < 1) threads = 1;
+	if (trials < 0) trials = 0;
+	if (batch < 1) batch = 1;
+
+	SetNumThreads(threads);
+
+	BatchStats st;
+	long lineno = 0;
+	double t = GetWallTime();
+
+	if (files.empty())
+		Process(std::cin, lineno, batch, trials, st);
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		lineno = 0;
+		if (!strcmp(files[i], "-"))
+		{
+			Process(std::cin, lineno, batch, trials, st);
+			continue;
+		}
+		std::ifstream in(files[i]);
+		if (!in)
+		{
+			fprintf(stderr, "primebatch: cannot open %s\n", files[i]);
+			return 1;
+		}
+		Process(in, lineno, batch, trials, st);
+	}
+
+	t = GetWallTime() - t;
+
+	// スループットとレイテンシの集計
+	std::sort(st.latency.begin(), st.latency.end());
+	double sum = 0;
+	for (size_t i = 0; i < st.latency.size(); i++) sum += st.latency[i];
+
+	fprintf(stderr, "numbers: %ld (primes %ld, invalid %ld), threads: %ld\n",
+		st.count, st.primes, st.invalid, threads);
+	fprintf(stderr, "wall time: %.3f s, throughput: %.1f numbers/s\n",
+		t, t > 0 ? st.count / t : 0.0);
+	fprintf(stderr, "latency ms: mean %.3f, p50 %.3f, p99 %.3f, max %.3f\n",
+		st.count ? sum / st.count * 1e3 : 0.0,
+		Percentile(st.latency, 0.5) * 1e3,
+		Percentile(st.latency, 0.99) * 1e3,
+		st.latency.empty() ? 0.0 : st.latency.back() * 1e3);
+
+	return 0;
+}
@@ -19,48 +19,31 @@
 
 using namespace NTL;
 
+#define WM_PRIMETEST_DONE (WM_APP + 1)
+
 TCHAR szClassName[] = TEXT("Window");
 
-long witness(const ZZ& n, const ZZ& x)
+long PrimeTest(const ZZ& n)
 {
-	ZZ m, y, z;
-	long j, k;
-	if (x == 0)return 0;
-	m = n - 1;
-	k = MakeOdd(m);
-	z = PowerMod(x, m, n);//z=x^m%n
-	if (z == 1)return 0;
-	j = 0;
-	do
-	{
-		y = z;
-		z = (y*y) % n;
-		j++;
-	} while (j<k&&z != 1);
-	return z != 1 || y != n - 1;
+	// Baillie-PSWeXgifł̎A2Miller-RabineXgALucaseXgj
+	return ProbPrimeBPSW(n);
 }
 
-long PrimeTest(const ZZ& n, long t)
+struct PrimeTestParam
 {
-	if (n <= 1)return 0;
-	PrimeSeq s;
-	long p;
-	p = s.next();
-	while (p&&p<10000)
-	{// fŊĂ݂
-		if ((n%p) == 0)return(n == p);
-		p = s.next();
-	}
-	// Miller-RabineXgts
-	ZZ x;
-	long i;
-	for (i = 0; i<t; i++)
-	{
-		x = RandomBnd(n);//0n-1܂ł̃_Ȑ
-		if (witness(n, x))
-			return 0;
-	}
-	return 1;
+	HWND hWnd;
+	ZZ n;
+};
+
+// ʃXbhőfsAʂEBhEɒʒm
+// iBaillie-PSWeXg͒Ȃ̂ŁAXbhv[͎gȂj
+DWORD WINAPI PrimeTestThread(LPVOID lpParam)
+{
+	PrimeTestParam* param = (PrimeTestParam*)lpParam;
+	long result = PrimeTest(param->n);
+	PostMessage(param->hWnd, WM_PRIMETEST_DONE, (WPARAM)result, 0);
+	delete param;
+	return 0;
 }
 
 LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
@@ -96,30 +79,49 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	case WM_COMMAND:
 		if (LOWORD(wParam) == IDOK)
 		{
-			ZZ n;
+			PrimeTestParam* param = new PrimeTestParam;
+			param->hWnd = hWnd;
 			int len = GetWindowTextLength(hEdit1) + 1;
 			LPSTR str = (LPSTR)GlobalAlloc(GMEM_FIXED, len);
 			GetWindowTextA(hEdit1, str, len);
-			conv(n, str);
+			conv(param->n, str);
 			GlobalFree(str);
-			if (PrimeTest(n, 10))
+			// vZ̓{^𖳌ɂAUIXbh~߂Ȃ悤ɕʃXbhŔ肷
+			EnableWindow(hButton, FALSE);
+			SetWindowText(hButton, TEXT("vZ..."));
+			HANDLE hThread = CreateThread(0, 0, PrimeTestThread, param, 0, 0);
+			if (hThread)
 			{
-				MessageBox(
-					hWnd,
-					TEXT("f̉\܂B"),
-					TEXT("mF"),
-					0);
+				CloseHandle(hThread);
 			}
 			else
 			{
-				MessageBox(
-					hWnd,
-					TEXT("łB"),
-					TEXT("mF"),
-					0);
+				delete param;
+				EnableWindow(hButton, TRUE);
+				SetWindowText(hButton, TEXT("vZ"));
 			}
 		}
 		break;
+	case WM_PRIMETEST_DONE:
+		EnableWindow(hButton, TRUE);
+		SetWindowText(hButton, TEXT("vZ"));
+		if (wParam)
+		{
+			MessageBox(
+				hWnd,
+				TEXT("f̉\܂B"),
+				TEXT("mF"),
+				0);
+		}
+		else
+		{
+			MessageBox(
+				hWnd,
+				TEXT("łB"),
+				TEXT("mF"),
+				0);
+		}
+		break;
 	case WM_DESTROY:
 		PostQuitMessage(0);
 		break;
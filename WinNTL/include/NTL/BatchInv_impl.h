@@ -0,0 +1,158 @@
+
+#ifndef NTL_BatchInv_impl__H
+#define NTL_BatchInv_impl__H
+
+#include <NTL/vector.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_OPEN_NNS
+
+
+// Batch inversion (Montgomery's trick):  with c[i] the product of 
+// the nonzero a[0..i], one inversion of c[n-1], followed by 
+// u = 1/c[i], x[i] = u*c[i-1], u = u*a[i] for i = n-1, ..., 0, gives
+// all the inverses for 3(n-1) multiplications.  Zero entries count
+// as 1 in the products.  For a large vector, the chunks of a 
+// partition are processed in parallel, with the chunk products 
+// inverted by the same trick.
+//
+// This is shared by the BatchInv routines for vec_ZZ_p, vec_zz_p,
+// vec_ZZ_pE and vec_GF2E.  T is the element type, and Context is a
+// class with save() and restore() that installs the moduli T depends
+// on in the worker threads.
+
+#define NTL_BATCHINV_CHUNK (64)
+// the least number of entries per chunk
+
+// c[i] = product of the nonzero a[lo..i], for lo <= i < hi
+template<class T>
+void BatchInvPrefix(T *c, const T *a, long lo, long hi)
+{
+   bool first = true;
+
+   for (long i = lo; i < hi; i++) {
+      if (IsZero(a[i])) {
+         if (first) set(c[i]); else c[i] = c[i-1];
+      }
+      else {
+         if (first) c[i] = a[i]; else mul(c[i], c[i-1], a[i]);
+         first = false;
+      }
+   }
+}
+
+// x[i] = 1/a[i] for lo <= i < hi, or 0 if a[i] = 0, 
+// given u = 1/c[hi-1];  x may alias a
+template<class T>
+void BatchInvBackward(T *x, long *status, const T *a, const T *c,
+                      long lo, long hi, const T& u_in)
+{
+   T u, t;
+   u = u_in;
+
+   for (long i = hi-1; i >= lo; i--) {
+      if (IsZero(a[i])) {
+         clear(x[i]);
+         if (status) status[i] = 0;
+         continue;
+      }
+
+      if (i > lo) 
+         mul(t, u, c[i-1]);
+      else
+         t = u;
+
+      mul(u, u, a[i]);
+      x[i] = t;
+      if (status) status[i] = 1;
+   }
+}
+
+template<class T>
+void BatchInvSeq(T *x, long *status, const T *a, T *c, long n)
+{
+   T u;
+
+   BatchInvPrefix(c, a, 0, n);
+   inv(u, c[n-1]);
+   BatchInvBackward(x, status, a, c, 0, n, u);
+}
+
+// x[i] = 1/a[i];  status == 0 means that every a[i] must be nonzero,
+// and otherwise status[i] records whether a[i] != 0.  The parallel
+// version is used only if seq is false.
+template<class T, class Context>
+void BatchInvAux(Vec<T>& x, long *status, const Vec<T>& a, bool seq)
+{
+   long n = a.length();
+
+   if (!status) {
+      for (long i = 0; i < n; i++) {
+         if (IsZero(a[i])) {
+            T t;
+            inv(t, a[i]);  // raises the usual error
+         }
+      }
+   }
+
+   x.SetLength(n);
+   if (n == 0) return;
+
+   Vec<T> c;
+   c.SetLength(n);
+
+   const T *ap = a.elts();
+   T *xp = x.elts();
+   T *cp = c.elts();
+
+   long nc = min(AvailableThreads(), n/NTL_BATCHINV_CHUNK);
+
+   if (nc <= 1 || seq) {
+      BatchInvSeq(xp, status, ap, cp, n);
+      return;
+   }
+
+   Context context;
+   context.save();
+
+   // chunk j is [j*n/nc, (j+1)*n/nc)
+
+   NTL_EXEC_RANGE(nc, first, last)
+   NTL_IMPORT(n)
+   NTL_IMPORT(nc)
+
+      context.restore();
+
+      for (long j = first; j < last; j++)
+         BatchInvPrefix(cp, ap, (j*n)/nc, ((j+1)*n)/nc);
+
+   NTL_EXEC_RANGE_END
+
+   Vec<T> P, Pinv, Pc;
+   P.SetLength(nc);
+   Pinv.SetLength(nc);
+   Pc.SetLength(nc);
+   for (long j = 0; j < nc; j++)
+      P[j] = c[((j+1)*n)/nc - 1];
+
+   BatchInvSeq(Pinv.elts(), (long *) 0, P.elts(), Pc.elts(), nc);
+
+   const T *Pinvp = Pinv.elts();
+
+   NTL_EXEC_RANGE(nc, first, last)
+   NTL_IMPORT(n)
+   NTL_IMPORT(nc)
+
+      context.restore();
+
+      for (long j = first; j < last; j++)
+         BatchInvBackward(xp, status, ap, cp, (j*n)/nc, ((j+1)*n)/nc, 
+                          Pinvp[j]);
+
+   NTL_EXEC_RANGE_END
+}
+
+
+NTL_CLOSE_NNS
+
+#endif
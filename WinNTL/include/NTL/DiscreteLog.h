@@ -0,0 +1,50 @@
+
+#ifndef NTL_DiscreteLog__H
+#define NTL_DiscreteLog__H
+
+#include <NTL/ZZ_p.h>
+#include <NTL/GF2E.h>
+#include <NTL/pair_ZZ_long.h>
+
+NTL_OPEN_NNS
+
+/**************************************************************
+
+   Discrete logarithms
+
+**************************************************************/
+
+
+long DiscreteLog(ZZ& x, const ZZ_p& a, const ZZ_p& g);
+long DiscreteLog(ZZ& x, const ZZ_p& a, const ZZ_p& g,
+                 const vec_pair_ZZ_long& N);
+// p = ZZ_p::modulus() is prime, and g != 0.  If a is a power of g,
+// returns 1, with x the least nonnegative integer such that
+// g^x = a;  otherwise, returns 0.  In the second form, N is the
+// factorization of a multiple of the order of g (such as p-1);
+// in the first, N is computed from the factorization of p-1.
+
+long DiscreteLog(ZZ& x, const GF2E& a, const GF2E& g);
+long DiscreteLog(ZZ& x, const GF2E& a, const GF2E& g,
+                 const vec_pair_ZZ_long& N);
+// the same, with GF2E::modulus() irreducible of degree k, and
+// p-1 replaced by 2^k-1.
+
+// The order of g is reduced to its factors, and the problem is split
+// into problems in subgroups of prime order q by Pohlig-Hellman.
+// Each of these is solved by baby-step giant-step, with a hash
+// table of about sqrt(q) powers of the generator, if
+// sqrt(q) <= DiscreteLogBSGSMax, and otherwise by Pollard's rho
+// method, with walks running concurrently using NTL's thread pool
+// and collisions detected through distinguished points.
+// The giant steps of baby-step giant-step are also run concurrently.
+
+extern NTL_CHEAP_THREAD_LOCAL long DiscreteLogBSGSMax;
+// the largest sqrt(q) (rounded down) for which baby-step giant-step
+// is used;  its table then has up to DiscreteLogBSGSMax+1 entries.
+// The default is 2^20.
+
+
+NTL_CLOSE_NNS
+
+#endif
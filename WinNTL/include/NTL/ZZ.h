@@ -810,6 +810,22 @@ long GCD(long a, long b);
 void XGCD(long& d, long& s, long& t, long a, long b);
 
 
+void BatchGCD(Vec<ZZ>& g, const Vec<ZZ>& a);
+// g[i] = gcd(a[i], product of the a[j] for j != i), for a[i] > 0.
+// This is Bernstein's batch GCD:  a product tree of the a[i] is
+// reduced down a remainder tree modulo the squares of its nodes,
+// giving P mod a[i]^2, where P is the product of all the a[i], and
+// g[i] = gcd((P mod a[i]^2)/a[i], a[i]).  The cost is quasi-linear 
+// in the total size of the a[i].  Each level of the trees is spread
+// over NTL's thread pool.
+
+extern NTL_CHEAP_THREAD_LOCAL double BatchGCDFileThresh;
+// if the product tree of BatchGCD exceeds BatchGCDFileThresh KB, 
+// its levels are written to temporary files as they are built, and
+// read back one at a time on the way down, so that only about two 
+// levels are in memory at once.  The default is 1000000 (about 1GB).
+
+
 
 
 
@@ -885,6 +901,12 @@ inline long bit(const ZZ& a, long k)
 
    { return _ntl_gbit(a.rep, k); }
 
+inline long bits(const ZZ& a, long k, long w)
+// returns bits k..k+w-1 of |a|, as a number in [0, 2^w);  
+// 0 <= w < NTL_BITS_PER_LONG.  Used to read an exponent in windows.
+
+   { return _ntl_gbits(a.rep, k, w); }
+
 #ifndef NTL_GMP_LIP
 
 // only defined for the "classic" long integer package, for backward
@@ -1162,8 +1184,10 @@ public:
       }
    }
 
-   // FIXME: document this? Not sure if I want to 
-   // commit to this interface, as it is somewhat ChaCha-specific
+   // Restarts the stream at the beginning of the substream with 
+   // the given nonce: streams with the same key and different
+   // nonces are independent.  Only the low NTL_BITS_PER_NONCE bits 
+   // of the nonce are used.  See also RandomSubstreamPush below.
    void set_nonce(unsigned long nonce) 
    {
       RandomStream_impl_set_nonce(*impl, nonce);
@@ -1250,6 +1274,30 @@ public:
 };
 
 
+// RAII for switching to a substream:  the current stream is saved,
+// and replaced by the one obtained from SetSeed(seed) followed by
+// set_nonce(nonce).  Typically, seed is drawn once from the current
+// stream (say, by RandomBits(seed, 256)) before a parallel region,
+// and each task uses its own nonce (say, its index), so that the
+// results do not depend on the number of threads.
+
+class RandomSubstreamPush {
+private: 
+   RandomStreamPush push;
+
+   RandomSubstreamPush(const RandomSubstreamPush&); // disable
+   void operator=(const RandomSubstreamPush&); // disable
+
+public:
+   RandomSubstreamPush(const ZZ& seed, unsigned long nonce) 
+   {
+      SetSeed(seed);
+      GetCurrentRandomStream().set_nonce(nonce);
+   }
+
+};
+
+
 
 void RandomBnd(ZZ& x, const ZZ& n);
 // x = "random number" in the range 0..n-1, or 0  if n <= 0
@@ -1338,20 +1386,34 @@ struct RandomBndGenerator {
 };
 
 
-inline void VectorRandomBnd(long k, long* x, long n)
-{
-   if (k <= 0) return;
-   if (n <= 1) {
-      for (long i = 0; i < k; i++) x[i] = 0;
-   }
-   else {
-      RandomBndGenerator gen(n);
-      for (long i = 0; i < k; i++) x[i] = gen.next();
-   }
-}
+void VectorRandomBnd(long k, long* x, long n);
+void VectorRandomWord(long k, unsigned long* x);
+// x[i] = RandomBnd(n) (resp. RandomWord()), for 0 <= i < k.
+// The bytes are taken from the stream in blocks, and the
+// results are the same as those of k single calls.
 
 
-void VectorRandomWord(long k, unsigned long* x);
+void VectorRandomBnd(long k, ZZ* x, const ZZ& n);
+// x[i] = "random number" in the range 0..n-1 (or 0 if n <= 1), 
+// for 0 <= i < k.  The stream is read in blocks, rather than a
+// few bytes per candidate.  The results are the same as those
+// of k calls to RandomBnd.
+
+void VectorRandomBnd(long k, ZZ* const *x, const ZZ& n);
+// the same, with outputs *x[i];  this is for elements that are
+// not stored in an array of ZZ's, such as ZZ_p's
+
+void VectorRandomBits(long k, ZZ* x, long NumBits);
+// x[i] = "random number", 0 <= x[i] < 2^NumBits, for 0 <= i < k.
+// The results are the same as those of k calls to RandomBits.
+
+// For large outputs (k*NumBytes(n) or k*NumBits/8 of at least 256KB), 
+// both of these instead split x into blocks, and generate the blocks 
+// concurrently using NTL's thread pool:  a seed is drawn from the
+// current stream, and block i is taken from the substream with
+// this seed and nonce i (see RandomSubstreamPush).  The results
+// then differ from those of k single calls, but still depend only
+// on the current stream, and not on the number of threads.
 
 
 /**********************************************************
@@ -1411,6 +1473,9 @@ inline ZZ GenPrime_ZZ(long l, long err = 80)
 long GenPrime_long(long l, long err = 80);
 // This generates a random prime n of length l so that the
 // probability of erroneously returning a composite is bounded by 2^(-err).
+// NOTE: for l <= 64, GenPrime and GenPrime_long test candidates with
+// the exact ProbPrime below 2^64, which draws no random witnesses
+// (see ProbPrime(long) below).
 
 void GenGermainPrime(ZZ& n, long l, long err = 80);
 inline ZZ GenGermainPrime_ZZ(long l, long err = 80) 
@@ -1424,11 +1489,75 @@ long ProbPrime(const ZZ& n, long NumTrials = 10);
 // tests if n is prime;  performs a little trial division,
 // followed by a single-precision MillerWitness test, followed by
 // up to NumTrials general MillerWitness tests.
+// For n < 2^64, the result is always correct (see ProbPrimeBPSW), 
+// and NumTrials is ignored.  For n of 1024 bits or more that pass
+// the test with witness 2, the NumTrials random witnesses are tested
+// concurrently using NTL's thread pool, stopping once one of them
+// proves n composite.  They are derived from 256 random bits drawn
+// from the current random stream, so the result does not depend on
+// the number of threads, and the stream advances by 256 bits whatever
+// the result.  Otherwise, one witness is drawn at a time, as needed.
+
+long ProbPrimeBPSW(const ZZ& n);
+// tests if n is prime with the Baillie-PSW test:  a little trial
+// division, followed by MillerWitness(n, 2), followed by
+// StrongLucasTest(n).  The cost is about that of three MillerWitness
+// tests.  No composite is known to pass, and there is none < 2^64.
+// For n of 1024 bits or more, the two tests run concurrently.
+
+void ProbPrime(Vec<long>& res, const Vec<ZZ>& n, long NumTrials = 10);
+void ProbPrime(Vec<long>& res, Vec<double>& tm, const Vec<ZZ>& n, 
+               long NumTrials = 10);
+// res[i] = ProbPrime(n[i], NumTrials) for each i, and tm[i] is the 
+// wall-clock time in seconds spent on n[i].  The numbers are handed
+// out one at a time to the threads of NTL's thread pool as they 
+// become free, so that a few large numbers do not hold up the rest.
+// The results do not depend on the number of threads.
 
 long MillerWitness(const ZZ& n, const ZZ& w);
 // Tests if w is a witness to primality a la Miller.
 // Assumption: n is odd and positive, 0 <= w < n.
 
+long StrongLucasTest(const ZZ& n);
+// strong Lucas probable prime test, with Selfridge's parameters:
+// D is the first of 5, -7, 9, -11, ... with Jacobi(D, n) = -1,
+// P = 1 and Q = (1-D)/4.  Returns 1 if n passes, and 0 if n is 
+// found to be composite.  All primes pass.
+
+long MersenneTest(long p);
+// returns 1 if 2^p-1 is prime, and 0 otherwise, using the
+// Lucas-Lehmer test.  For p of 26000 or more, the squarings mod
+// 2^p-1 use a double-precision irrational-base discrete weighted
+// transform (IBDWT), with each result checked for roundoff error;
+// any squaring that fails the check is redone exactly.
+
+long ProthTest(const ZZ& k, long n);
+// returns 1 if N = k*2^n+1 is prime, and 0 otherwise (k > 0, 
+// n >= 0).  If k < 2^n (after moving the factors of 2 in k into
+// 2^n), this is Proth's test:  N is prime iff a^((N-1)/2) = -1 mod N,
+// for the first prime a with Jacobi(a, N) = -1.  Otherwise, it is
+// ProbPrime(N).
+
+long LLRTest(const ZZ& k, long n);
+// returns 1 if N = k*2^n-1 is prime, and 0 otherwise (k > 0, 
+// n >= 0).  If k < 2^n (after moving the factors of 2 in k into
+// 2^n), this is the Lucas-Lehmer-Riesel test, with the starting
+// value V_k(P) of Rodseth:  P is the first integer >= 3 with 
+// Jacobi(P-2, N) = 1 and Jacobi(P+2, N) = -1.  For k = 1, it is
+// MersenneTest(n).  Otherwise, it is ProbPrime(N).
+// The squarings in ProthTest and LLRTest use the special-form 
+// reduction of PowerMod.
+
+long TrialDivision(const ZZ& n, long bnd);
+// returns 1 if n is divisible by a prime p < bnd other than n itself,
+// and 0 otherwise.  The primes are processed in blocks, using one
+// multi-precision remainder per block;  for n of 8192 bits or more,
+// the blocks are processed concurrently using NTL's thread pool.
+
+void TrialDivision(Vec<long>& res, const Vec<ZZ>& n, long bnd);
+// res[i] = TrialDivision(n[i], bnd) for each i; a remainder tree
+// makes this much faster than testing the n[i] one at a time.
+
 void RandomPrime(ZZ& n, long l, long NumTrials=10);
 // n =  random l-bit prime
 
@@ -1436,7 +1565,8 @@ inline ZZ RandomPrime_ZZ(long l, long NumTrials=10)
    { ZZ x; RandomPrime(x, l, NumTrials); NTL_OPT_RETURN(ZZ, x); }
 
 void NextPrime(ZZ& n, const ZZ& m, long NumTrials=10);
-// n = smallest prime >= m.
+// n = smallest prime >= m.  For large m, the candidates are sieved
+// a window at a time before any Miller-Rabin testing.
 
 inline ZZ NextPrime(const ZZ& m, long NumTrials=10)
    { ZZ x; NextPrime(x, m, NumTrials); NTL_OPT_RETURN(ZZ, x); }
@@ -1444,7 +1574,15 @@ inline ZZ NextPrime(const ZZ& m, long NumTrials=10)
 // single-precision versions
 
 long ProbPrime(long n, long NumTrials = 10);
-
+// always correct;  NumTrials is ignored.
+// NOTE: unlike earlier NTL versions, this, and ProbPrime(const ZZ&)
+// for n < 2^64, draws no random witnesses.  So RandomPrime_long and
+// GenPrime_long (and RandomPrime and GenPrime for l <= 64) consume
+// less of the random stream than before.  For a fixed seed, the
+// prime returned by the first call is normally the same as before.
+// Later random values differ, including the primes returned by
+// later calls.  This holds for any l >= 5 (smaller primes are found
+// by trial division alone).
 
 long RandomPrime_long(long l, long NumTrials=10);
 
@@ -1603,7 +1741,11 @@ inline long InvModStatus(ZZ& x, const ZZ& a, const ZZ& n)
 
 
 void PowerMod(ZZ& x, const ZZ& a, const ZZ& e, const ZZ& n);
-// defined in ZZ.c in terms of LowLevelPowerMod
+// defined in ZZ.c in terms of LowLevelPowerMod.
+// If n = k*2^m + c with 0 < k, |c| < NTL_SP_BOUND (Mersenne and
+// pseudo-Mersenne numbers, and Proth and Riesel numbers k*2^m +/- 1),
+// this is detected, and each step reduces mod n with shifts and adds
+// in place of Montgomery reduction.
 
 inline void LowLevelPowerMod(ZZ& x, const ZZ& a, const ZZ& e, const ZZ& n)
    { _ntl_gpowermod(a.rep, e.rep, n.rep, &x.rep); }
@@ -1620,6 +1762,211 @@ inline ZZ PowerMod(const ZZ& a, long e, const ZZ& n)
 
 
 
+/*************************************************************
+
+   Pooled storage
+
+**************************************************************/
+
+// Each thread keeps the storage of freed ZZs of up to three limbs
+// on a free list, and reuses it for new ZZs.  While a ZZArenaScope
+// is alive, this is extended to ZZs of any size:  storage is
+// allocated in power-of-two size classes, and freed storage is kept
+// in the thread (up to 64MB) for reuse, instead of being returned to
+// malloc.  When the outermost scope in a thread ends, all the storage
+// kept this way is released at once.  Scopes may be nested.
+//
+// This reduces malloc traffic (and lock contention between threads)
+// for computations with many short-lived temporaries.  ZZs created 
+// inside a scope remain valid after it ends.
+//
+// A typical use is one scope per task in a thread pool:
+//
+//    NTL_EXEC_RANGE(n, first, last)
+//       ZZArenaScope scope;
+//       ...
+//    NTL_EXEC_RANGE_END
+
+class ZZArenaScope {
+public:
+   ZZArenaScope() { _ntl_gpool_enter(); }
+   ~ZZArenaScope() { _ntl_gpool_leave(); }
+
+private:
+   ZZArenaScope(const ZZArenaScope&); // disabled
+   void operator=(const ZZArenaScope&); // disabled
+};
+
+// Per-thread counters:  allocs and frees count storage blocks
+// allocated and freed, hits and pooled count those served from and
+// returned to the pool, and cached_bytes and live_bytes (with their
+// peaks) the storage held by the pool and in use.  live_bytes is only
+// approximate if ZZs are freed by a thread other than the one that
+// allocated them.
+//
+// NOTE: the counters are only kept if NTL is compiled with
+// NTL_POOL_STATS (see config.h), since they cost a few instructions
+// on every allocation and free.  Otherwise, only cached_bytes is
+// kept, and the other counters are always zero.
+
+typedef _ntl_gpool_stats ZZPoolStats;
+
+inline void GetZZPoolStats(ZZPoolStats& st) { _ntl_gpool_get_stats(&st); }
+// st = the counters for this thread
+
+inline void ResetZZPoolStats() { _ntl_gpool_reset_stats(); }
+// resets the counts, and the peaks to the current values
+
+inline double ZZPoolHitRate(const ZZPoolStats& st)
+   { return st.allocs ? double(st.hits)/double(st.allocs) : 0.0; }
+
+
+
+/*************************************************************
+
+   Reduction by a fixed modulus
+
+**************************************************************/
+
+// A ZZReducer stores precomputed data for repeated arithmetic
+// modulo a fixed n > 1, so that the cost of this precomputation
+// is amortized over many operations.
+//
+// rem, MulMod and SqrMod use Barrett reduction, and work for any n.
+// rem accepts any a; MulMod and SqrMod assume 0 <= a, b < n.
+// For n of the special form described under PowerMod, they use
+// shift-and-add reduction instead.
+//
+// If n is odd, Montgomery arithmetic is also available: with R = 2^(k*NTL_ZZ_NBITS),
+// where k is the number of limbs of n, ToMont(x, a) computes x = a*R mod n,
+// FromMont(x, a) computes x = a/R mod n, and MulMont(x, a, b) computes
+// x = a*b/R mod n (for 0 <= a, b < n).  A sequence of MulMont/SqrMont
+// operations on values in Montgomery form is typically faster than
+// the corresponding MulMod/SqrMod operations.
+//
+// ToRep, FromRep, mul and sqr work in the faster of the two forms:
+// Montgomery form if n is odd (montgomery() is true), and ordinary
+// residues otherwise.  A chain of products, as in exponentiation,
+// is ToRep(x, a) (for 0 <= a < n), then mul and sqr, then FromRep.
+
+class ZZReducer {
+public:
+   ZZReducer() { }
+   explicit ZZReducer(const ZZ& n) { init(n); }
+
+   void init(const ZZ& n);
+
+   const ZZ& modulus() const { return n; }
+   bool montgomery() const { return rep->montgomery(); }
+
+   void rem(ZZ& x, const ZZ& a) const
+      { rep->rem(&x.rep, a.rep); }
+   void MulMod(ZZ& x, const ZZ& a, const ZZ& b) const
+      { rep->mulmod(&x.rep, a.rep, b.rep); }
+   void SqrMod(ZZ& x, const ZZ& a) const
+      { rep->sqrmod(&x.rep, a.rep); }
+
+   // the following require n odd
+   void ToMont(ZZ& x, const ZZ& a) const
+      { rep->to_mont(&x.rep, a.rep); }
+   void FromMont(ZZ& x, const ZZ& a) const
+      { rep->from_mont(&x.rep, a.rep); }
+   void MulMont(ZZ& x, const ZZ& a, const ZZ& b) const
+      { rep->mulmont(&x.rep, a.rep, b.rep); }
+   void SqrMont(ZZ& x, const ZZ& a) const
+      { rep->sqrmont(&x.rep, a.rep); }
+
+   // Montgomery form if montgomery(), and plain residues otherwise
+   void ToRep(ZZ& x, const ZZ& a) const
+      { if (montgomery()) ToMont(x, a); else x = a; }
+   void FromRep(ZZ& x, const ZZ& a) const
+      { if (montgomery()) FromMont(x, a); else x = a; }
+   void mul(ZZ& x, const ZZ& a, const ZZ& b) const
+      { if (montgomery()) MulMont(x, a, b); else MulMod(x, a, b); }
+   void sqr(ZZ& x, const ZZ& a) const
+      { if (montgomery()) SqrMont(x, a); else SqrMod(x, a); }
+
+private:
+   ZZ n;
+   UniquePtr<_ntl_reducer_struct> rep;
+
+   ZZReducer(const ZZReducer&); // disabled
+   void operator=(const ZZReducer&); // disabled
+};
+
+inline void rem(ZZ& x, const ZZ& a, const ZZReducer& red)
+   { red.rem(x, a); }
+
+inline ZZ rem(const ZZ& a, const ZZReducer& red)
+   { ZZ x; red.rem(x, a); NTL_OPT_RETURN(ZZ, x); }
+
+inline void MulMod(ZZ& x, const ZZ& a, const ZZ& b, const ZZReducer& red)
+   { red.MulMod(x, a, b); }
+
+inline ZZ MulMod(const ZZ& a, const ZZ& b, const ZZReducer& red)
+   { ZZ x; red.MulMod(x, a, b); NTL_OPT_RETURN(ZZ, x); }
+
+inline void SqrMod(ZZ& x, const ZZ& a, const ZZReducer& red)
+   { red.SqrMod(x, a); }
+
+inline ZZ SqrMod(const ZZ& a, const ZZReducer& red)
+   { ZZ x; red.SqrMod(x, a); NTL_OPT_RETURN(ZZ, x); }
+
+
+// A PowerModPrecomp stores a table of powers of a fixed base g modulo
+// a fixed n > 1, for computing g^e mod n for many exponents e with
+// NumBits(e) <= ebits.  With windows of w bits, the table holds the
+// ceil(ebits/w)*(2^w-1) values g^(j*2^(w*i)) (in Montgomery form if n
+// is odd), and each exponentiation takes about ebits/w
+// multiplications and no squarings.  If w <= 0, the largest w <= 6 
+// is chosen for which the table takes at most 8MB.  The table is 
+// built using NTL's thread pool.
+//
+// Longer exponents fall back to PowerMod, and negative exponents are
+// handled as in PowerMod.  power() may be called concurrently from
+// several threads.
+
+class PowerModPrecomp {
+public:
+   PowerModPrecomp() : ebits(0), w(0), nwin(0) { }
+   PowerModPrecomp(const ZZ& g, const ZZ& n, long ebits, long w = 0)
+      : ebits(0), w(0), nwin(0) { init(g, n, ebits, w); }
+
+   void init(const ZZ& g, const ZZ& n, long ebits, long w = 0);
+
+   const ZZ& base() const { return g; }
+   const ZZ& modulus() const { return red.modulus(); }
+   long MaxBits() const { return ebits; }
+   long window() const { return w; }
+
+   void power(ZZ& x, const ZZ& e) const;
+   // x = g^e mod n
+
+private:
+   ZZ g;
+   ZZReducer red;
+   long ebits, w, nwin;
+   Vec<ZZ> tab;   // tab[i*(2^w-1)+j-1] = g^(j*2^(w*i))
+
+   PowerModPrecomp(const PowerModPrecomp&); // disabled
+   void operator=(const PowerModPrecomp&); // disabled
+};
+
+inline void PowerMod(ZZ& x, const PowerModPrecomp& P, const ZZ& e)
+   { P.power(x, e); }
+
+inline ZZ PowerMod(const PowerModPrecomp& P, const ZZ& e)
+   { ZZ x; P.power(x, e); NTL_OPT_RETURN(ZZ, x); }
+
+inline void PowerMod(ZZ& x, const PowerModPrecomp& P, long e)
+   { P.power(x, ZZ_expo(e)); }
+
+inline ZZ PowerMod(const PowerModPrecomp& P, long e)
+   { ZZ x; P.power(x, ZZ_expo(e)); NTL_OPT_RETURN(ZZ, x); }
+
+
+
+
 
 
 /*************************************************************
@@ -1664,8 +2011,8 @@ inline ZZ SqrRootMod(const ZZ& a, const ZZ& n)
 
 class PrimeSeq {
 
-const char *movesieve;
-Vec<char> movesieve_mem;
+const unsigned char *movesieve;
+Vec<unsigned char> movesieve_mem;
 long pindex;
 long pshift;
 long exhausted;
@@ -1695,6 +2042,63 @@ void shift(long);
 };
 
 
+// The sieve behind PrimeSeq is segmented and bit-packed, with one bit
+// for each number prime to 30.  PrimeRange uses the same sieve for
+// ranges of 64-bit numbers.
+
+class PrimeRange {
+
+unsigned long long lo, hi;
+unsigned long long k0;
+Vec<unsigned char> seg;
+long len;
+long pindex;
+long small;
+Vec<long> bp;
+Vec<long> off;
+long nactive;
+long test;
+long exhausted;
+
+public:
+
+PrimeRange(unsigned long long lo, unsigned long long hi);
+
+unsigned long long next();
+// returns the primes p with lo <= p <= hi in increasing order, 
+// and 0 once they are exhausted.  Any hi < 2^64 is allowed.
+// Numbers beyond 2^40 are sieved only partially, and the survivors 
+// are proved prime with strong pseudoprime tests to a set of bases 
+// known to be sufficient below 2^64.
+
+unsigned long long count();
+// returns the number of primes that next() has yet to return,
+// and exhausts the range
+
+private:
+
+PrimeRange(const PrimeRange&);        // disabled
+void operator=(const PrimeRange&);  // disabled
+
+// auxilliary routines
+
+void sieve();
+long advance();
+
+};
+
+
+void PrimeList(Vec<unsigned long long>& v, 
+               unsigned long long lo, unsigned long long hi);
+// v = list of primes p with lo <= p <= hi, in increasing order
+
+unsigned long long CountPrimes(unsigned long long lo, unsigned long long hi);
+// returns the number of primes p with lo <= p <= hi
+
+// PrimeList and CountPrimes split the range among the available
+// threads (see BasicThreadPool.h).
+
+
 
 
 /**************************************************************
@@ -1706,6 +2110,14 @@ void shift(long);
 NTL_SNS istream& operator>>(NTL_SNS istream& s, ZZ& x);  
 NTL_SNS ostream& operator<<(NTL_SNS ostream& s, const ZZ& a); 
 
+// the following read and write ZZ's as strings of digits in a 
+// given base, 2 <= base <= 16; operator>> and operator<< use base 10
+
+NTL_SNS istream& InputBase(NTL_SNS istream& s, ZZ& x, long base);
+NTL_SNS ostream& OutputBase(NTL_SNS ostream& s, const ZZ& a, long base);
+
+void conv(ZZ& x, const char *s, long base);
+
 
 
 
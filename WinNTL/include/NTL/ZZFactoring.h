@@ -0,0 +1,69 @@
+
+#ifndef NTL_ZZFactoring__H
+#define NTL_ZZFactoring__H
+
+#include <NTL/ZZ.h>
+#include <NTL/pair_ZZ_long.h>
+
+NTL_OPEN_NNS
+
+/**************************************************************
+
+   Factoring integers
+
+**************************************************************/
+
+
+void mul(ZZ& x, const vec_pair_ZZ_long& a);
+inline ZZ mul(const vec_pair_ZZ_long& a)
+   { ZZ x; mul(x, a); NTL_OPT_RETURN(ZZ, x); }
+// x = product of a[i].a^a[i].b
+
+
+long PollardRho(ZZ& d, const ZZ& n, long MaxIters);
+// n is odd and composite.  Looks for a nontrivial factor d of n with
+// Brent's variant of Pollard's rho method, for at most about MaxIters
+// iterations, using Montgomery arithmetic and one GCD per block of
+// iterations.  Returns 1 if a factor is found, and 0 otherwise.
+// A factor p is expected after about sqrt(p) iterations.
+
+
+long ECM(ZZ& d, const ZZ& n, long B1, long B2, long NumCurves,
+         long verbose=0);
+// n is odd and composite, and not a perfect power.  Looks for a
+// nontrivial factor d of n with the elliptic curve method, using up
+// to NumCurves Montgomery curves y^2 = x^3 + A x^2 + x with Suyama's
+// parametrization, chosen using RandomBnd.  Stage 1 multiplies a
+// point by every prime power <= B1;  stage 2 covers a single prime
+// in (B1, B2], using baby-step giant-step and multipoint evaluation
+// of ZZ_pX polynomials modulo n.  Returns 1 if a factor is found, and
+// 0 otherwise.  The curves are run concurrently using NTL's thread
+// pool.  Choices of B1 and NumCurves with a good chance of finding
+// a factor of a given size are (from GMP-ECM):
+//
+//    digits     B1       curves
+//      15       2000        25
+//      20       11000       90
+//      25       50000      300
+//      30       250000     700
+//      35       1000000   1800
+//      40       3000000   5100
+
+
+void factor(vec_pair_ZZ_long& factors, const ZZ& n, long verbose=0);
+inline vec_pair_ZZ_long factor(const ZZ& n, long verbose=0)
+   { vec_pair_ZZ_long x; factor(x, n, verbose); return x; }
+// n != 0.  factors is the factorization of |n| into primes, as pairs
+// (p, e), sorted by increasing p;  it is empty if |n| = 1.
+// The primes below 2^16 are removed by trial division; the cofactors
+// are then tested with ProbPrime and for perfect powers, and split
+// with PollardRho and then ECM, with increasing bounds up to those
+// for factors of about 50 digits.  A ResourceError is raised if ECM
+// finds no factor at the last of these bounds.  The primes are
+// identified with ProbPrime, so the result is correct with very high
+// probability.
+
+
+NTL_CLOSE_NNS
+
+#endif
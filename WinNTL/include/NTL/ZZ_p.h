@@ -63,6 +63,9 @@ public:
 
    Lazy<ZZ_pFFTInfoT> FFTInfo;
 
+   Lazy<ZZReducer> Reducer;
+   // Barrett/Montgomery data for p, built on first use (see ZZ_pMont.h)
+
 #ifndef NTL_WIZARD_HACK
 
    struct MatPrime_crt_helper_deleter_policy {
@@ -237,6 +240,14 @@ static ZZ_pTmpSpaceT* GetTmpSpace()
    return ZZ_pTmpSpace;
 }
 
+static void BuildReducer();
+
+static const ZZReducer& reducer()
+{
+   if (!ZZ_pInfo->Reducer.built()) BuildReducer();
+   return *ZZ_pInfo->Reducer;
+}
+
 
 ZZ_p(INIT_VAL_TYPE, const ZZ& a);
 ZZ_p(INIT_VAL_TYPE, long a);
@@ -504,6 +515,10 @@ inline void random(ZZ_p& x)
 inline ZZ_p random_ZZ_p()
    { ZZ_p x; random(x); NTL_OPT_RETURN(ZZ_p, x); }
 
+void VectorRandom(long k, ZZ_p* x);
+// x[i] = random element in ZZ_p, for 0 <= i < k, using
+// VectorRandomBnd
+
 
 // ****** input/output
 
@@ -0,0 +1,590 @@
+
+#ifndef NTL_ZZ_pFixed__H
+#define NTL_ZZ_pFixed__H
+
+#include <NTL/ZZ_p.h>
+#include <NTL/vector.h>
+
+#ifndef NTL_HAVE_LL_TYPE
+#error "ZZ_pFixed requires NTL_HAVE_LL_TYPE"
+#endif
+
+NTL_OPEN_NNS
+
+
+/**********************************************************************
+
+   Fixed-width modular integers
+
+   ZZ_pFixed<N> represents elements of Z/pZ for an odd modulus
+   1 < p < 2^(N*NTL_BITS_PER_LONG).  Each element is stored inline as
+   N words holding its Montgomery form a*R mod p, with
+   R = 2^(N*NTL_BITS_PER_LONG), so there is no heap allocation, and
+   Vec<ZZ_pFixed<N>> is a contiguous array of trivially copyable
+   objects.  Multiplication is word-by-word (CIOS) Montgomery
+   multiplication, with all loop bounds known at compile time.
+
+   ZZ_pFixedBits<256> is ZZ_pFixed<N> with the smallest N that holds
+   256-bit moduli (N = 4 with 64-bit longs, N = 8 with 32-bit longs).
+
+   Like ZZ_p, the modulus is a per-thread setting:  ZZ_pFixed<N>::init(p)
+   installs p, and ZZ_pFixedContext<N> saves and restores it (for
+   example, to install the modulus in the threads of a thread pool).
+
+**********************************************************************/
+
+
+template<long N>
+struct ZZ_pFixedInfo {
+   unsigned long p[N];      // the modulus
+   unsigned long pinv;      // -1/p mod 2^NTL_BITS_PER_LONG
+   unsigned long one[N];    // R mod p
+   unsigned long R2[N];     // R^2 mod p
+   long installed;
+};
+
+template<long N> class ZZ_pFixedContext;
+
+
+template<long N>
+class ZZ_pFixed {
+public:
+
+unsigned long rep[N];   // Montgomery form, 0 <= rep < p, low word first
+
+static NTL_CHEAP_THREAD_LOCAL ZZ_pFixedInfo<N> info;
+
+
+// ****** modulus
+
+static void init(const ZZ& p);
+static void BuildInfo(ZZ_pFixedInfo<N>& I, const ZZ& p);
+
+static ZZ modulus()
+{
+   check();
+   ZZ x;
+   FromWords(x, info.p);
+   NTL_OPT_RETURN(ZZ, x);
+}
+
+static void check()
+{
+   if (!info.installed) LogicError("ZZ_pFixed: modulus undefined");
+}
+
+
+// ****** constructors
+
+ZZ_pFixed() { for (long i = 0; i < N; i++) rep[i] = 0; }
+explicit ZZ_pFixed(long a) { *this = a; }
+explicit ZZ_pFixed(const ZZ& a) { *this = a; }
+explicit ZZ_pFixed(const ZZ_p& a) { *this = a; }
+
+// copy constructor, assignment, destructor: default
+
+ZZ_pFixed& operator=(long a) { ZZ A; conv(A, a); *this = A; return *this; }
+ZZ_pFixed& operator=(const ZZ& a);
+ZZ_pFixed& operator=(const ZZ_p& a) { *this = a._ZZ_p__rep; return *this; }
+
+
+// ****** word-level arithmetic on Montgomery forms
+
+// returns -1, 0, 1 as a < b, a = b, a > b
+static long compare(const unsigned long *a, const unsigned long *b)
+{
+   for (long i = N-1; i >= 0; i--) {
+      if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+   }
+   return 0;
+}
+
+// x = a - b, returns the borrow
+static unsigned long SubWords(unsigned long *x, const unsigned long *a,
+                              const unsigned long *b)
+{
+   unsigned long borrow = 0;
+   for (long i = 0; i < N; i++) {
+      unsigned long t = a[i] - b[i];
+      unsigned long b1 = (t > a[i]);
+      x[i] = t - borrow;
+      borrow = b1 | (x[i] > t);
+   }
+   return borrow;
+}
+
+// x = a + b, returns the carry
+static unsigned long AddWords(unsigned long *x, const unsigned long *a,
+                              const unsigned long *b)
+{
+   unsigned long carry = 0;
+   for (long i = 0; i < N; i++) {
+      unsigned long t = a[i] + b[i];
+      unsigned long c1 = (t < a[i]);
+      x[i] = t + carry;
+      carry = c1 | (x[i] < t);
+   }
+   return carry;
+}
+
+static void AddMod(unsigned long *x, const unsigned long *a,
+                   const unsigned long *b)
+{
+   unsigned long carry = AddWords(x, a, b);
+   if (carry || compare(x, info.p) >= 0) SubWords(x, x, info.p);
+}
+
+static void SubMod(unsigned long *x, const unsigned long *a,
+                   const unsigned long *b)
+{
+   if (SubWords(x, a, b)) AddWords(x, x, info.p);
+}
+
+// x = a*b/R mod p, assuming 0 <= a, b < p; x may alias a or b
+static void MulMont(unsigned long *x, const unsigned long *a,
+                    const unsigned long *b)
+{
+   const unsigned long *p = info.p;
+   unsigned long t[N+2];
+   for (long i = 0; i < N+2; i++) t[i] = 0;
+
+   for (long i = 0; i < N; i++) {
+      ll_type s;
+      unsigned long c = 0;
+
+      // t += a*b[i]
+      for (long j = 0; j < N; j++) {
+         ll_init(s, t[j]);
+         ll_add(s, c);
+         ll_mul_add(s, a[j], b[i]);
+         t[j] = ll_get_lo(s);
+         c = ll_get_hi(s);
+      }
+      ll_init(s, t[N]);
+      ll_add(s, c);
+      t[N] = ll_get_lo(s);
+      t[N+1] = ll_get_hi(s);
+
+      // t = (t + m*p)/2^NTL_BITS_PER_LONG, with m chosen so
+      // that the division is exact
+      unsigned long m = t[0]*info.pinv;
+
+      ll_init(s, t[0]);
+      ll_mul_add(s, m, p[0]);
+      c = ll_get_hi(s);
+      for (long j = 1; j < N; j++) {
+         ll_init(s, t[j]);
+         ll_add(s, c);
+         ll_mul_add(s, m, p[j]);
+         t[j-1] = ll_get_lo(s);
+         c = ll_get_hi(s);
+      }
+      ll_init(s, t[N]);
+      ll_add(s, c);
+      t[N-1] = ll_get_lo(s);
+      t[N] = t[N+1] + ll_get_hi(s);
+   }
+
+   // now t < 2p
+
+   if (t[N] || compare(t, p) >= 0)
+      SubWords(x, t, p);
+   else
+      for (long i = 0; i < N; i++) x[i] = t[i];
+}
+
+static void ToWords(unsigned long *x, const ZZ& a);
+static void FromWords(ZZ& x, const unsigned long *a);
+
+};
+
+
+template<long N>
+NTL_CHEAP_THREAD_LOCAL ZZ_pFixedInfo<N> ZZ_pFixed<N>::info;
+
+
+#if (NTL_CXX_STANDARD >= 2011)
+
+template<long NBits>
+using ZZ_pFixedBits =
+   ZZ_pFixed<(NBits + NTL_BITS_PER_LONG - 1)/NTL_BITS_PER_LONG>;
+
+#endif
+
+
+template<long N>
+class ZZ_pFixedContext {
+private:
+ZZ_pFixedInfo<N> info;
+
+public:
+
+ZZ_pFixedContext() { info.installed = 0; }
+explicit ZZ_pFixedContext(const ZZ& p) { ZZ_pFixed<N>::BuildInfo(info, p); }
+
+// copy constructor, assignment, destructor: default
+
+void save() { info = ZZ_pFixed<N>::info; }
+void restore() const { ZZ_pFixed<N>::info = info; }
+};
+
+
+template<long N>
+void ZZ_pFixed<N>::ToWords(unsigned long *x, const ZZ& a)
+{
+   // a is assumed to be in the range 0..R-1
+   unsigned char buf[N*sizeof(unsigned long)];
+   BytesFromZZ(buf, a, N*sizeof(unsigned long));
+   for (long i = 0; i < N; i++) {
+      unsigned long w = 0;
+      for (long j = sizeof(unsigned long)-1; j >= 0; j--)
+         w = (w << 8) | buf[i*sizeof(unsigned long)+j];
+      x[i] = w;
+   }
+}
+
+template<long N>
+void ZZ_pFixed<N>::FromWords(ZZ& x, const unsigned long *a)
+{
+   unsigned char buf[N*sizeof(unsigned long)];
+   for (long i = 0; i < N; i++) {
+      unsigned long w = a[i];
+      for (long j = 0; j < long(sizeof(unsigned long)); j++) {
+         buf[i*sizeof(unsigned long)+j] = (unsigned char) (w & 255);
+         w >>= 8;
+      }
+   }
+   ZZFromBytes(x, buf, N*sizeof(unsigned long));
+}
+
+template<long N>
+void ZZ_pFixed<N>::init(const ZZ& p)
+{
+   ZZ_pFixedInfo<N> I;
+   BuildInfo(I, p);
+   info = I;
+}
+
+template<long N>
+void ZZ_pFixed<N>::BuildInfo(ZZ_pFixedInfo<N>& I, const ZZ& p)
+{
+   if (p <= 1 || !IsOdd(p) || NumBits(p) > N*NTL_BITS_PER_LONG)
+      LogicError("ZZ_pFixed: modulus must be odd, > 1 and fit in N words");
+
+   ToWords(I.p, p);
+
+   // pinv = -1/p mod 2^NTL_BITS_PER_LONG, by Newton iteration
+   unsigned long p0 = I.p[0];
+   unsigned long inv = p0;    // correct to 3 bits
+   for (long i = 0; i < 6; i++) inv *= 2 - p0*inv;
+   I.pinv = -inv;
+
+   ZZ R, t;
+   set(R);
+   LeftShift(R, R, N*NTL_BITS_PER_LONG);
+   rem(t, R, p);
+   ToWords(I.one, t);
+   SqrMod(t, t, p);
+   ToWords(I.R2, t);
+
+   I.installed = 1;
+}
+
+template<long N>
+ZZ_pFixed<N>& ZZ_pFixed<N>::operator=(const ZZ& a)
+{
+   check();
+
+   ZZ t;
+   rem(t, a, modulus());
+   ToWords(rep, t);
+   MulMont(rep, rep, info.R2);
+   return *this;
+}
+
+
+// ****** conversion
+
+template<long N>
+inline void conv(ZZ_pFixed<N>& x, const ZZ& a) { x = a; }
+
+template<long N>
+inline void conv(ZZ_pFixed<N>& x, long a) { x = a; }
+
+template<long N>
+inline void conv(ZZ_pFixed<N>& x, const ZZ_p& a) { x = a; }
+
+template<long N>
+void conv(ZZ& x, const ZZ_pFixed<N>& a)
+{
+   static const unsigned long one[N] = { 1 };
+   unsigned long t[N];
+   ZZ_pFixed<N>::MulMont(t, a.rep, one);
+   ZZ_pFixed<N>::FromWords(x, t);
+}
+
+template<long N>
+inline void conv(ZZ_p& x, const ZZ_pFixed<N>& a)
+   { ZZ t; conv(t, a); conv(x, t); }
+
+template<long N>
+inline ZZ rep(const ZZ_pFixed<N>& a)
+   { ZZ x; conv(x, a); NTL_OPT_RETURN(ZZ, x); }
+
+
+// ****** arithmetic
+
+template<long N>
+inline void clear(ZZ_pFixed<N>& x)
+   { for (long i = 0; i < N; i++) x.rep[i] = 0; }
+
+template<long N>
+inline void set(ZZ_pFixed<N>& x)
+   { for (long i = 0; i < N; i++) x.rep[i] = ZZ_pFixed<N>::info.one[i]; }
+
+template<long N>
+inline void add(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N>::AddMod(x.rep, a.rep, b.rep); }
+
+template<long N>
+inline void sub(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N>::SubMod(x.rep, a.rep, b.rep); }
+
+template<long N>
+inline void negate(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a)
+   { ZZ_pFixed<N> z; ZZ_pFixed<N>::SubMod(x.rep, z.rep, a.rep); }
+
+template<long N>
+inline void mul(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N>::MulMont(x.rep, a.rep, b.rep); }
+
+template<long N>
+inline void sqr(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a)
+   { ZZ_pFixed<N>::MulMont(x.rep, a.rep, a.rep); }
+
+template<long N>
+void power(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, const ZZ& e)
+{
+   ZZ_pFixed<N> base;
+
+   if (sign(e) < 0)
+      inv(base, a);
+   else
+      base = a;
+
+   ZZ_pFixed<N> res;
+   set(res);
+
+   for (long i = NumBits(e)-1; i >= 0; i--) {
+      sqr(res, res);
+      if (bit(e, i)) mul(res, res, base);
+   }
+
+   x = res;
+}
+
+template<long N>
+inline void power(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, long e)
+   { ZZ E; conv(E, e); power(x, a, E); }
+
+template<long N>
+void inv(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a)
+{
+   ZZ t;
+   conv(t, a);
+   if (InvModStatus(t, t, ZZ_pFixed<N>::modulus()))
+      InvModError("ZZ_pFixed: division by non-invertible element",
+                  t, ZZ_pFixed<N>::modulus());
+   x = t;
+}
+
+template<long N>
+inline ZZ_pFixed<N> inv(const ZZ_pFixed<N>& a)
+   { ZZ_pFixed<N> x; inv(x, a); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> power(const ZZ_pFixed<N>& a, const ZZ& e)
+   { ZZ_pFixed<N> x; power(x, a, e); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> power(const ZZ_pFixed<N>& a, long e)
+   { ZZ_pFixed<N> x; power(x, a, e); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> sqr(const ZZ_pFixed<N>& a)
+   { ZZ_pFixed<N> x; sqr(x, a); return x; }
+
+template<long N>
+inline void div(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N> t; inv(t, b); mul(x, a, t); }
+
+
+// ****** comparison
+
+template<long N>
+inline long IsZero(const ZZ_pFixed<N>& a)
+{
+   for (long i = 0; i < N; i++)
+      if (a.rep[i]) return 0;
+   return 1;
+}
+
+template<long N>
+inline long IsOne(const ZZ_pFixed<N>& a)
+   { return ZZ_pFixed<N>::compare(a.rep, ZZ_pFixed<N>::info.one) == 0; }
+
+template<long N>
+inline long operator==(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { return ZZ_pFixed<N>::compare(a.rep, b.rep) == 0; }
+
+template<long N>
+inline long operator!=(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { return !(a == b); }
+
+
+// ****** operator notation
+
+template<long N>
+inline ZZ_pFixed<N> operator+(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N> x; add(x, a, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> operator-(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N> x; sub(x, a, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> operator-(const ZZ_pFixed<N>& a)
+   { ZZ_pFixed<N> x; negate(x, a); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> operator*(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N> x; mul(x, a, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N> operator/(const ZZ_pFixed<N>& a, const ZZ_pFixed<N>& b)
+   { ZZ_pFixed<N> x; div(x, a, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N>& operator+=(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& b)
+   { add(x, x, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N>& operator-=(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& b)
+   { sub(x, x, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N>& operator*=(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& b)
+   { mul(x, x, b); return x; }
+
+template<long N>
+inline ZZ_pFixed<N>& operator/=(ZZ_pFixed<N>& x, const ZZ_pFixed<N>& b)
+   { div(x, x, b); return x; }
+
+
+// ****** random numbers
+
+template<long N>
+void random(ZZ_pFixed<N>& x)
+// the Montgomery form of a uniform element is uniform
+{
+   ZZ t;
+   RandomBnd(t, ZZ_pFixed<N>::modulus());
+   ZZ_pFixed<N>::ToWords(x.rep, t);
+}
+
+
+// ****** input/output
+
+template<long N>
+NTL_SNS ostream& operator<<(NTL_SNS ostream& s, const ZZ_pFixed<N>& a)
+   { return s << rep(a); }
+
+template<long N>
+NTL_SNS istream& operator>>(NTL_SNS istream& s, ZZ_pFixed<N>& x)
+{
+   ZZ y;
+   NTL_INPUT_CHECK_RET(s, s >> y);
+   x = y;
+   return s;
+}
+
+
+// ****** vectors and polynomials
+//
+// Polynomials are coefficient vectors, low degree first, as in ZZ_pX.
+
+template<long N>
+void conv(Vec< ZZ_pFixed<N> >& x, const Vec<ZZ_p>& a)
+{
+   long n = a.length();
+   x.SetLength(n);
+   for (long i = 0; i < n; i++) x[i] = a[i];
+}
+
+template<long N>
+void conv(Vec<ZZ_p>& x, const Vec< ZZ_pFixed<N> >& a)
+{
+   long n = a.length();
+   x.SetLength(n);
+   for (long i = 0; i < n; i++) conv(x[i], a[i]);
+}
+
+template<long N>
+void InnerProduct(ZZ_pFixed<N>& x, const Vec< ZZ_pFixed<N> >& a,
+                  const Vec< ZZ_pFixed<N> >& b)
+{
+   long n = min(a.length(), b.length());
+   ZZ_pFixed<N> acc, t;
+
+   for (long i = 0; i < n; i++) {
+      mul(t, a[i], b[i]);
+      add(acc, acc, t);
+   }
+
+   x = acc;
+}
+
+template<long N>
+void eval(ZZ_pFixed<N>& x, const Vec< ZZ_pFixed<N> >& f, const ZZ_pFixed<N>& a)
+// x = f(a), by Horner's rule
+{
+   ZZ_pFixed<N> acc;
+
+   for (long i = f.length()-1; i >= 0; i--) {
+      mul(acc, acc, a);
+      add(acc, acc, f[i]);
+   }
+
+   x = acc;
+}
+
+template<long N>
+void PlainMul(Vec< ZZ_pFixed<N> >& x, const Vec< ZZ_pFixed<N> >& a,
+              const Vec< ZZ_pFixed<N> >& b)
+// x = a*b, by the schoolbook method
+{
+   long da = a.length(), db = b.length();
+
+   if (da == 0 || db == 0) {
+      x.SetLength(0);
+      return;
+   }
+
+   Vec< ZZ_pFixed<N> > res;
+   res.SetLength(da+db-1);
+   ZZ_pFixed<N> t;
+
+   for (long i = 0; i < da; i++) {
+      for (long j = 0; j < db; j++) {
+         mul(t, a[i], b[j]);
+         add(res[i+j], res[i+j], t);
+      }
+   }
+
+   x.swap(res);
+}
+
+
+NTL_CLOSE_NNS
+
+#endif
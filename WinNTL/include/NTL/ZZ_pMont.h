@@ -0,0 +1,237 @@
+
+#ifndef NTL_ZZ_pMont__H
+#define NTL_ZZ_pMont__H
+
+#include <NTL/ZZ_p.h>
+#include <NTL/vec_ZZ_p.h>
+
+NTL_OPEN_NNS
+
+
+// ZZ_pMont representation:  elements of Z/pZ, for the current ZZ_p
+// modulus p, which must be odd.  Each ZZ_pMont is represented by the ZZ
+// a*R mod p (the Montgomery form of a), where R = 2^(k*NTL_ZZ_NBITS)
+// and k = ZZ_p::ModulusSize().
+//
+// Multiplication and squaring use Montgomery reduction (through
+// ZZ_p::reducer()) instead of a division by p, and addition and
+// subtraction cost the same as for ZZ_p.  Values are converted to and
+// from the usual representation only by conv, rep and I/O.  This makes
+// ZZ_pMont a drop-in replacement for ZZ_p in code that does long chains
+// of multiplications with few conversions.
+//
+// As with ZZ_p, a ZZ_pMont is only meaningful with respect to the
+// modulus that was current when it was computed.
+
+
+class ZZ_pMont {
+public:
+
+ZZ _ZZ_pMont__rep;
+
+
+// ****** constructors and assignment
+
+ZZ_pMont() { }
+explicit ZZ_pMont(long a) { *this = a; }
+explicit ZZ_pMont(const ZZ_p& a) { *this = a; }
+
+inline ZZ_pMont& operator=(long a);
+inline ZZ_pMont& operator=(const ZZ_p& a);
+
+static const ZZReducer& reducer()
+{
+   const ZZReducer& red = ZZ_p::reducer();
+   if (!red.montgomery())
+      LogicError("ZZ_pMont: modulus must be odd");
+   return red;
+}
+
+void swap(ZZ_pMont& x) { _ZZ_pMont__rep.swap(x._ZZ_pMont__rep); }
+
+};
+
+
+// read-only access to the Montgomery form
+inline const ZZ& MontRep(const ZZ_pMont& a) { return a._ZZ_pMont__rep; }
+
+// the usual representative, in the range 0..p-1
+ZZ rep(const ZZ_pMont& a);
+
+
+// ****** conversion
+
+void conv(ZZ_pMont& x, const ZZ& a);
+void conv(ZZ_pMont& x, long a);
+
+inline void conv(ZZ_pMont& x, const ZZ_p& a)
+   { ZZ_pMont::reducer().ToMont(x._ZZ_pMont__rep, rep(a)); }
+
+inline void conv(ZZ_p& x, const ZZ_pMont& a)
+   { ZZ_pMont::reducer().FromMont(x.LoopHole(), a._ZZ_pMont__rep); }
+
+inline void conv(ZZ& x, const ZZ_pMont& a)
+   { ZZ_pMont::reducer().FromMont(x, a._ZZ_pMont__rep); }
+
+inline void conv(ZZ_pMont& x, const ZZ_pMont& a) { x = a; }
+
+inline ZZ_pMont& ZZ_pMont::operator=(long a)
+   { conv(*this, a); return *this; }
+
+inline ZZ_pMont& ZZ_pMont::operator=(const ZZ_p& a)
+   { conv(*this, a); return *this; }
+
+
+// ****** some basics
+
+inline void clear(ZZ_pMont& x)
+// x = 0
+   { clear(x._ZZ_pMont__rep); }
+
+void set(ZZ_pMont& x);
+// x = 1
+
+inline void swap(ZZ_pMont& x, ZZ_pMont& y)
+   { x.swap(y); }
+
+
+// ****** addition
+
+inline void add(ZZ_pMont& x, const ZZ_pMont& a, const ZZ_pMont& b)
+   { AddMod(x._ZZ_pMont__rep, a._ZZ_pMont__rep, b._ZZ_pMont__rep,
+            ZZ_p::modulus()); }
+
+inline void sub(ZZ_pMont& x, const ZZ_pMont& a, const ZZ_pMont& b)
+   { SubMod(x._ZZ_pMont__rep, a._ZZ_pMont__rep, b._ZZ_pMont__rep,
+            ZZ_p::modulus()); }
+
+inline void negate(ZZ_pMont& x, const ZZ_pMont& a)
+   { NegateMod(x._ZZ_pMont__rep, a._ZZ_pMont__rep, ZZ_p::modulus()); }
+
+
+// ****** multiplication
+
+inline void mul(ZZ_pMont& x, const ZZ_pMont& a, const ZZ_pMont& b)
+   { ZZ_pMont::reducer().MulMont(x._ZZ_pMont__rep,
+                                 a._ZZ_pMont__rep, b._ZZ_pMont__rep); }
+
+inline void sqr(ZZ_pMont& x, const ZZ_pMont& a)
+   { ZZ_pMont::reducer().SqrMont(x._ZZ_pMont__rep, a._ZZ_pMont__rep); }
+
+inline ZZ_pMont sqr(const ZZ_pMont& a)
+   { ZZ_pMont x; sqr(x, a); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+void mul(ZZ_pMont& x, const ZZ_pMont& a, long b);
+inline void mul(ZZ_pMont& x, long a, const ZZ_pMont& b) { mul(x, b, a); }
+
+
+// ****** division
+
+void inv(ZZ_pMont& x, const ZZ_pMont& a);
+// x = 1/a; errors are handled as for ZZ_p, including ZZ_p::DivHandler
+
+inline ZZ_pMont inv(const ZZ_pMont& a)
+   { ZZ_pMont x; inv(x, a); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+void div(ZZ_pMont& x, const ZZ_pMont& a, const ZZ_pMont& b);
+
+
+// ****** exponentiation
+
+void power(ZZ_pMont& x, const ZZ_pMont& a, const ZZ& e);
+
+inline ZZ_pMont power(const ZZ_pMont& a, const ZZ& e)
+   { ZZ_pMont x; power(x, a, e); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+void power(ZZ_pMont& x, const ZZ_pMont& a, long e);
+
+inline ZZ_pMont power(const ZZ_pMont& a, long e)
+   { ZZ_pMont x; power(x, a, e); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+
+// ****** operator notation
+
+inline ZZ_pMont operator+(const ZZ_pMont& a, const ZZ_pMont& b)
+   { ZZ_pMont x; add(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator-(const ZZ_pMont& a, const ZZ_pMont& b)
+   { ZZ_pMont x; sub(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator-(const ZZ_pMont& a)
+   { ZZ_pMont x; negate(x, a); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator*(const ZZ_pMont& a, const ZZ_pMont& b)
+   { ZZ_pMont x; mul(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator*(const ZZ_pMont& a, long b)
+   { ZZ_pMont x; mul(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator*(long a, const ZZ_pMont& b)
+   { ZZ_pMont x; mul(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont operator/(const ZZ_pMont& a, const ZZ_pMont& b)
+   { ZZ_pMont x; div(x, a, b); NTL_OPT_RETURN(ZZ_pMont, x); }
+
+inline ZZ_pMont& operator+=(ZZ_pMont& x, const ZZ_pMont& b)
+   { add(x, x, b); return x; }
+
+inline ZZ_pMont& operator-=(ZZ_pMont& x, const ZZ_pMont& b)
+   { sub(x, x, b); return x; }
+
+inline ZZ_pMont& operator*=(ZZ_pMont& x, const ZZ_pMont& b)
+   { mul(x, x, b); return x; }
+
+inline ZZ_pMont& operator*=(ZZ_pMont& x, long b)
+   { mul(x, x, b); return x; }
+
+inline ZZ_pMont& operator/=(ZZ_pMont& x, const ZZ_pMont& b)
+   { div(x, x, b); return x; }
+
+
+// ****** comparison
+
+inline long IsZero(const ZZ_pMont& a)
+   { return IsZero(a._ZZ_pMont__rep); }
+
+long IsOne(const ZZ_pMont& a);
+
+inline long operator==(const ZZ_pMont& a, const ZZ_pMont& b)
+   { return a._ZZ_pMont__rep == b._ZZ_pMont__rep; }
+
+inline long operator!=(const ZZ_pMont& a, const ZZ_pMont& b)
+   { return !(a == b); }
+
+
+// ****** random numbers
+
+inline void random(ZZ_pMont& x)
+// x = random element; the Montgomery form of a uniform element is uniform
+
+   { RandomBnd(x._ZZ_pMont__rep, ZZ_p::modulus()); }
+
+
+// ****** input/output
+
+NTL_SNS ostream& operator<<(NTL_SNS ostream& s, const ZZ_pMont& a);
+NTL_SNS istream& operator>>(NTL_SNS istream& s, ZZ_pMont& x);
+
+
+// ****** vectors
+
+typedef Vec<ZZ_pMont> vec_ZZ_pMont;
+
+void conv(vec_ZZ_pMont& x, const vec_ZZ_p& a);
+void conv(vec_ZZ_p& x, const vec_ZZ_pMont& a);
+
+void add(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b);
+void sub(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b);
+void mul(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const ZZ_pMont& b);
+
+void InnerProduct(ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b);
+// x = sum_{i=0}^{n-1} a[i]*b[i], where n = min(a.length(), b.length());
+// the products are accumulated without reduction, and a single
+// Montgomery reduction is done at the end
+
+NTL_CLOSE_NNS
+
+#endif
@@ -31,6 +31,7 @@ NTL_OPEN_NNS
 #define NTL_ZZ_pX_GCD_CROSSOVER (180)
 #define NTL_ZZ_pX_BERMASS_CROSSOVER (90)
 #define NTL_ZZ_pX_TRACE_CROSSOVER (90)
+#define NTL_ZZ_pX_EVAL_CROSSOVER (64)
 
 
 
@@ -228,7 +229,9 @@ inline void swap(ZZ_pX& x, ZZ_pX& y)
 void random(ZZ_pX& x, long n);
 inline ZZ_pX random_ZZ_pX(long n)
    { ZZ_pX x; random(x, n); NTL_OPT_RETURN(ZZ_pX, x); }
-// generate a random polynomial of degree < n 
+// generate a random polynomial of degree < n;  for outputs of 256KB
+// or more, the coefficients differ from those of earlier NTL versions
+// (see random(vec_ZZ_p&) in vec_ZZ_p.h)
 
 void trunc(ZZ_pX& x, const ZZ_pX& a, long m);
 // x = a % X^m
@@ -1044,7 +1047,8 @@ inline ZZ_p eval(const ZZ_pX& f, const ZZ_p& a)
    { ZZ_p x; eval(x, f, a); NTL_OPT_RETURN(ZZ_p, x); }
 
 void eval(vec_ZZ_p& b, const ZZ_pX& f, const vec_ZZ_p& a);
-//  b[i] = f(a[i])
+//  b[i] = f(a[i]);  for many points and f of large degree, this
+//  uses a subproduct tree, in quasi-linear time
 
 inline vec_ZZ_p eval(const ZZ_pX& f, const vec_ZZ_p& a)
    { vec_ZZ_p x; eval(x, f, a); NTL_OPT_RETURN(vec_ZZ_p, x); }
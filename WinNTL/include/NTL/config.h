@@ -245,7 +245,34 @@ to be defined.  Of course,  to unset a flag, just replace the
  */
 
 #endif
+
+
+#if 0
+#define NTL_AVOID_MPN_SIMD
+
+/*
+ * Without GMP, on x86-64, NTL has AVX2 and AVX-512 IFMA versions of
+ * the basecase multiplication and squaring routines, and of the
+ * single-limb multiply-and-add routines, which are selected at run
+ * time by CPUID.  This will compile NTL without them.
+ */
+
+#endif
  
+#if 0
+#define NTL_POOL_STATS
+
+/*
+ * This will compile NTL so that each thread counts the allocations
+ * and frees of ZZ storage, and how many of them were served by the
+ * per-thread pool (see GetZZPoolStats in ZZ.h).  Without it, the
+ * counters are not kept, which saves a few instructions on every
+ * allocation and free.
+ */
+
+#endif
+
+
 #if 0
 #define NTL_RANGE_CHECK
 
@@ -293,6 +293,10 @@ inline long _ntl_PINNED(_ntl_gbigint p)
        /* returns p-th bit of a, where the low order bit is indexed by 0;
           p out of range returns 0 */
 
+    long _ntl_gbits(_ntl_gbigint a, long p, long w);
+       /* returns bits p..p+w-1 of |a| as a number in [0, 2^w),
+          for 0 <= w < NTL_BITS_PER_LONG; bits out of range are 0 */
+
     long _ntl_gsetbit(_ntl_gbigint *a, long p);
        /* returns original value of p-th bit of |a|, and replaces
           p-th bit of a by 1 if it was zero;
@@ -596,6 +600,25 @@ inline long _ntl_PINNED(_ntl_gbigint p)
     void _ntl_gfree(_ntl_gbigint x);
        /* Free's space held by x. */
 
+    // per-thread pooling of storage (see lip.cpp)
+
+    struct _ntl_gpool_stats {
+       long allocs;             // blocks allocated
+       long hits;               // ... of which came from the pool
+       long frees;              // blocks freed
+       long pooled;             // ... of which were kept in the pool
+       long cached_bytes;       // bytes currently kept in the pool
+       long peak_cached_bytes;
+       long live_bytes;         // bytes allocated minus bytes freed
+       long peak_live_bytes;
+    };
+
+    void _ntl_gpool_enter();
+    void _ntl_gpool_leave();
+    void _ntl_gpool_get_stats(_ntl_gpool_stats *st);
+    void _ntl_gpool_reset_stats();
+       /* only cached_bytes is kept unless NTL_POOL_STATS is set */
+
 
 /*******************************************************************
 
@@ -675,6 +698,25 @@ _ntl_reduce_struct *
 _ntl_reduce_struct_build(_ntl_gbigint modulus, _ntl_gbigint excess);
 
 
+// reduction by a fixed modulus -- Barrett for any modulus,
+// and Montgomery for odd moduli
+class _ntl_reducer_struct {
+public:
+   virtual ~_ntl_reducer_struct() { }
+   virtual void rem(_ntl_gbigint *x, _ntl_gbigint a) = 0;
+   virtual void mulmod(_ntl_gbigint *x, _ntl_gbigint a, _ntl_gbigint b) = 0;
+   virtual void sqrmod(_ntl_gbigint *x, _ntl_gbigint a) = 0;
+   virtual bool montgomery() = 0;
+   virtual void to_mont(_ntl_gbigint *x, _ntl_gbigint a) = 0;
+   virtual void from_mont(_ntl_gbigint *x, _ntl_gbigint a) = 0;
+   virtual void mulmont(_ntl_gbigint *x, _ntl_gbigint a, _ntl_gbigint b) = 0;
+   virtual void sqrmont(_ntl_gbigint *x, _ntl_gbigint a) = 0;
+};
+
+_ntl_reducer_struct *
+_ntl_reducer_struct_build(_ntl_gbigint modulus);
+
+
 // faster reduction with preconditioning -- general usage, single modulus
 
 struct _ntl_general_rem_one_struct;
@@ -98,6 +98,9 @@ inline mat_ZZ_p ident_mat_ZZ_p(long n)
 void random(mat_ZZ_p& x, long n, long m);
 inline mat_ZZ_p random_mat_ZZ_p(long n, long m)
    { mat_ZZ_p x; random(x, n, m); NTL_OPT_RETURN(mat_ZZ_p, x); }
+// x = random n x m matrix;  for outputs of 256KB or more, the entries
+// differ from those of earlier NTL versions (see random(vec_ZZ_p&) in
+// vec_ZZ_p.h)
 
 
 
@@ -0,0 +1,16 @@
+
+#ifndef NTL_pair_ZZ_long__H
+#define NTL_pair_ZZ_long__H
+
+#include <NTL/pair.h>
+#include <NTL/vector.h>
+#include <NTL/ZZ.h>
+
+NTL_OPEN_NNS
+
+typedef Pair<ZZ,long> pair_ZZ_long;
+typedef Vec<pair_ZZ_long> vec_pair_ZZ_long;
+
+NTL_CLOSE_NNS
+
+#endif
@@ -37,6 +37,11 @@ void InnerProduct(GF2E& x, const vec_GF2E& a, const vec_GF2E& b,
                   long offset);
 
 
+void BatchInv(vec_GF2E& x, const vec_GF2E& a);
+void BatchInv(vec_GF2E& x, Vec<long>& status, const vec_GF2E& a);
+// x[i] = 1/a[i] for each i, with one inversion overall;
+// see vec_ZZ_p.h.
+
 long IsZero(const vec_GF2E& a);
 
 vec_GF2E 
@@ -84,6 +84,16 @@ inline vec_ZZ VectorCopy(const vec_ZZ& a, long n)
    { vec_ZZ x; VectorCopy(x, a, n); NTL_OPT_RETURN(vec_ZZ, x); }
 
 
+void MultiPowerMod(ZZ& x, const vec_ZZ& g, const vec_ZZ& e, const ZZ& n);
+inline ZZ MultiPowerMod(const vec_ZZ& g, const vec_ZZ& e, const ZZ& n)
+   { ZZ x; MultiPowerMod(x, g, e, n); NTL_OPT_RETURN(ZZ, x); }
+// x = prod_i g[i]^e[i] mod n, for n > 1.  All the bases share one
+// chain of squarings (Straus's method for few bases, Pippenger's for
+// many), so the cost is close to that of a single PowerMod for a
+// handful of bases, and grows far more slowly than k PowerMods.
+// Negative exponents are handled as in PowerMod.
+
+
 NTL_CLOSE_NNS
 
 
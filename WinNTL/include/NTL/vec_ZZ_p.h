@@ -38,6 +38,18 @@ void InnerProduct(ZZ_p& x, const vec_ZZ_p& a, const vec_ZZ_p& b);
 void InnerProduct(ZZ_p& x, const vec_ZZ_p& a, const vec_ZZ_p& b,
                   long offset);
 
+void BatchInv(vec_ZZ_p& x, const vec_ZZ_p& a);
+void BatchInv(vec_ZZ_p& x, Vec<long>& status, const vec_ZZ_p& a);
+// x[i] = 1/a[i] for each i, by Montgomery's simultaneous inversion:
+// 3(n-1) multiplications and a single inversion, in place of n
+// inversions.  In the first form, every a[i] must be nonzero; in the
+// second, a zero a[i] gives x[i] = 0 and status[i] = 0, and the 
+// others give status[i] = 1.  If p is composite and some nonzero 
+// a[i] is not invertible, the error is raised as by inv, but on the 
+// product of the a[i] (which shares a factor with p).  Long vectors
+// are split into chunks that are processed in parallel.
+// x may alias a.
+
 long IsZero(const vec_ZZ_p& a);
 
 void VectorCopy(vec_ZZ_p& x, const vec_ZZ_p& a, long n);
@@ -94,6 +106,13 @@ inline vec_ZZ_p& operator*=(vec_ZZ_p& x, long a)
 void random(vec_ZZ_p& x, long n);
 inline vec_ZZ_p random_vec_ZZ_p(long n)
    { vec_ZZ_p x; random(x, n); NTL_OPT_RETURN(vec_ZZ_p, x); }
+// x = vector of n random elements of ZZ_p, generated with VectorRandom.
+// NOTE: if n*NumBytes(ZZ_p::modulus()) is 256KB or more, the elements
+// are generated in blocks from substreams (see VectorRandomBnd in
+// ZZ.h), and so they differ from those of earlier NTL versions, and of
+// n calls to random(ZZ_p&), for the same random stream.  The same
+// holds for random(mat_ZZ_p&, n, m) and random(ZZ_pX&, n).  Smaller
+// outputs are unchanged.
 
 NTL_CLOSE_NNS
 
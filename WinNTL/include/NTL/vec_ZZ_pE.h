@@ -34,6 +34,11 @@ void InnerProduct(ZZ_pE& x, const vec_ZZ_pE& a, const vec_ZZ_pE& b,
                   long offset);
 
 
+void BatchInv(vec_ZZ_pE& x, const vec_ZZ_pE& a);
+void BatchInv(vec_ZZ_pE& x, Vec<long>& status, const vec_ZZ_pE& a);
+// x[i] = 1/a[i] for each i, with one inversion overall;
+// see vec_ZZ_p.h.
+
 long IsZero(const vec_ZZ_pE& a);
 
 void VectorCopy(vec_ZZ_pE& x, const vec_ZZ_pE& a, long n);
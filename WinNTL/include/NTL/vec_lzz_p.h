@@ -43,6 +43,11 @@ inline void mul(vec_zz_p& x, long a, const vec_zz_p& b)
    { mul(x, b, a); }
 
 
+void BatchInv(vec_zz_p& x, const vec_zz_p& a);
+void BatchInv(vec_zz_p& x, Vec<long>& status, const vec_zz_p& a);
+// x[i] = 1/a[i] for each i, with one inversion overall;
+// see vec_ZZ_p.h.
+
 long IsZero(const vec_zz_p& a);
 
 void VectorCopy(vec_zz_p& x, const vec_zz_p& a, long n);
@@ -0,0 +1,539 @@
+
+#include <NTL/DiscreteLog.h>
+#include <NTL/ZZFactoring.h>
+#include <NTL/BasicThreadPool.h>
+
+
+NTL_START_IMPL
+
+
+NTL_CHEAP_THREAD_LOCAL long DiscreteLogBSGSMax = 1L << 20;
+
+
+/**************************************************************
+
+   The group-specific parts:  the context to be restored in
+   each thread, and a hash of a group element, which should
+   look random for random elements.
+
+**************************************************************/
+
+
+class DLogZZ_p {
+public:
+   typedef ZZ_p T;
+
+   ZZ_pContext context;
+
+   void save() { context.save(); }
+   void restore() const { context.restore(); }
+
+   static unsigned long hash(const ZZ_p& a)
+      { return (unsigned long) trunc_long(rep(a), NTL_BITS_PER_LONG); }
+};
+
+
+class DLogGF2E {
+public:
+   typedef GF2E T;
+
+   GF2Context GF2_context;
+   GF2EContext GF2E_context;
+
+   void save() { GF2_context.save(); GF2E_context.save(); }
+   void restore() const { GF2_context.restore(); GF2E_context.restore(); }
+
+   static unsigned long hash(const GF2E& a)
+   {
+      const GF2X& f = rep(a);
+      return f.xrep.length() > 0 ? (unsigned long) f.xrep[0] : 0UL;
+   }
+};
+
+
+
+/**************************************************************
+
+   A hash table from keys to indices, with linear probing.
+   The slot of a key is given by Fibonacci hashing, so that
+   keys whose low bits are constrained (as for distinguished
+   points) are still spread over the table.
+
+**************************************************************/
+
+
+#if (NTL_BITS_PER_LONG >= 64)
+#define DLOG_HASH_MULT (0x9E3779B97F4A7C15UL)
+#else
+#define DLOG_HASH_MULT (0x9E3779B9UL)
+#endif
+
+
+class DLogTable {
+public:
+   Vec<unsigned long> key;
+   Vec<long> val;    // -1 for an empty slot
+   long lsize;
+   long count;
+
+   DLogTable() : lsize(0), count(0) { }
+
+   void init(long n)
+   {
+      lsize = 1;
+      while ((1L << lsize) < 2*n) lsize++;
+      key.SetLength(1L << lsize);
+      val.SetLength(0);
+      val.SetLength(1L << lsize, -1);
+      count = 0;
+   }
+
+   long slot(unsigned long k) const
+      { return (long) ((k*DLOG_HASH_MULT) >> (NTL_BITS_PER_LONG - lsize)); }
+
+   long next(long i) const { return (i+1) & ((1L << lsize) - 1); }
+
+   void insert(unsigned long k, long v)
+   {
+      if (2*(count+1) > (1L << lsize)) grow();
+
+      long i = slot(k);
+      while (val[i] >= 0) i = next(i);
+      key[i] = k;
+      val[i] = v;
+      count++;
+   }
+
+private:
+   void grow()
+   {
+      Vec<unsigned long> okey;
+      Vec<long> oval;
+      okey.swap(key);
+      oval.swap(val);
+
+      init(count+1);
+
+      for (long i = 0; i < oval.length(); i++)
+         if (oval[i] >= 0) insert(okey[i], oval[i]);
+   }
+};
+
+
+
+/**************************************************************
+
+   Logarithms in a subgroup of prime order q
+
+**************************************************************/
+
+
+// baby-step giant-step:  with m >= sqrt(q), the table holds g^j
+// for 0 <= j < m, and the giant steps h g^(-mi) are looked up
+// in the table.  A key match is checked with one exponentiation.
+
+template<class G>
+static
+void DLogBSGS(ZZ& x, const typename G::T& h, const typename G::T& g,
+              const ZZ& q)
+{
+   typedef typename G::T T;
+
+   ZZ m_ZZ;
+   SqrRoot(m_ZZ, q);
+   add(m_ZZ, m_ZZ, 1);
+
+   long m = conv<long>(m_ZZ);
+
+   DLogTable tab;
+   tab.init(m);
+
+   T t;
+   set(t);
+   for (long j = 0; j < m; j++) {
+      tab.insert(G::hash(t), j);
+      mul(t, t, g);
+   }
+
+   // t = g^m
+
+   T s;
+   inv(s, t);
+
+   // the number of giant steps
+
+   ZZ ng_ZZ;
+   add(ng_ZZ, q, m-1);
+   div(ng_ZZ, ng_ZZ, m);
+   long ng = conv<long>(ng_ZZ);
+
+   G context;
+   context.save();
+
+   // The candidates m*i + j cover [0, q+m), so two giant steps can
+   // both match (with e and e+q).  Each interval records its own
+   // match, and the first one is used.
+
+   PartitionInfo pinfo(ng);
+   long nt = pinfo.NumIntervals();
+
+   Vec<ZZ> res;
+   res.SetLength(nt);
+   Vec<long> hit;
+   hit.SetLength(nt, 0);
+
+   AtomicBool found(false);
+
+   NTL_EXEC_INDEX(nt, index)
+
+      context.restore();
+
+      long first, last;
+      pinfo.interval(first, last, index);
+
+      T y, z;
+      ZZ e;
+
+      // y = h g^(-m*first)
+
+      power(y, s, first);
+      mul(y, y, h);
+
+      for (long i = first; i < last && !found; i++) {
+         unsigned long k = G::hash(y);
+
+         for (long l = tab.slot(k); tab.val[l] >= 0; l = tab.next(l)) {
+            if (tab.key[l] != k) continue;
+
+            mul(e, m_ZZ, i);
+            add(e, e, tab.val[l]);
+            power(z, g, e);
+            if (z == h) {
+               res[index] = e;
+               hit[index] = 1;
+               found = true;
+               break;
+            }
+         }
+
+         if (hit[index]) break;
+
+         mul(y, y, s);
+      }
+
+   NTL_EXEC_INDEX_END
+
+   for (long i = 0; i < nt; i++) {
+      if (hit[i]) {
+         rem(x, res[i], q);
+         return;
+      }
+   }
+
+   LogicError("DiscreteLog: element not in subgroup");
+}
+
+
+// Pollard's rho method, with an r-adding walk x -> x M[s(x)],
+// where M[s] = g^c[s] h^d[s] for random c[s], d[s].  Each walk
+// x = g^a h^b runs until it reaches a distinguished point, one
+// whose hash is 0 in the dbits bits above the partition index,
+// where about sqrt(q)/2^dbits = 2^DLOG_RHO_DPLOG distinguished
+// points are expected in all.  The walks run concurrently;  after each round, the new
+// distinguished points are checked sequentially against the table
+// of earlier ones, and a match with a different b gives the log.
+// Walks that repeat an earlier path, or that run too long without
+// a distinguished point (probably in a cycle), are restarted.
+// Only the number of steps with each M[s] is tracked during
+// a round, and a and b are updated when it ends.
+
+#define DLOG_RHO_PARTS (20)
+
+#define DLOG_RHO_DPLOG (10)
+
+template<class G>
+static
+void DLogRhoRestart(typename G::T& X, ZZ& a, ZZ& b,
+                    const typename G::T& h, const typename G::T& g,
+                    const ZZ& q)
+{
+   typename G::T t;
+
+   RandomBnd(a, q);
+   RandomBnd(b, q);
+   power(X, g, a);
+   power(t, h, b);
+   mul(X, X, t);
+}
+
+template<class G>
+static
+void DLogRho(ZZ& x, const typename G::T& h, const typename G::T& g,
+             const ZZ& q)
+{
+   typedef typename G::T T;
+
+   const long r = DLOG_RHO_PARTS;
+
+   Vec<T> M;
+   Vec<ZZ> c, d;
+   M.SetLength(r);
+   c.SetLength(r);
+   d.SetLength(r);
+   for (long s = 0; s < r; s++)
+      DLogRhoRestart<G>(M[s], c[s], d[s], h, g, q);
+
+   long dbits = NumBits(q)/2 - DLOG_RHO_DPLOG;
+   if (dbits < 0) dbits = 0;
+   if (dbits > NTL_BITS_PER_LONG-8) dbits = NTL_BITS_PER_LONG-8;
+
+   unsigned long dmask = (1UL << dbits) - 1UL;
+   long cap = (dbits < NTL_BITS_PER_LONG-8) ? (32L << dbits) : NTL_MAX_LONG;
+
+   long nw = 4*AvailableThreads();
+
+   Vec<T> X;
+   Vec<ZZ> A, B;
+   Vec<long> cnt, restart;
+   X.SetLength(nw);
+   A.SetLength(nw);
+   B.SetLength(nw);
+   cnt.SetLength(nw*r);
+   restart.SetLength(nw);
+
+   for (long w = 0; w < nw; w++)
+      DLogRhoRestart<G>(X[w], A[w], B[w], h, g, q);
+
+   // the distinguished points found so far
+
+   Vec<T> P;
+   Vec<ZZ> PA, PB;
+   DLogTable tab;
+   tab.init(1L << DLOG_RHO_DPLOG);
+
+   G context;
+   context.save();
+
+   ZZ t, u;
+   T z;
+
+   for (;;) {
+      NTL_EXEC_RANGE(nw, first, last)
+
+         context.restore();
+
+         for (long w = first; w < last; w++) {
+            long *wcnt = cnt.elts() + w*r;
+            for (long s = 0; s < r; s++) wcnt[s] = 0;
+
+            T& Xw = X[w];
+            restart[w] = 1;
+
+            for (long steps = 0; steps < cap; steps++) {
+               long s = long(G::hash(Xw) % r);
+               mul(Xw, Xw, M[s]);
+               wcnt[s]++;
+               if (((G::hash(Xw) / r) & dmask) == 0) {
+                  restart[w] = 0;
+                  break;
+               }
+            }
+         }
+
+      NTL_EXEC_RANGE_END
+
+      for (long w = 0; w < nw; w++) {
+         if (restart[w]) {
+            DLogRhoRestart<G>(X[w], A[w], B[w], h, g, q);
+            continue;
+         }
+
+         const long *wcnt = cnt.elts() + w*r;
+         for (long s = 0; s < r; s++) {
+            if (wcnt[s] == 0) continue;
+            MulMod(t, c[s], wcnt[s], q);
+            AddMod(A[w], A[w], t, q);
+            MulMod(t, d[s], wcnt[s], q);
+            AddMod(B[w], B[w], t, q);
+         }
+
+         unsigned long k = G::hash(X[w]);
+         long idx = -1;
+         for (long l = tab.slot(k); tab.val[l] >= 0; l = tab.next(l)) {
+            if (tab.key[l] == k && P[tab.val[l]] == X[w]) {
+               idx = tab.val[l];
+               break;
+            }
+         }
+
+         if (idx < 0) {
+            tab.insert(k, P.length());
+            append(P, X[w]);
+            append(PA, A[w]);
+            append(PB, B[w]);
+            continue;
+         }
+
+         if (PB[idx] != B[w]) {
+            // g^A h^B = g^PA h^PB, so x = (PA-A)/(B-PB) mod q
+
+            SubMod(t, B[w], PB[idx], q);
+            InvMod(t, t, q);
+            SubMod(u, PA[idx], A[w], q);
+            MulMod(x, u, t, q);
+
+            power(z, g, x);
+            if (z == h) return;
+         }
+
+         DLogRhoRestart<G>(X[w], A[w], B[w], h, g, q);
+      }
+   }
+}
+
+
+// x = log_g h, where g has prime order q and h is a power of g
+
+template<class G>
+static
+void DLogPrime(ZZ& x, const typename G::T& h, const typename G::T& g,
+               const ZZ& q)
+{
+   if (IsOne(h)) {
+      clear(x);
+      return;
+   }
+
+   ZZ m;
+   SqrRoot(m, q);
+
+   if (m <= DiscreteLogBSGSMax)
+      DLogBSGS<G>(x, h, g, q);
+   else
+      DLogRho<G>(x, h, g, q);
+}
+
+
+
+/**************************************************************
+
+   Pohlig-Hellman
+
+**************************************************************/
+
+
+template<class G>
+static
+long DLogAux(ZZ& x, const typename G::T& a, const typename G::T& g,
+             const vec_pair_ZZ_long& N)
+{
+   typedef typename G::T T;
+
+   if (IsZero(g)) LogicError("DiscreteLog: g = 0");
+
+   ZZ ord, u;
+   T t;
+
+   mul(ord, N);
+   power(t, g, ord);
+   if (!IsOne(t)) LogicError("DiscreteLog: N is not a multiple of the order of g");
+
+   // reduce ord to the order of g
+
+   vec_pair_ZZ_long fac;
+
+   for (long i = 0; i < N.length(); i++) {
+      long e = N[i].b;
+      while (e > 0) {
+         div(u, ord, N[i].a);
+         power(t, g, u);
+         if (!IsOne(t)) break;
+         ord = u;
+         e--;
+      }
+
+      if (e > 0) append(fac, cons(N[i].a, e));
+   }
+
+   if (IsZero(a)) return 0;
+
+   power(t, a, ord);
+   if (!IsOne(t)) return 0;
+
+   ZZ res, mod, q, qe, xk, qi, d;
+   T g0, a0, g0inv, gam, h;
+
+   set(mod);
+
+   for (long i = 0; i < fac.length(); i++) {
+      q = fac[i].a;
+      long e = fac[i].b;
+
+      power(qe, q, e);
+      div(u, ord, qe);
+      power(g0, g, u);
+      power(a0, a, u);
+      inv(g0inv, g0);
+
+      div(u, qe, q);
+      power(gam, g0, u);
+
+      // the digits of the log of a0 to the base g0, in base q;
+      // u = q^(e-1-j) in the j-th step
+
+      clear(xk);
+      set(qi);
+
+      for (long j = 0; j < e; j++) {
+         power(h, g0inv, xk);
+         mul(h, h, a0);
+         power(h, h, u);
+
+         DLogPrime<G>(d, h, gam, q);
+
+         mul(d, d, qi);
+         add(xk, xk, d);
+         mul(qi, qi, q);
+         div(u, u, q);
+      }
+
+      CRT(res, mod, xk, qe);
+   }
+
+   rem(x, res, ord);
+   return 1;
+}
+
+
+long DiscreteLog(ZZ& x, const ZZ_p& a, const ZZ_p& g,
+                 const vec_pair_ZZ_long& N)
+{
+   return DLogAux<DLogZZ_p>(x, a, g, N);
+}
+
+long DiscreteLog(ZZ& x, const ZZ_p& a, const ZZ_p& g)
+{
+   vec_pair_ZZ_long N;
+   factor(N, ZZ_p::modulus() - 1);
+   return DLogAux<DLogZZ_p>(x, a, g, N);
+}
+
+long DiscreteLog(ZZ& x, const GF2E& a, const GF2E& g,
+                 const vec_pair_ZZ_long& N)
+{
+   return DLogAux<DLogGF2E>(x, a, g, N);
+}
+
+long DiscreteLog(ZZ& x, const GF2E& a, const GF2E& g)
+{
+   ZZ n;
+   power2(n, GF2E::degree());
+   sub(n, n, 1);
+
+   vec_pair_ZZ_long N;
+   factor(N, n);
+   return DLogAux<DLogGF2E>(x, a, g, N);
+}
+
+
+NTL_END_IMPL
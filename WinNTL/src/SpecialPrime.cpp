@@ -0,0 +1,553 @@
+
+#include <NTL/ZZ.h>
+
+#include <cmath>
+
+
+NTL_START_IMPL
+
+
+/**************************************************************
+
+   Squaring mod 2^p-1 with the irrational-base discrete weighted
+   transform (IBDWT) of Crandall and Fagin.
+
+   A residue x mod 2^p-1 is held as N digits x_j of b_j bits,
+   where b_j = ceil(p(j+1)/N) - ceil(pj/N), so that
+   x = sum_j x_j 2^ceil(pj/N).  With weights a_j = 2^(ceil(pj/N)-pj/N),
+   the cyclic convolution of the a_j x_j, divided by the a_j, gives
+   the digits of x^2 mod 2^p-1, with no zero padding.
+
+   The N real digits are packed into N/2 complex numbers, and one
+   complex FFT of length N/2 in each direction is used per squaring.
+   The digits are kept balanced, |x_j| <= 2^(b_j-1), which keeps
+   the roundoff error down.  After each squaring, the distance from
+   the convolution outputs to the nearest integers is checked.
+
+**************************************************************/
+
+
+// the largest roundoff error accepted in a squaring
+#define IBDWT_MAX_ERR (0.35)
+
+// at most this many bits per digit, so that the digits pack
+// into bytes using an unsigned long accumulator
+#define IBDWT_MAX_BITS (24)
+
+// round to nearest, for |v| < 2^51;  adding and subtracting 3*2^51
+// leaves v rounded to an integer in the default rounding mode
+
+static inline double IBDWTRound(double v)
+{
+   const double magic = 6755399441055744.0;
+   return (v + magic) - magic;
+}
+
+namespace {
+
+class MersenneSquarer {
+public:
+   explicit MersenneSquarer(long p);
+
+   void FromZZ(const ZZ& a);
+   // digits = a, for 0 <= a < 2^p
+
+   void ToZZ(ZZ& a);
+   // a = the digits, with 0 <= a < 2^p
+
+   bool SqrSub2();
+   // digits = digits^2 - 2 mod 2^p-1;  returns false if the
+   // roundoff check fails, in which case the digits are unchanged
+
+private:
+   long p, N, M;
+
+   Vec<double> x;      // the digits
+   Vec<long> b;        // their sizes
+   Vec<double> base;   // 2^b_j
+   Vec<double> ibase;  // 2^-b_j
+   Vec<double> wt;     // the weights a_j
+   Vec<double> iwt;    // 1/(a_j*M), to unweight and scale
+   Vec<double> cs, sn; // e^{-2 pi i j/M} = cs[j] + i*sn[j], j <= M/2
+   Vec<double> twr, twi; // e^{-2 pi i j/len} at [len/2 + j], j < len/2
+   Vec<long> rev;      // bit reversal of indices mod M
+   Vec<double> re, im; // work space
+
+   void fft(bool inverse);
+   void carry();
+};
+
+
+MersenneSquarer::MersenneSquarer(long pp) : p(pp)
+{
+   // N is the smallest power of 2 (and at least 8) such that the
+   // digits have on average at most (47 - log2(N)/2)/2 bits;  the
+   // largest roundoff error observed in the convolution outputs is
+   // about 2^(2*bits + log2(N)/2 - 50), and this keeps it below
+   // about 0.125 over a full test, for N = 2^8 to 2^14
+
+   long logN = 3;
+   while (2*(double(p)/double(1L << logN)) + 0.5*logN > 47 ||
+          (p + (1L << logN) - 1) >> logN > IBDWT_MAX_BITS)
+      logN++;
+
+   N = 1L << logN;
+   M = N/2;
+
+   if (p < N) LogicError("MersenneSquarer: exponent too small");
+
+   x.SetLength(N);
+   b.SetLength(N);
+   base.SetLength(N);
+   ibase.SetLength(N);
+   wt.SetLength(N);
+   iwt.SetLength(N);
+
+   // r_j = (-p*j) mod N, so that ceil(pj/N) = (p*j + r_j)/N,
+   // and b_j = (p + r_{j+1} - r_j)/N
+
+   long pmodN = p % N;
+   long r = 0;
+   for (long j = 0; j < N; j++) {
+      long r1 = r - pmodN;
+      if (r1 < 0) r1 += N;
+
+      b[j] = (p + r1 - r)/N;
+      base[j] = std::ldexp(1.0, b[j]);
+      ibase[j] = std::ldexp(1.0, -b[j]);
+      wt[j] = std::pow(2.0, double(r)/double(N));
+      iwt[j] = 1.0/(wt[j]*double(M));
+
+      r = r1;
+   }
+
+   const double pi = 3.14159265358979323846;
+
+   cs.SetLength(M/2+1);
+   sn.SetLength(M/2+1);
+   for (long j = 0; j <= M/2; j++) {
+      cs[j] = std::cos(2*pi*double(j)/double(M));
+      sn[j] = -std::sin(2*pi*double(j)/double(M));
+   }
+
+   // the twiddle factors for each pass of the FFT, stored
+   // contiguously;  they are computed directly, rather than by 
+   // recurrence, for accuracy
+
+   twr.SetLength(M);
+   twi.SetLength(M);
+   for (long half = 1; half < M; half <<= 1) {
+      for (long j = 0; j < half; j++) {
+         twr[half+j] = std::cos(pi*double(j)/double(half));
+         twi[half+j] = -std::sin(pi*double(j)/double(half));
+      }
+   }
+
+   rev.SetLength(M);
+   long logM = logN-1;
+   for (long j = 0; j < M; j++) {
+      long t = 0;
+      for (long i = 0; i < logM; i++)
+         if ((j >> i) & 1) t |= 1L << (logM-1-i);
+      rev[j] = t;
+   }
+
+   re.SetLength(M);
+   im.SetLength(M);
+}
+
+
+void MersenneSquarer::fft(bool inverse)
+{
+   double *RE = re.elts();
+   double *IM = im.elts();
+   const double *TWR = twr.elts();
+   const double *TWI = twi.elts();
+
+   for (long j = 0; j < M; j++) {
+      long t = rev[j];
+      if (t > j) {
+         double tmp;
+         tmp = RE[j]; RE[j] = RE[t]; RE[t] = tmp;
+         tmp = IM[j]; IM[j] = IM[t]; IM[t] = tmp;
+      }
+   }
+
+   // the first pass has only trivial twiddle factors
+
+   for (long i = 0; i < M; i += 2) {
+      double vr = RE[i+1], vi = IM[i+1];
+      RE[i+1] = RE[i] - vr;
+      IM[i+1] = IM[i] - vi;
+      RE[i] += vr;
+      IM[i] += vi;
+   }
+
+   double sgn = inverse ? -1.0 : 1.0;
+
+   for (long half = 2; half < M; half <<= 1) {
+      long len = 2*half;
+      const double *wr_tab = TWR + half;
+      const double *wi_tab = TWI + half;
+
+      for (long i = 0; i < M; i += len) {
+         for (long j = 0; j < half; j++) {
+            double wr = wr_tab[j];
+            double wi = sgn*wi_tab[j];
+
+            long u = i+j, v = i+j+half;
+            double vr = RE[v]*wr - IM[v]*wi;
+            double vi = RE[v]*wi + IM[v]*wr;
+
+            RE[v] = RE[u] - vr;
+            IM[v] = IM[u] - vi;
+            RE[u] += vr;
+            IM[u] += vi;
+         }
+      }
+   }
+}
+
+
+// propagates carries, leaving the digits balanced;  a carry out of
+// the top digit has weight 2^p = 1 mod 2^p-1, and goes into digit 0
+
+void MersenneSquarer::carry()
+{
+   double c = 0;
+
+   for (long pass = 0; ; pass++) {
+      for (long j = 0; j < N; j++) {
+         if (pass > 0 && c == 0) return;
+
+         // these are exact: the values stay below 2^51, and the
+         // scaling is by powers of 2
+         double v = x[j] + c;
+         c = IBDWTRound(v*ibase[j]);
+         x[j] = v - c*base[j];
+      }
+
+      if (c == 0) return;
+   }
+}
+
+
+bool MersenneSquarer::SqrSub2()
+{
+   for (long j = 0; j < M; j++) {
+      re[j] = x[2*j]*wt[2*j];
+      im[j] = x[2*j+1]*wt[2*j+1];
+   }
+
+   fft(false);
+
+   // with Z the transform of z_j = y_{2j} + i*y_{2j+1}, the transforms
+   // of the even and odd parts of y are E_k = (Z_k + conj(Z_{M-k}))/2
+   // and O_k = (Z_k - conj(Z_{M-k}))/(2i);  those of the even and odd
+   // parts of the cyclic square of y are then E_k^2 + w^k O_k^2 and
+   // 2 E_k O_k, with w = e^{-2 pi i/M}, and at M-k, the conjugates
+
+   for (long k = 0; k <= M/2; k++) {
+      long j = (M-k) & (M-1);
+
+      double zr = re[k], zi = im[k];
+      double yr = re[j], yi = im[j];
+
+      double er = 0.5*(zr + yr), ei = 0.5*(zi - yi);
+      double or_ = 0.5*(zi + yi), oi = 0.5*(yr - zr);
+
+      double e2r = er*er - ei*ei, e2i = 2*er*ei;
+      double o2r = or_*or_ - oi*oi, o2i = 2*or_*oi;
+      double wo2r = cs[k]*o2r - sn[k]*o2i;
+      double wo2i = cs[k]*o2i + sn[k]*o2r;
+
+      double Er = e2r + wo2r, Ei = e2i + wo2i;
+      double Or = 2*(er*or_ - ei*oi), Oi = 2*(er*oi + ei*or_);
+
+      // Z'_k = E' + i*O',  Z'_{M-k} = conj(E') + i*conj(O')
+      re[k] = Er - Oi;
+      im[k] = Ei + Or;
+      if (j != k) {
+         re[j] = Er + Oi;
+         im[j] = Or - Ei;
+      }
+   }
+
+   fft(true);
+
+   double err = 0;
+   for (long j = 0; j < M; j++) {
+      double v, r;
+
+      v = re[j]*iwt[2*j];
+      r = IBDWTRound(v);
+      err = std::max(err, std::fabs(v - r));
+      re[j] = r;
+
+      v = im[j]*iwt[2*j+1];
+      r = IBDWTRound(v);
+      err = std::max(err, std::fabs(v - r));
+      im[j] = r;
+   }
+
+   if (err > IBDWT_MAX_ERR) return false;
+
+   for (long j = 0; j < M; j++) {
+      x[2*j] = re[j];
+      x[2*j+1] = im[j];
+   }
+
+   x[0] -= 2;
+   carry();
+
+   return true;
+}
+
+
+void MersenneSquarer::FromZZ(const ZZ& a)
+{
+   long nbytes = (p+7)/8;
+   UniqueArray<unsigned char> buf;
+   buf.SetLength(nbytes);
+   BytesFromZZ(buf.get(), a, nbytes);
+
+   long pos = 0;
+   unsigned long acc = 0;
+   long nacc = 0;
+
+   for (long j = 0; j < N; j++) {
+      while (nacc < b[j]) {
+         acc |= ((unsigned long) buf[pos++]) << nacc;
+         nacc += 8;
+      }
+
+      x[j] = double(acc & ((1UL << b[j]) - 1));
+      acc >>= b[j];
+      nacc -= b[j];
+   }
+
+   carry();
+}
+
+
+void MersenneSquarer::ToZZ(ZZ& a)
+{
+   // make the digits non-negative;  as for carry(), this
+   // terminates after at most three passes
+
+   double c = 0;
+   for (long pass = 0; ; pass++) {
+      long j;
+      for (j = 0; j < N; j++) {
+         if (pass > 0 && c == 0) break;
+
+         double v = x[j] + c;
+         c = std::floor(v*ibase[j]);
+         x[j] = v - c*base[j];
+      }
+
+      if (c == 0) break;
+   }
+
+   long nbytes = (p+7)/8;
+   UniqueArray<unsigned char> buf;
+   buf.SetLength(nbytes);
+
+   long pos = 0;
+   unsigned long acc = 0;
+   long nacc = 0;
+
+   for (long j = 0; j < N; j++) {
+      acc |= ((unsigned long) x[j]) << nacc;
+      nacc += b[j];
+
+      while (nacc >= 8) {
+         buf[pos++] = (unsigned char) (acc & 255);
+         acc >>= 8;
+         nacc -= 8;
+      }
+   }
+
+   if (nacc > 0) buf[pos++] = (unsigned char) acc;
+
+   ZZFromBytes(a, buf.get(), nbytes);
+}
+
+} // end anonymous namespace
+
+
+// exponents below this use ZZ arithmetic with special-form reduction;
+// with N a power of 2, the IBDWT is slower just after N doubles,
+// and for p between 21504 and 26000, N = 2048 does not pay off
+
+#define MERSENNE_DWT_BITS (26000)
+
+long MersenneTest(long p)
+{
+   if (p <= 2) return p == 2;
+   if (!ProbPrime(p)) return 0;
+
+   ZZ M;
+   set(M);
+   LeftShift(M, M, p);
+   sub(M, M, 1);
+
+   ZZReducer red(M);
+
+   ZZ s;
+   conv(s, 4);
+
+   if (p < MERSENNE_DWT_BITS) {
+      for (long i = 0; i < p-2; i++) {
+         red.SqrMod(s, s);
+         sub(s, s, 2);
+         if (sign(s) < 0) add(s, s, M);
+      }
+
+      return IsZero(s);
+   }
+
+   MersenneSquarer sq(p);
+   sq.FromZZ(s);
+
+   for (long i = 0; i < p-2; i++) {
+      if (!sq.SqrSub2()) {
+         // redo this step exactly
+         sq.ToZZ(s);
+         if (s >= M) sub(s, s, M);
+         red.SqrMod(s, s);
+         sub(s, s, 2);
+         if (sign(s) < 0) add(s, s, M);
+         sq.FromZZ(s);
+      }
+   }
+
+   sq.ToZZ(s);
+   return IsZero(s) || s == M;
+}
+
+
+
+// k = k' * 2^e with k' odd: k = k', n = n + e;
+// returns false if k'*2^(n+e) is too large for a long n
+
+static
+bool NormalizeSpecial(ZZ& k, long& n)
+{
+   long e = MakeOdd(k);
+   if (n > NTL_MAX_LONG - e) return false;
+   n += e;
+   return true;
+}
+
+
+long ProthTest(const ZZ& k_in, long n)
+{
+   if (k_in <= 0 || n < 0) LogicError("ProthTest: bad args");
+
+   ZZ k = k_in;
+   if (!NormalizeSpecial(k, n)) ResourceError("ProthTest: overflow");
+
+   ZZ N;
+   LeftShift(N, k, n);
+   add(N, N, 1);
+
+   if (NumBits(N) <= 64 || NumBits(k) > n) return ProbPrime(N);
+   if (TrialDivision(N, 2000)) return 0;
+
+   // Proth's theorem requires a quadratic non-residue, which
+   // does not exist if N is a square
+
+   ZZ t;
+   SqrRoot(t, N);
+   if (sqr(t) == N) return 0;
+
+   PrimeSeq s;
+   long a;
+   for (;;) {
+      a = s.next();
+      if (!a) ResourceError("ProthTest: no non-residue found");
+      long j = Jacobi(ZZ(a), N);
+      if (j == 0) return 0;
+      if (j == -1) break;
+   }
+
+   // e = (N-1)/2 = k*2^(n-1)
+
+   ZZ e;
+   LeftShift(e, k, n-1);
+
+   PowerMod(t, ZZ(a), e, N);
+   add(t, t, 1);
+
+   return t == N;
+}
+
+
+long LLRTest(const ZZ& k_in, long n)
+{
+   if (k_in <= 0 || n < 0) LogicError("LLRTest: bad args");
+
+   ZZ k = k_in;
+   if (!NormalizeSpecial(k, n)) ResourceError("LLRTest: overflow");
+
+   if (IsOne(k)) return MersenneTest(n);
+
+   ZZ N;
+   LeftShift(N, k, n);
+   sub(N, N, 1);
+
+   if (NumBits(N) <= 64 || NumBits(k) > n) return ProbPrime(N);
+   if (TrialDivision(N, 2000)) return 0;
+
+   ZZ t;
+   SqrRoot(t, N);
+   if (sqr(t) == N) return 0;
+
+   // Rodseth's starting value:  with P as above, N is prime iff
+   // V_{(N+1)/4}(P, 1) = 0 mod N;  (N+1)/4 = k*2^(n-2), so this
+   // is u_{n-2}, with u_0 = V_k(P) and u_{i+1} = u_i^2 - 2
+
+   long P;
+   for (P = 3; ; P++) {
+      long j1 = Jacobi(ZZ(P-2), N);
+      long j2 = Jacobi(ZZ(P+2), N);
+      if (j1 == 0 || j2 == 0) return 0;
+      if (j1 == 1 && j2 == -1) break;
+      if (P == NTL_MAX_LONG-2) ResourceError("LLRTest: no P found");
+   }
+
+   ZZReducer red(N);
+
+   // (u, v) = (V_m, V_{m+1}), running over the leading bits m of k,
+   // using V_{2m} = V_m^2 - 2 and V_{2m+1} = V_m V_{m+1} - P
+
+   ZZ u, v;
+   conv(u, 2);
+   conv(v, P);
+
+   for (long i = NumBits(k)-1; i >= 0; i--) {
+      if (bit(k, i)) {
+         red.MulMod(u, u, v);
+         SubMod(u, u, P, N);
+         red.SqrMod(v, v);
+         SubMod(v, v, 2, N);
+      }
+      else {
+         red.MulMod(v, u, v);
+         SubMod(v, v, P, N);
+         red.SqrMod(u, u);
+         SubMod(u, u, 2, N);
+      }
+   }
+
+   for (long i = 0; i < n-2; i++) {
+      red.SqrMod(u, u);
+      SubMod(u, u, 2, N);
+   }
+
+   return IsZero(u);
+}
+
+
+NTL_END_IMPL
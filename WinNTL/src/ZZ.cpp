@@ -73,43 +73,154 @@ void SubMod(ZZ& x, long a, const ZZ& b, const ZZ& n)
 // ****** input and output
 
 
-static NTL_CHEAP_THREAD_LOCAL long iodigits = 0;
-static NTL_CHEAP_THREAD_LOCAL long ioradix = 0;
-// iodigits is the greatest integer such that 10^{iodigits} < NTL_WSP_BOUND
-// ioradix = 10^{iodigits}
+// Conversion between ZZ's and strings of digits in a base b (2 <= b <= 16)
+// is done by divide and conquer, so that it costs O(M(n) log n) rather
+// than O(n^2).  Digits are grouped into chunks of the largest size whose
+// value fits in a word; with radix = b^chunk, we keep a (thread-local)
+// cache of the powers radix^(2^j), which input and output share.
 
-static void InitZZIO()
+// below this many chunks, conversion is done the quadratic way
+#define ZZIO_BASECASE (32)
+
+struct ZZIOInfo {
+   long chunk;     // number of digits per chunk
+   long radix;     // base^chunk
+   Vec<ZZ> pow;    // pow[j] = radix^(2^j), computed as needed
+
+   ZZIOInfo() : chunk(0), radix(0) { }
+};
+
+static
+ZZIOInfo& GetZZIOInfo(long base)
 {
-   long x;
+   NTL_TLS_LOCAL_INIT(Vec<ZZIOInfo>, info_tab, (INIT_SIZE, 17));
+   ZZIOInfo& info = info_tab[base];
+
+   if (!info.chunk) {
+      // chunk is the greatest integer such that base^chunk < NTL_WSP_BOUND
+      long x = (NTL_WSP_BOUND-1)/base;
+      long chunk = 0;
+      long radix = 1;
+
+      while (x) {
+         x = x / base;
+         chunk++;
+         radix = radix * base;
+      }
+
+      if (chunk <= 0) TerminalError("problem with I/O");
 
-   x = (NTL_WSP_BOUND-1)/10;
-   iodigits = 0;
-   ioradix = 1;
+      info.chunk = chunk;
+      info.radix = radix;
+   }
+
+   return info;
+}
+
+// makes sure info.pow[0..j] are available
+// NOTE: this may move existing entries, so references into info.pow
+// should not be held across calls
+static
+void IOPowers(ZZIOInfo& info, long j)
+{
+   long n = info.pow.length();
+   if (j < n) return;
 
-   while (x) {
-      x = x / 10;
-      iodigits++;
-      ioradix = ioradix * 10;
+   info.pow.SetLength(j+1);
+   if (n == 0) {
+      conv(info.pow[0], info.radix);
+      n = 1;
    }
 
-   if (iodigits <= 0) TerminalError("problem with I/O");
+   for (long i = n; i <= j; i++)
+      sqr(info.pow[i], info.pow[i-1]);
 }
 
 
-istream& operator>>(istream& s, ZZ& x)
+// x = sum_i c[i]*radix^i, for 0 <= i < n
+static
+void InputChunks(ZZ& x, const long *c, long n, ZZIOInfo& info)
+{
+   long k = 0;
+   while ((1L << k) < ZZIO_BASECASE) k++;
+
+   // blocks of 2^k chunks are converted the quadratic way...
+   long blk = 1L << k;
+   long m = (n + blk - 1)/blk;
+   Vec<ZZ> v;
+   v.SetLength(m);
+
+   for (long i = 0; i < m; i++) {
+      long lo = i*blk;
+      long hi = min(n, lo + blk);
+      ZZ& t = v[i];
+      for (long l = hi-1; l >= lo; l--) {
+         mul(t, t, info.radix);
+         add(t, t, c[l]);
+      }
+   }
+
+   // ...and then combined in pairs
+   ZZ t;
+   for (; m > 1; k++) {
+      IOPowers(info, k);
+      const ZZ& p = info.pow[k];
+
+      for (long i = 0; i < m/2; i++) {
+         mul(t, v[2*i+1], p);
+         add(v[i], t, v[2*i]);
+      }
+
+      if (m & 1) swap(v[m/2], v[m-1]);
+      m = (m+1)/2;
+   }
+
+   swap(x, v[0]);
+}
+
+
+// writes the digits of a, where 0 <= a < radix^n, 
+// into p[0..n*chunk), padded with leading zeros
+static
+void OutputChunks(char *p, const ZZ& a, long n, long base, 
+                  const ZZIOInfo& info)
+{
+   if (n <= ZZIO_BASECASE) {
+      NTL_ZZRegister(b);
+      b = a;
+      for (long i = n-1; i >= 0; i--) {
+         long r = DivRem(b, b, info.radix);
+         char *q = p + i*info.chunk;
+         for (long l = info.chunk-1; l >= 0; l--) {
+            q[l] = IntValToChar(r % base);
+            r = r / base;
+         }
+      }
+      return;
+   }
+
+   // split off the low-order 2^j chunks, where 2^j < n <= 2^(j+1)
+   long j = NextPowerOfTwo(n) - 1;
+   long m = 1L << j;
+
+   ZZ q, r;
+   DivRem(q, r, a, info.pow[j]);
+   OutputChunks(p, q, n-m, base, info);
+   OutputChunks(p + (n-m)*info.chunk, r, m, base, info);
+}
+
+
+istream& InputBase(istream& s, ZZ& x, long base)
 {
    long c;
    long cval;
    long sign;
-   long ndigits;
-   long acc;
-   NTL_ZZRegister(a);
 
-   if (!s) NTL_INPUT_ERROR(s, "bad ZZ input");
+   if (base < 2 || base > 16) LogicError("InputBase: bad base");
 
-   if (!iodigits) InitZZIO();
+   if (!s) NTL_INPUT_ERROR(s, "bad ZZ input");
 
-   a = 0;
+   ZZIOInfo& info = GetZZIOInfo(base);
 
    SkipWhiteSpace(s);
    c = s.peek();
@@ -124,137 +235,92 @@ istream& operator>>(istream& s, ZZ& x)
 
    cval = CharToIntVal(c);
 
-   if (cval < 0 || cval > 9) NTL_INPUT_ERROR(s, "bad ZZ input");
-
-   ndigits = 0;
-   acc = 0;
-   while (cval >= 0 && cval <= 9) {
-      acc = acc*10 + cval;
-      ndigits++;
-
-      if (ndigits == iodigits) {
-         mul(a, a, ioradix);
-         add(a, a, acc);
-         ndigits = 0;
-         acc = 0;
-      }
+   if (cval < 0 || cval >= base) NTL_INPUT_ERROR(s, "bad ZZ input");
 
+   Vec<char> digits;
+   while (cval >= 0 && cval < base) {
+      digits.append(char(cval));
       s.get();
       c = s.peek();
       cval = CharToIntVal(c);
    }
 
-   if (ndigits != 0) {
-      long mpy = 1;
-      while (ndigits > 0) {
-         mpy = mpy * 10;
-         ndigits--;
-      }
-
-      mul(a, a, mpy);
-      add(a, a, acc);
+   // group the digits into chunks, least significant first
+   long nd = digits.length();
+   long chunk = info.chunk;
+   long n = (nd + chunk - 1)/chunk;
+   Vec<long> chunks;
+   chunks.SetLength(n);
+
+   for (long i = 0; i < n; i++) {
+      long hi = nd - i*chunk;
+      long lo = max(0, hi - chunk);
+      long acc = 0;
+      for (long l = lo; l < hi; l++)
+         acc = acc*base + digits[l];
+      chunks[i] = acc;
    }
 
+   InputChunks(x, chunks.elts(), n, info);
+
    if (sign == -1)
-      negate(a, a);
+      negate(x, x);
 
-   x = a;
    return s;
 }
 
 
-// The class _ZZ_local_stack should be defined in an empty namespace,
-// but since I don't want to rely on namespaces, we just give it a funny 
-// name to avoid accidental name clashes.
-
-struct _ZZ_local_stack {
-   long top;
-   Vec<long> data;
-
-   _ZZ_local_stack() { top = -1; }
-
-   long pop() { return data[top--]; }
-   long empty() { return (top == -1); }
-   void push(long x);
-};
-
-void _ZZ_local_stack::push(long x)
+istream& operator>>(istream& s, ZZ& x)
 {
-   if (top+1 >= data.length()) 
-      data.SetLength(max(32, long(1.414*data.length())));
-
-   top++;
-   data[top] = x;
+   return InputBase(s, x, 10);
 }
 
 
-static
-void PrintDigits(ostream& s, long d, long justify)
+void conv(ZZ& x, const char *s, long base)
 {
-   NTL_TLS_LOCAL_INIT(Vec<char>, buf, (INIT_SIZE, iodigits));
+   if (!s) InputError("bad conversion from char*");
+   plain_c_string_streambuf buf(s);
+   istream istr(&buf);
+   if (!InputBase(istr, x, base)) InputError("bad conversion from char*");
+}
 
-   long i = 0;
 
-   while (d) {
-      buf[i] = IntValToChar(d % 10);
-      d = d / 10;
-      i++;
-   }
+ostream& OutputBase(ostream& s, const ZZ& a, long base)
+{
+   if (base < 2 || base > 16) LogicError("OutputBase: bad base");
 
-   if (justify) {
-      long j = iodigits - i;
-      while (j > 0) {
-         s << "0";
-         j--;
-      }
-   }
+   ZZIOInfo& info = GetZZIOInfo(base);
 
-   while (i > 0) {
-      i--;
-      s << buf[i];
+   if (IsZero(a)) {
+      s << "0";
+      return s;
    }
-}
-      
-
-   
 
-ostream& operator<<(ostream& s, const ZZ& a)
-{
    ZZ b;
-   _ZZ_local_stack S;
-   long r;
-   long k;
+   abs(b, a);
 
-   if (!iodigits) InitZZIO();
+   if (sign(a) < 0) s << "-";
 
-   b = a;
+   // radix >= 2^(NumBits(radix)-1), so n chunks suffice
+   long n = NumBits(b)/(NumBits(info.radix)-1) + 1;
+   if (n > ZZIO_BASECASE) IOPowers(info, NextPowerOfTwo(n) - 1);
 
-   k = sign(b);
+   Vec<char> buf;
+   buf.SetLength(n*info.chunk);
+   OutputChunks(buf.elts(), b, n, base, info);
 
-   if (k == 0) {
-      s << "0";
-      return s;
-   }
+   long i = 0;
+   while (buf[i] == '0') i++;
 
-   if (k < 0) {
-      s << "-";
-      negate(b, b);
-   }
+   s.write(buf.elts() + i, buf.length() - i);
 
-   do {
-      r = DivRem(b, b, ioradix);
-      S.push(r);
-   } while (!IsZero(b));
+   return s;
+}
 
-   r = S.pop();
-   PrintDigits(s, r, 0);
 
-   while (!S.empty()) {
-      r = S.pop();
-      PrintDigits(s, r, 1);
-   }
-      
-   return s;
+ostream& operator<<(ostream& s, const ZZ& a)
+{
+   return OutputBase(s, a, 10);
 }
 
 
@@ -427,78 +493,287 @@ long MillerWitness_sp(long n, long x)
    return 0;
 }
 
-long ProbPrime(long n, long NumTrials)
+// deterministic primality test for 64-bit numbers, using Montgomery
+// arithmetic:  below 4759123141, strong probable prime tests to the
+// bases 2, 7, 61 suffice;  beyond that, the Baillie-PSW test is used,
+// which is known to have no pseudoprimes below 2^64
+
+// hi*2^64 + lo = a*b
+static inline
+void MulWide64(unsigned long long& hi, unsigned long long& lo,
+               unsigned long long a, unsigned long long b)
 {
-   if (NumTrials < 0) NumTrials = 0;
+#if (defined(__GNUC__) && defined(__SIZEOF_INT128__))
+   unsigned __int128 t = ((unsigned __int128) a) * b;
+   hi = (unsigned long long) (t >> 64);
+   lo = (unsigned long long) t;
+#else
+   const unsigned long long M = 0xffffffffULL;
+   unsigned long long a0 = a & M, a1 = a >> 32;
+   unsigned long long b0 = b & M, b1 = b >> 32;
 
-   long m, x, y, z;
-   long i, j, k;
+   unsigned long long t00 = a0*b0, t01 = a0*b1, t10 = a1*b0, t11 = a1*b1;
+   unsigned long long mid = (t00 >> 32) + (t01 & M) + (t10 & M);
 
-   if (n <= 1) return 0;
+   lo = (mid << 32) | (t00 & M);
+   hi = t11 + (t01 >> 32) + (t10 >> 32) + (mid >> 32);
+#endif
+}
 
+struct Mont64 {
+   unsigned long long n, ninv, one, minus_one;
 
-   if (n == 2) return 1;
-   if (n % 2 == 0) return 0;
+   Mont64(unsigned long long nn) : n(nn)
+   {
+      // ninv = -n^{-1} mod 2^64, by Newton iteration
+      unsigned long long x = n;  // correct to 3 bits
+      for (long i = 0; i < 5; i++) x *= 2 - n*x;
+      ninv = -x;
 
-   if (n == 3) return 1;
-   if (n % 3 == 0) return 0;
+      one = (-n) % n;  // 2^64 mod n
+      minus_one = n - one;
+   }
 
-   if (n == 5) return 1;
-   if (n % 5 == 0) return 0;
+   unsigned long long redc(unsigned long long hi, unsigned long long lo) const
+   {
+      unsigned long long m = lo*ninv;
+      unsigned long long mh, ml;
+      MulWide64(mh, ml, m, n);
+      unsigned long long t = hi + mh + (lo != 0);
+      if (t < hi || t >= n) t -= n;
+      return t;
+   }
 
-   if (n == 7) return 1;
-   if (n % 7 == 0) return 0;
+   unsigned long long mul(unsigned long long a, unsigned long long b) const
+   {
+      unsigned long long hi, lo;
+      MulWide64(hi, lo, a, b);
+      return redc(hi, lo);
+   }
 
-   if (n == 11) return 1;
-   if (n % 11 == 0) return 0;
+   unsigned long long add(unsigned long long a, unsigned long long b) const
+   {
+      unsigned long long t = a + b;
+      if (t < a || t >= n) t -= n;
+      return t;
+   }
 
-   if (n == 13) return 1;
-   if (n % 13 == 0) return 0;
+   unsigned long long sub(unsigned long long a, unsigned long long b) const
+   {
+      return (a >= b) ? a - b : a - b + n;
+   }
 
-   if (n >= NTL_SP_BOUND) {
-      return ProbPrime(to_ZZ(n), NumTrials);
+   unsigned long long to_mont(unsigned long long a) const
+   {
+      // a*2^64 mod n, by doubling
+      a %= n;
+      for (long i = 0; i < 64; i++) {
+         unsigned long long t = a + a;
+         if (t < a || t >= n) t -= n;
+         a = t;
+      }
+      return a;
    }
+};
 
-   m = n - 1;
-   k = 0;
-   while((m & 1) == 0) {
-      m = m >> 1;
-      k++;
+static
+long StrongPRP64(const Mont64& M, unsigned long long a, 
+                 unsigned long long d, long s)
+{
+   unsigned long long x = M.to_mont(a);
+   if (x == 0) return 1;
+
+   unsigned long long y = M.one;
+   for (unsigned long long e = d; e; e >>= 1) {
+      if (e & 1) y = M.mul(y, x);
+      x = M.mul(x, x);
    }
 
-   // n - 1 == 2^k * m, m odd
+   if (y == M.one || y == M.minus_one) return 1;
 
-   for (i = 0; i < NumTrials+1; i++) {
-      // for consistency with the multi-precision version,
-      // we first see if 2 is a witness, so we really do 
-      // NumTrials+1 tests
+   for (long i = 1; i < s; i++) {
+      y = M.mul(y, y);
+      if (y == M.minus_one) return 1;
+      if (y == M.one) return 0;
+   }
+
+   return 0;
+}
+
+// Jacobi symbol (a/n), n odd
+static
+long Jacobi64(unsigned long long a, unsigned long long n)
+{
+   long j = 1;
+
+   a %= n;
+   while (a) {
+      while ((a & 1) == 0) {
+         a >>= 1;
+         if ((n & 7) == 3 || (n & 7) == 5) j = -j;
+      }
+
+      unsigned long long t = a; a = n; n = t;
+      if ((a & 3) == 3 && (n & 3) == 3) j = -j;
+      a %= n;
+   }
+
+   return (n == 1) ? j : 0;
+}
+
+static
+long IsSquare64(unsigned long long n)
+{
+   unsigned long long r = (unsigned long long) sqrt(double(n));
+   if (r > 0xffffffffULL) r = 0xffffffffULL;
+   while (r*r > n) r--;
+   while (r < 0xffffffffULL && (r+1)*(r+1) <= n) r++;
+   return r*r == n;
+}
+
+// Selfridge's choice of parameters for the strong Lucas test:  
+// D is the first of 5, -7, 9, -11, ... with (D/n) = -1, and P = 1,
+// Q = (1-D)/4.  Returns 0 if n is found to be composite on the way
+// (i.e., (D/n) = 0 for some D with |D| < n, or n is a square).
+static
+long SelfridgeD64(long& D, unsigned long long n)
+{
+   D = 5;
+
+   for (long i = 0; ; i++) {
+      // no such D exists if n is a square
+      if (i == 2 && IsSquare64(n)) return 0;
+
+      unsigned long long a = (D > 0) ? D % n : n - ((unsigned long long) -D) % n;
+      long j = Jacobi64(a, n);
+
+      if (j == -1) return 1;
+      if (j == 0) return ((unsigned long long) labs(D)) == n;
+
+      D = (D > 0) ? -(D+2) : -D+2;
+   }
+}
+
+// strong Lucas probable prime test with Selfridge's parameters;
+// n odd, n > 1
+static
+long StrongLucas64(const Mont64& M, unsigned long long n)
+{
+   long D;
+   if (!SelfridgeD64(D, n)) return 0;
+   if (((unsigned long long) labs(D)) == n) return 1;
+
+   unsigned long long d = n+1;
+   if (d == 0) return 0;   // n = 2^64-1 = 3*...
+
+   long s = 0;
+   while ((d & 1) == 0) {
+      d >>= 1;
+      s++;
+   }
 
-      if (i == 0) 
-         x = 2;
+   long Q = (1-D)/4;
+   unsigned long long Qm = 
+      M.to_mont((Q >= 0) ? Q : n - ((unsigned long long) -Q) % n);
+
+   // V_k, V_{k+1} and Q^k, by a ladder over the bits of d, 
+   // starting from k = 0
+
+   unsigned long long V0 = M.add(M.one, M.one), V1 = M.one, Qk = M.one;
+
+   long b = 63;
+   while (!((d >> b) & 1)) b--;
+
+   for (; b >= 0; b--) {
+      if ((d >> b) & 1) {
+         // k -> 2k+1
+         unsigned long long Qk1 = M.mul(Qk, Qm);
+         V0 = M.sub(M.mul(V0, V1), Qk);
+         V1 = M.sub(M.mul(V1, V1), M.add(Qk1, Qk1));
+         Qk = M.mul(Qk, Qk1);
+      }
       else {
-	 do {
-	    x = RandomBnd(n);
-	 } while (x == 0);
-         // x == 0 is not a useful candidate for a witness!
+         // k -> 2k
+         V1 = M.sub(M.mul(V0, V1), Qk);
+         V0 = M.sub(M.mul(V0, V0), M.add(Qk, Qk));
+         Qk = M.mul(Qk, Qk);
       }
+   }
 
-      z = PowerMod(x, m, n);
-      if (z == 1) continue;
-   
-      j = 0;
-      do {
-         y = z;
-         z = MulMod(y, y, n);
-         j++;
-      } while (j != k && z != 1);
+   // D*U_d = 2*V_{d+1} - V_d
+
+   if (M.add(V1, V1) == V0) return 1;
+
+   for (long r = 0; ; r++) {
+      if (V0 == 0) return 1;
+      if (r == s-1) return 0;
+
+      V0 = M.sub(M.mul(V0, V0), M.add(Qk, Qk));
+      Qk = M.mul(Qk, Qk);
+   }
+}
+
+static
+long IsPrime64(unsigned long long n)
+{
+   if (n < 2) return 0;
+   if (n < 4) return 1;
+   if ((n & 1) == 0) return 0;
+
+   unsigned long long d = n-1;
+   long s = 0;
+   while ((d & 1) == 0) {
+      d >>= 1;
+      s++;
+   }
+
+   Mont64 M(n);
 
-      if (z != 1 || y !=  n-1) return 0;
+   if (n < 4759123141ULL) {
+      static const unsigned long long base[3] = { 2, 7, 61 };
+      for (long i = 0; i < 3; i++)
+         if (!StrongPRP64(M, base[i], d, s)) return 0;
+   }
+   else {
+      if (!StrongPRP64(M, 2, d, s)) return 0;
+      if (!StrongLucas64(M, n)) return 0;
    }
 
    return 1;
 }
 
 
+// For a long n, the test is deterministic, and NumTrials is ignored.
+
+long ProbPrime(long n, long NumTrials)
+{
+   (void) NumTrials;  // exact below 2^64, see IsPrime64
+
+   if (n <= 1) return 0;
+
+
+   if (n == 2) return 1;
+   if (n % 2 == 0) return 0;
+
+   if (n == 3) return 1;
+   if (n % 3 == 0) return 0;
+
+   if (n == 5) return 1;
+   if (n % 5 == 0) return 0;
+
+   if (n == 7) return 1;
+   if (n % 7 == 0) return 0;
+
+   if (n == 11) return 1;
+   if (n % 11 == 0) return 0;
+
+   if (n == 13) return 1;
+   if (n % 13 == 0) return 0;
+
+   return IsPrime64(n);
+}
+
+
 long MillerWitness(const ZZ& n, const ZZ& x)
 {
    if (n.SinglePrecision()) {
@@ -532,6 +807,119 @@ long MillerWitness(const ZZ& n, const ZZ& x)
 }
 
 
+// the value of n, for 0 <= n < 2^64
+static
+unsigned long long ULL64(const ZZ& n)
+{
+   unsigned char buf[8];
+   BytesFromZZ(buf, n, 8);
+
+   unsigned long long res = 0;
+   for (long i = 7; i >= 0; i--) 
+      res = (res << 8) | buf[i];
+
+   return res;
+}
+
+
+long StrongLucasTest(const ZZ& n)
+{
+   if (n <= 1) return 0;
+   if (!IsOdd(n)) return n == 2;
+
+   if (NumBits(n) <= 64) {
+      unsigned long long n1 = ULL64(n);
+      return StrongLucas64(Mont64(n1), n1);
+   }
+
+   // Selfridge's parameters, as in SelfridgeD64;  here n > |D|
+
+   ZZ t, t1;
+   long D = 5;
+
+   for (long i = 0; ; i++) {
+      if (i == 2) {
+         SqrRoot(t, n);
+         sqr(t1, t);
+         if (t1 == n) return 0;
+      }
+
+      conv(t, D);
+      if (D < 0) add(t, t, n);
+
+      long j = Jacobi(t, n);
+      if (j == -1) break;
+      if (j == 0) return 0;
+
+      D = (D > 0) ? -(D+2) : -D+2;
+   }
+
+   ZZ d;
+   add(d, n, 1);
+   long s = MakeOdd(d);
+
+   ZZReducer red(n);
+
+   ZZ Qm, one, mone, V0, V1, Qk, Qk1;
+
+   long Q = (1-D)/4;
+   conv(t, Q);
+   if (Q < 0) add(t, t, n);
+   red.ToMont(Qm, t);
+
+   conv(t, 1);
+   red.ToMont(one, t);
+   NegateMod(mone, one, n);
+
+   // for Q = -1 (i.e., D = 5), Q^k = (-1)^k needs no multiplications
+   bool qneg = (Q == -1);
+
+   // V_k, V_{k+1} and Q^k in Montgomery form, by a ladder over 
+   // the bits of d, starting from k = 0
+
+   AddMod(V0, one, one, n);
+   V1 = one;
+   Qk = one;
+
+   for (long b = NumBits(d)-1; b >= 0; b--) {
+      if (bit(d, b)) {
+         // k -> 2k+1
+         if (qneg) NegateMod(Qk1, Qk, n); else red.MulMont(Qk1, Qk, Qm);
+         red.MulMont(t, V0, V1);
+         SubMod(V0, t, Qk, n);
+         red.SqrMont(t, V1);
+         AddMod(t1, Qk1, Qk1, n);
+         SubMod(V1, t, t1, n);
+         if (qneg) Qk = mone; else red.MulMont(Qk, Qk, Qk1);
+      }
+      else {
+         // k -> 2k
+         red.MulMont(t, V0, V1);
+         SubMod(V1, t, Qk, n);
+         red.SqrMont(t, V0);
+         AddMod(t1, Qk, Qk, n);
+         SubMod(V0, t, t1, n);
+         if (qneg) Qk = one; else red.SqrMont(Qk, Qk);
+      }
+   }
+
+   // D*U_d = 2*V_{d+1} - V_d
+
+   AddMod(t, V1, V1, n);
+   if (t == V0) return 1;
+
+   for (long r = 0; ; r++) {
+      if (IsZero(V0)) return 1;
+      if (r == s-1) return 0;
+
+      red.SqrMont(t, V0);
+      AddMod(t1, Qk, Qk, n);
+      SubMod(V0, t, t1, n);
+      if (qneg) Qk = one; else red.SqrMont(Qk, Qk);
+   }
+}
+
+
 // ComputePrimeBound computes a reasonable bound for trial
 // division in the Miller-Rabin test.
 // It is computed a bit on the "low" side, since being a bit
@@ -572,54 +960,764 @@ long ComputePrimeBound(long bn)
 }
 
 
-long ProbPrime(const ZZ& n, long NumTrials)
-{
-   if (NumTrials < 0) NumTrials = 0;
+/**********************************************************************
 
-   if (n <= 1) return 0;
+   Trial division by products of small primes
 
-   if (n.SinglePrecision()) {
-      return ProbPrime(to_long(n), NumTrials);
+   The small primes are grouped into single-precision products, and
+   these in turn into blocks whose products are about TRIALDIV_BLOCK
+   limbs long.  For each block, one multi-precision rem reduces n to
+   the size of the block, after which each group costs only a short
+   rem, and each prime a single-precision test.  The tables are
+   extended as needed, and are cached per thread.
+
+   For many candidates at once, the product of all the primes is
+   reduced modulo each candidate with a remainder tree, and a GCD
+   with the candidate finishes the job.
+
+**********************************************************************/
+
+#define TRIALDIV_BLOCK (8)
+
+#define TRIALDIV_THREAD_BITS (8192)
+// for n at least this long, the blocks are processed in parallel
+
+struct TrialDivTable {
+   Vec<long> primes;  // primes in increasing order
+   Vec<long> gprod;   // gprod[j] = product of primes[gstart[j]..gstart[j+1])
+   Vec<long> gstart;  
+   Vec<ZZ> bprod;     // bprod[b] = product of gprod[bstart[b]..bstart[b+1])
+   Vec<long> bstart;
+   PrimeSeq s;
+   long pending;      // next prime not yet in the table, or 0
+
+   TrialDivTable() 
+   { 
+      gstart.append(0);
+      bstart.append(0);
+      pending = s.next();
+   }
+};
+
+// makes sure that T contains all primes < bnd
+static
+void ExtendTrialDivTable(TrialDivTable& T, long bnd)
+{
+   while (T.pending && T.pending < bnd) {
+      ZZ P;
+      set(P);
+
+      while (T.pending && NumBits(P) < TRIALDIV_BLOCK*NTL_ZZ_NBITS) {
+         long q = 1;
+         while (T.pending && q <= (NTL_SP_BOUND-1)/T.pending) {
+            q *= T.pending;
+            T.primes.append(T.pending);
+            T.pending = T.s.next();
+         }
+
+         T.gprod.append(q);
+         T.gstart.append(T.primes.length());
+         mul(P, P, q);
+      }
+
+      T.bprod.append(P);
+      T.bstart.append(T.gprod.length());
+   }
+}
+
+static
+TrialDivTable& GetTrialDivTable(long bnd)
+{
+   NTL_TLS_LOCAL(TrialDivTable, T);
+   ExtendTrialDivTable(T, bnd);
+   return T;
+}
+
+
+// tests n for divisibility by the primes of block b, using r as scratch
+static
+long TrialDivBlock(ZZ& r, const ZZ& n, const TrialDivTable& T, long b)
+{
+   const long *primes = T.primes.elts();
+   const long *gstart = T.gstart.elts();
+   const long *bstart = T.bstart.elts();
+
+   rem(r, n, T.bprod[b]);
+
+   for (long j = bstart[b]; j < bstart[b+1]; j++) {
+      long s = rem(r, T.gprod[j]);
+      if (s == 0) return 1;
+
+      if (gstart[j+1] - gstart[j] > 1) {
+         for (long i = gstart[j]; i < gstart[j+1]; i++)
+            if (s % primes[i] == 0) return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+long TrialDivision(const ZZ& n, long bnd)
+{
+   TrialDivTable& T = GetTrialDivTable(bnd);
+   const long *primes = T.primes.elts();
+   const long *gstart = T.gstart.elts();
+   const long *bstart = T.bstart.elts();
+
+   if (n.SinglePrecision()) {
+      long m = to_long(n);
+      if (m < 0) m = -m;
+      if (m == 0) return bnd > 2;
+
+      // a composite m has a prime factor <= sqrt(m)
+      for (long i = 0; i < T.primes.length() && primes[i] < bnd && 
+                       primes[i] <= m/primes[i]; i++) {
+         if (m % primes[i] == 0) return 1;
+      }
+
+      return 0;
+   }
+
+   long nb = T.bprod.length();
+   long b;
+
+   // blocks all of whose primes are < bnd
+
+   for (b = 0; b < nb && primes[gstart[bstart[b+1]]-1] < bnd; b++) ;
+
+   if (b > 1 && NumBits(n) >= TRIALDIV_THREAD_BITS) {
+      AtomicBool divisible(false);
+
+      NTL_EXEC_RANGE(b, first, last)
+
+         ZZ r;
+         for (long b1 = first; b1 < last && !divisible; b1++) {
+            if (TrialDivBlock(r, n, T, b1)) divisible = true;
+         }
+
+      NTL_EXEC_RANGE_END
+
+      if (divisible) return 1;
+   }
+   else {
+      NTL_ZZRegister(r);
+      for (long b1 = 0; b1 < b; b1++) {
+         if (TrialDivBlock(r, n, T, b1)) return 1;
+      }
+   }
+
+   // what remains of the primes < bnd
+
+   for (long j = bstart[b]; j < T.gprod.length() && primes[gstart[j]] < bnd; j++) {
+      long s = rem(n, T.gprod[j]);
+
+      for (long i = gstart[j]; i < gstart[j+1] && primes[i] < bnd; i++)
+         if (s % primes[i] == 0) return 1;
+   }
+
+   return 0;
+}
+
+
+// tree[0] = leaves, and tree[k+1][j] = tree[k][2*j]*tree[k][2*j+1],
+// or tree[k][2*j] if that is the last one
+static
+void BuildProductTree(Vec< Vec<ZZ> >& tree, const Vec<ZZ>& leaves)
+{
+   tree.SetLength(1);
+   tree[0] = leaves;
+
+   while (tree[tree.length()-1].length() > 1) {
+      long k = tree.length();
+      tree.SetLength(k+1);
+      const Vec<ZZ>& lo = tree[k-1];
+      Vec<ZZ>& hi = tree[k];
+      long m = lo.length();
+
+      hi.SetLength((m+1)/2);
+      for (long j = 0; j < m/2; j++)
+         mul(hi[j], lo[2*j], lo[2*j+1]);
+      if (m & 1) hi[m/2] = lo[m-1];
+   }
+}
+
+
+void TrialDivision(Vec<long>& res, const Vec<ZZ>& n, long bnd)
+{
+   long k = n.length();
+   res.SetLength(k);
+
+   Vec<long> idx;
+   Vec<ZZ> leaves;
+   ZZ t;
+
+   for (long i = 0; i < k; i++) {
+      if (n[i].SinglePrecision()) 
+         res[i] = TrialDivision(n[i], bnd);
+      else {
+         idx.append(i);
+         abs(t, n[i]);
+         leaves.append(t);
+      }
    }
 
+   long m = idx.length();
+   if (m == 0) return;
+
+   if (m == 1) {
+      res[idx[0]] = TrialDivision(n[idx[0]], bnd);
+      return;
+   }
+
+   // P = product of all primes < bnd
+
+   TrialDivTable& T = GetTrialDivTable(bnd);
+
+   Vec<ZZ> factors;
+   long nb = T.bprod.length();
+   long b, j, i;
+
+   for (b = 0; b < nb && T.primes[T.gstart[T.bstart[b+1]]-1] < bnd; b++)
+      factors.append(T.bprod[b]);
+
+   for (j = T.bstart[b]; j < T.gprod.length() && 
+                         T.primes[T.gstart[j+1]-1] < bnd; j++)
+      factors.append(ZZ(INIT_VAL, T.gprod[j]));
+
+   if (j < T.gprod.length()) {
+      for (i = T.gstart[j]; i < T.gstart[j+1] && T.primes[i] < bnd; i++)
+         factors.append(ZZ(INIT_VAL, T.primes[i]));
+   }
+
+   if (factors.length() == 0) {
+      for (i = 0; i < m; i++) res[idx[i]] = 0;
+      return;
+   }
+
+   Vec< Vec<ZZ> > ptree;
+   BuildProductTree(ptree, factors);
+   const ZZ& P = ptree[ptree.length()-1][0];
+
+   // remainder tree: P mod n[i] for each i
+
+   Vec< Vec<ZZ> > tree;
+   BuildProductTree(tree, leaves);
+
+   long top = tree.length()-1;
+   Vec<ZZ> r, r1;
+   r.SetLength(1);
+   rem(r[0], P, tree[top][0]);
+
+   for (long lev = top-1; lev >= 0; lev--) {
+      long len = tree[lev].length();
+      r1.SetLength(len);
+      for (j = 0; j < len; j++)
+         rem(r1[j], r[j/2], tree[lev][j]);
+      swap(r, r1);
+   }
+
+   // n[i] has a factor < bnd iff GCD(P mod n[i], n[i]) != 1
+
+   NTL_ZZRegister(g);
+   for (i = 0; i < m; i++) {
+      GCD(g, r[i], leaves[i]);
+      res[idx[i]] = !IsOne(g);
+   }
+}
+
+
+
+/**********************************************************************
+
+   Batch GCD
+
+   With P the product of the a[i], P mod a[i]^2 is computed for 
+   each i by reducing P down the product tree, modulo the squares
+   of the nodes.  Then (P mod a[i]^2)/a[i] = (P/a[i]) mod a[i], whose
+   GCD with a[i] is g[i].
+
+   If the tree is too large, each level is written to a file once
+   the next one up is built, and read back on the way down.  The
+   files are binary:  the number of entries in text, and for each 
+   entry, its length in bytes in text, followed by the bytes.
+
+**********************************************************************/
+
+NTL_CHEAP_THREAD_LOCAL double BatchGCDFileThresh = 1000000;
+
+
+static
+void WriteBatchGCDLevel(const Vec<ZZ>& v, long lev, FileList& flist)
+{
+   const char *name = FileName("bgcd", lev);
+   ofstream s;
+
+   // as for OpenWrite, but in binary mode
+
+   flist.AddFile(name);
+   s.open(name, std::ios::out | std::ios::binary);
+   if (!s) {
+      flist.RemoveLast();
+      FileError("write open failed");
+   }
+
+   Vec<unsigned char> buf;
+   long m = v.length();
+
+   s << m << "\n";
+   for (long j = 0; j < m; j++) {
+      long nb = NumBytes(v[j]);
+      buf.SetLength(nb);
+      BytesFromZZ(buf.elts(), v[j], nb);
+      s << nb << "\n";
+      s.write((const char *) buf.elts(), nb);
+   }
+
+   CloseWrite(s);
+}
+
+static
+void ReadBatchGCDLevel(Vec<ZZ>& v, long lev)
+{
+   ifstream s;
+
+   s.open(FileName("bgcd", lev), std::ios::in | std::ios::binary);
+   if (!s) FileError("read open failed");
+
+   Vec<unsigned char> buf;
+   long m;
+
+   s >> m;
+   s.get();
+   if (!s || m < 0) FileError("BatchGCD: bad file");
+
+   v.SetLength(m);
+   for (long j = 0; j < m; j++) {
+      long nb;
+      s >> nb;
+      s.get();
+      if (!s || nb < 0) FileError("BatchGCD: bad file");
+
+      buf.SetLength(nb);
+      s.read((char *) buf.elts(), nb);
+      if (!s) FileError("BatchGCD: bad file");
+      ZZFromBytes(v[j], buf.elts(), nb);
+   }
+}
+
+
+void BatchGCD(Vec<ZZ>& g, const Vec<ZZ>& a)
+{
+   long k = a.length();
+
+   for (long i = 0; i < k; i++)
+      if (sign(a[i]) <= 0) LogicError("BatchGCD: bad args");
+
+   if (k <= 1) {
+      g.SetLength(k);
+      if (k == 1) set(g[0]);
+      return;
+   }
+
+   // each level of the tree is about as large as the leaves
+
+   double leaf_bits = 0;
+   for (long i = 0; i < k; i++)
+      leaf_bits += NumBits(a[i]);
+
+   long depth = NumBits(k-1) + 1;
+   bool use_files = leaf_bits/8192.0*depth > BatchGCDFileThresh;
+
+   FileList flist;
+
+   // tree[lev] for lev > 0 are the levels of the product tree, 
+   // as in BuildProductTree;  level 0 is a itself
+
+   Vec< Vec<ZZ> > tree;
+   tree.SetLength(depth);
+
+   long lev = 0;
+   for (;;) {
+      const Vec<ZZ>& lo = (lev == 0) ? a : tree[lev];
+      long m = lo.length();
+      if (m == 1) break;
+
+      Vec<ZZ>& hi = tree[lev+1];
+      hi.SetLength((m+1)/2);
+
+      NTL_EXEC_RANGE(m/2, first, last)
+         for (long j = first; j < last; j++)
+            mul(hi[j], lo[2*j], lo[2*j+1]);
+      NTL_EXEC_RANGE_END
+
+      if (m & 1) hi[m/2] = lo[m-1];
+
+      if (use_files && lev > 0) {
+         WriteBatchGCDLevel(tree[lev], lev, flist);
+         tree[lev].kill();
+      }
+
+      lev++;
+   }
+
+   // remainder tree:  r[j] = P mod (node j of the current level)^2;
+   // at the root, this is just P
+
+   Vec<ZZ> r, r1;
+   swap(r, tree[lev]);
+
+   for (lev--; lev >= 0; lev--) {
+      if (use_files && lev > 0) ReadBatchGCDLevel(tree[lev], lev);
+
+      const Vec<ZZ>& cur = (lev == 0) ? a : tree[lev];
+      long len = cur.length();
+      r1.SetLength(len);
+
+      NTL_EXEC_RANGE(len, first, last)
+         ZZ sq;
+         for (long j = first; j < last; j++) {
+            sqr(sq, cur[j]);
+            rem(r1[j], r[j/2], sq);
+         }
+      NTL_EXEC_RANGE_END
+
+      swap(r, r1);
+      r1.kill();
+      if (lev > 0) tree[lev].kill();
+   }
+
+   g.SetLength(k);
+
+   NTL_EXEC_RANGE(k, first, last)
+      ZZ q;
+      for (long i = first; i < last; i++) {
+         div(q, r[i], a[i]);
+         GCD(g[i], q, a[i]);
+      }
+   NTL_EXEC_RANGE_END
+}
+
+
+#define MILLERRABIN_THREAD_BITS (1024)
+
+// For n at least MILLERRABIN_THREAD_BITS long, the random witnesses
+// are tested in parallel, once n has passed the test with witness 2.
+// Witness i is drawn from a local stream, with a seed drawn from
+// the current stream and nonce i, so that the witnesses, and hence
+// the result, do not depend on the number of threads, and the
+// current stream advances by the same 256 bits whatever the outcome.
+// Once one witness proves n composite, those not yet started are
+// skipped.
+static
+long MultiThreadedMillerRabinTest(const ZZ& n, long NumTrials)
+{
+   if (MillerWitness(n, ZZ(2))) 
+      return 0;
+
+   ZZ seed;
+   RandomBits(seed, 256);
+
+   AtomicBool tests_pass(true);
+
+   NTL_EXEC_RANGE(NumTrials, first, last)
+
+      RandomStreamPush push;
+      SetSeed(seed);
+      RandomStream& stream = GetCurrentRandomStream();
+
+      ZZ W;
+      for (long i = first; i < last && tests_pass; i++) {
+         stream.set_nonce(i);
+         do {
+            RandomBnd(W, n);
+         } while (W == 0);
+
+         if (MillerWitness(n, W)) tests_pass = false;
+      }
+
+   NTL_EXEC_RANGE_END
+
+   return tests_pass;
+}
+
+
+// the Miller-Rabin part of ProbPrime, for n > 1 already known
+// to pass trial division
+static
+long MillerRabinTest(const ZZ& n, long NumTrials)
+{
+   if (NumTrials > 0 && NumBits(n) >= MILLERRABIN_THREAD_BITS)
+      return MultiThreadedMillerRabinTest(n, NumTrials);
+
+   ZZ W;
+   W = 2;
+
+   // first try W == 2....the exponentiation
+   // algorithm runs slightly faster in this case
+
+   if (MillerWitness(n, W))
+      return 0;
+
+
+   long i;
+
+   for (i = 0; i < NumTrials; i++) {
+      do {
+         RandomBnd(W, n);
+      } while (W == 0);
+      // W == 0 is not a useful candidate for a witness!
+
+      if (MillerWitness(n, W)) 
+         return 0;
+   }
+
+   return 1;
+}
+
+
+long ProbPrime(const ZZ& n, long NumTrials)
+{
+   if (NumTrials < 0) NumTrials = 0;
+
+   if (n <= 1) return 0;
+
+   if (n.SinglePrecision()) {
+      return ProbPrime(to_long(n), NumTrials);
+   }
+
+   if (NumBits(n) <= 64) 
+      return IsPrime64(ULL64(n));
+
+
+   long prime_bnd = ComputePrimeBound(NumBits(n));
+
+   if (TrialDivision(n, prime_bnd))
+      return 0;
+
+   return MillerRabinTest(n, NumTrials);
+}
+
+
+long ProbPrimeBPSW(const ZZ& n)
+{
+   if (n <= 1) return 0;
+
+   if (NumBits(n) <= 64) 
+      return IsPrime64(ULL64(n));
+
+   long prime_bnd = ComputePrimeBound(NumBits(n));
+
+   if (TrialDivision(n, prime_bnd))
+      return 0;
+
+   ZZ W;
+   W = 2;
+
+   if (NumBits(n) < MILLERRABIN_THREAD_BITS) {
+      if (MillerWitness(n, W))
+         return 0;
+
+      return StrongLucasTest(n);
+   }
+
+   // the two tests run side by side
+
+   AtomicBool tests_pass(true);
+
+   NTL_EXEC_RANGE(2, first, last)
+
+      for (long i = first; i < last && tests_pass; i++) {
+         if (i == 0 ? MillerWitness(n, W) : !StrongLucasTest(n)) 
+            tests_pass = false;
+      }
+
+   NTL_EXEC_RANGE_END
+
+   return tests_pass;
+}
+
+
+// The numbers are handed out one at a time to the threads as they
+// become free.  Each n[i] is tested with the random stream seeded by a
+// common seed and nonce i, so that the witnesses used do not depend on
+// the number of threads or on the order of execution.
+
+void ProbPrime(Vec<long>& res, Vec<double>& tm, const Vec<ZZ>& n, 
+               long NumTrials)
+{
+   long k = n.length();
+
+   res.SetLength(k);
+   tm.SetLength(k);
+
+   if (k == 0) return;
+
+   if (((unsigned long) k) >> (NTL_BITS_PER_NONCE-1))
+      ResourceError("ProbPrime: too many numbers");
+
+   ZZ seed;
+   RandomBits(seed, 256);
+
+   long nt = min(AvailableThreads(), k);
+   AtomicCounter counter(0);
+
+   // each of the nt workers takes numbers from counter, so none of
+   // them needs its own index
+
+   auto worker = [&](long) {
+      RandomStreamPush push;
+
+      SetSeed(seed);
+      RandomStream& stream = GetCurrentRandomStream();
+
+      for (;;) {
+         unsigned long i = counter.inc();
+         if (i >= (unsigned long) k) break;
+
+         stream.set_nonce(i);
+
+         double t = GetWallTime();
+         res[i] = ProbPrime(n[i], NumTrials);
+         tm[i] = GetWallTime() - t;
+      }
+   };
+
+#ifdef NTL_THREAD_BOOST
+   BasicThreadPool::relaxed_exec_index(GetThreadPool(), nt, worker);
+#else
+   worker(0);
+#endif
+}
+
+void ProbPrime(Vec<long>& res, const Vec<ZZ>& n, long NumTrials)
+{
+   Vec<double> tm;
+   ProbPrime(res, tm, n, NumTrials);
+}
+
+
+/**********************************************************************
+
+   Interval sieve for prime search
+
+   To search n, n+2, n+4, ... for primes, a whole window of candidates
+   is sieved at once: a single residue n mod p locates all multiples
+   of p in the window, and the residues themselves are obtained
+   through the grouped products of the trial division table.  Only
+   the survivors are handed to MillerWitness.
+
+   Since the cost per prime is shared by the whole window, the sieve
+   can afford a larger bound than ProbPrime's trial division.
+
+   This is for NextPrime only:  the first prime after a random
+   starting point is not a uniformly random prime (primes following
+   long gaps are favored), so RandomPrime and GenGermainPrime draw
+   independent candidates instead.
+
+**********************************************************************/
+
+#define INTERVALSIEVE_MAX_BND (1L << 22)
+// keeps the (per thread) table of sieving primes to a few MB
+
+static
+long ComputeSieveBound(long bn)
+{
+   long prime_bnd = ComputePrimeBound(bn);
+
+   if (prime_bnd > INTERVALSIEVE_MAX_BND/64)
+      return max(prime_bnd, INTERVALSIEVE_MAX_BND);
+   else
+      return 64*prime_bnd;
+}
+
+// number of odd candidates in a search window for l-bit primes
+static
+long ComputeSieveWindow(long l)
+{
+   return max(l, 64L);
+}
+
+// strikes out i = i0, i0+p, ... where n + 2*i0 = 0 (mod p)
+// and n = s (mod p), 0 <= s < p
+static inline
+void IntervalStrike(unsigned char *sv, long len, long p, long s)
+{
+   long i = p - s;
+   if (i == p) i = 0;
+   if (i & 1) i += p;
+   i >>= 1;
 
-   long prime_bnd = ComputePrimeBound(NumBits(n));
+   for (; i < len; i += p) sv[i] = 0;
+}
 
+// On return, sv[i] == 0 if n + 2*i (0 <= i < len) has a prime 
+// factor p < bnd.  n must be odd and larger than bnd.
+static
+void IntervalSieve(Vec<unsigned char>& sv, const ZZ& n, long len, long bnd)
+{
+   sv.SetLength(len);
+   unsigned char *svp = sv.elts();
+   memset(svp, 1, len);
 
-   PrimeSeq s;
-   long p;
+   TrialDivTable& T = GetTrialDivTable(bnd);
+   const long *primes = T.primes.elts();
+   const long *gstart = T.gstart.elts();
+   const long *bstart = T.bstart.elts();
 
-   p = s.next();
-   while (p && p < prime_bnd) {
-      if (rem(n, p) == 0)
-         return 0;
+   NTL_ZZRegister(r);
+   long nb = T.bprod.length();
+   long b;
 
-      p = s.next();
-   }
+   // blocks all of whose primes are < bnd
 
-   ZZ W;
-   W = 2;
+   for (b = 0; b < nb && primes[gstart[bstart[b+1]]-1] < bnd; b++) {
+      rem(r, n, T.bprod[b]);
 
-   // first try W == 2....the exponentiation
-   // algorithm runs slightly faster in this case
+      for (long j = bstart[b]; j < bstart[b+1]; j++) {
+         long s = rem(r, T.gprod[j]);
 
-   if (MillerWitness(n, W))
-      return 0;
+         for (long i = gstart[j]; i < gstart[j+1]; i++) {
+            long p = primes[i];
+            if (p == 2) continue;
+            IntervalStrike(svp, len, p, s % p);
+         }
+      }
+   }
 
+   // what remains of the primes < bnd
 
-   long i;
+   for (long j = bstart[b]; j < T.gprod.length() && primes[gstart[j]] < bnd; j++) {
+      long s = rem(n, T.gprod[j]);
 
-   for (i = 0; i < NumTrials; i++) {
-      do {
-         RandomBnd(W, n);
-      } while (W == 0);
-      // W == 0 is not a useful candidate for a witness!
+      for (long i = gstart[j]; i < gstart[j+1] && primes[i] < bnd; i++) {
+         long p = primes[i];
+         if (p == 2) continue;
+         IntervalStrike(svp, len, p, s % p);
+      }
+   }
+}
 
-      if (MillerWitness(n, W)) 
-         return 0;
+// Searches the window n, n+2, ..., n+2*(len-1) for a prime, using
+// NumTrials random witnesses beyond the survivors' base-2 test.
+// On success, n is set to the prime found.
+static
+long IntervalSearch(ZZ& n, long len, long bnd, long NumTrials)
+{
+   Vec<unsigned char> sv;
+   IntervalSieve(sv, n, len, bnd);
+
+   ZZ cand;
+   for (long i = 0; i < len; i++) {
+      if (!sv[i]) continue;
+      add(cand, n, 2*i);
+      if (MillerRabinTest(cand, NumTrials)) {
+         n = cand;
+         return 1;
+      }
    }
 
-   return 1;
+   return 0;
 }
 
 
@@ -793,8 +1891,21 @@ void NextPrime(ZZ& n, const ZZ& m, long NumTrials)
 
    x = m;
 
-   while (!ProbPrime(x, NumTrials))
-      add(x, x, 1);
+   if (NumBits(x) <= NTL_SP_NBITS) {
+      while (!ProbPrime(x, NumTrials))
+         add(x, x, 1);
+
+      n = x;
+      return;
+   }
+
+   long bnd = ComputeSieveBound(NumBits(x));
+   long window = ComputeSieveWindow(NumBits(x));
+
+   if (!IsOdd(x)) add(x, x, 1);
+
+   while (!IntervalSearch(x, window, bnd, NumTrials))
+      add(x, x, 2*window);
 
    n = x;
 }
@@ -961,6 +2072,117 @@ void PowerMod(ZZ& x, const ZZ& a, const ZZ& e, const ZZ& n)
       LowLevelPowerMod(x, a, e, n); 
 }
    
+void ZZReducer::init(const ZZ& nn)
+{
+   if (nn <= 1) LogicError("ZZReducer: modulus must be > 1");
+
+   n = nn;
+   rep.reset(_ntl_reducer_struct_build(n.rep));
+}
+
+
+/**********************************************************************
+
+   Fixed-base exponentiation
+
+   For windows of w bits, the table holds g^(j*2^(w*i)) for 
+   0 <= i < ceil(ebits/w) and 1 <= j < 2^w, in Montgomery form if n 
+   is odd.  Then g^e is the product of one table entry per nonzero
+   w-bit digit of e, and no squarings are needed.
+
+**********************************************************************/
+
+#define POWERMOD_PRECOMP_MAX_BYTES (1L << 23)
+
+void PowerModPrecomp::init(const ZZ& gg, const ZZ& nn, long eb, long ww)
+{
+   if (nn <= 1) LogicError("PowerModPrecomp: modulus must be > 1");
+   if (eb < 1) eb = 1;
+
+   long nbytes = NumBytes(nn);
+
+   if (ww <= 0) {
+      // the largest w <= 6 for which the table fits in 
+      // POWERMOD_PRECOMP_MAX_BYTES, but at least 1
+      ww = 6;
+      while (ww > 1 && 
+             double((eb+ww-1)/ww)*double((1L << ww)-1)*double(nbytes) > 
+             double(POWERMOD_PRECOMP_MAX_BYTES))
+         ww--;
+   }
+
+   if (ww > 16) LogicError("PowerModPrecomp: window too large");
+
+   red.init(nn);
+   rem(g, gg, nn);
+   ebits = eb;
+   w = ww;
+   nwin = (ebits+w-1)/w;
+
+   long m = (1L << w) - 1;
+   tab.SetLength(0);
+   tab.SetLength(nwin*m);
+
+   // first column: g^(2^(w*i)), by repeated squaring
+
+   red.ToRep(tab[0], g);
+
+   for (long i = 1; i < nwin; i++) {
+      red.sqr(tab[i*m], tab[(i-1)*m]);
+      for (long k = 1; k < w; k++)
+         red.sqr(tab[i*m], tab[i*m]);
+   }
+
+   // the rest of each row
+
+   const ZZReducer& red1 = red;
+   Vec<ZZ>& tab1 = tab;
+
+   NTL_EXEC_RANGE(nwin, first, last)
+
+      for (long i = first; i < last; i++) {
+         for (long j = 1; j < m; j++)
+            red1.mul(tab1[i*m+j], tab1[i*m+j-1], tab1[i*m]);
+      }
+
+   NTL_EXEC_RANGE_END
+}
+
+void PowerModPrecomp::power(ZZ& x, const ZZ& e) const
+{
+   if (nwin == 0) LogicError("PowerModPrecomp: not initialized");
+
+   if (NumBits(e) > ebits) {
+      PowerMod(x, g, e, red.modulus());
+      return;
+   }
+
+   long m = (1L << w) - 1;
+   long nz = 0;
+   NTL_ZZRegister(res);
+
+   for (long i = 0; i < nwin; i++) {
+      long d = bits(e, w*i, w);
+      if (d == 0) continue;
+
+      if (nz == 0)
+         res = tab[i*m+d-1];
+      else
+         red.mul(res, res, tab[i*m+d-1]);
+
+      nz++;
+   }
+
+   if (nz == 0)
+      set(res);
+   else
+      red.FromRep(res, res);
+
+   if (e < 0) InvMod(res, res, red.modulus());
+
+   x = res;
+}
+
 #ifdef NTL_EXCEPTIONS
 
 void InvModError(const char *s, const ZZ& a, const ZZ& n)
@@ -994,7 +2216,90 @@ long RandomPrime_long(long l, long NumTrials)
 }
 
 
-static Lazy< Vec<char> > lowsieve_storage;
+/**********************************************************************
+
+   Small prime generation
+
+   Primes are sieved in segments of PRIMESIEVE_SEG bytes, with one
+   bit for each number coprime to 30:  bit j of byte k of a segment 
+   starting at 30*k0 stands for 30*(k0+k) + WheelRes[j].
+   The primes 2, 3 and 5 are handled separately.
+
+**********************************************************************/
+
+#define PRIMESIEVE_SEG (1L << 15)   // about the size of an L1 cache
+
+static const long WheelRes[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+
+// WheelInv[j] = WheelRes[j]^{-1} mod 30
+static const long WheelInv[8] = { 1, 13, 11, 7, 23, 19, 17, 29 };
+
+// WheelIdx[r] = j if r == WheelRes[j], and -1 otherwise
+static const signed char WheelIdx[30] = {
+   -1,  0, -1, -1, -1, -1, -1,  1, -1, -1, 
+   -1,  2, -1,  3, -1, -1, -1,  4, -1,  5, 
+   -1, -1, -1,  6, -1, -1, -1, -1, -1,  7
+};
+
+// returns the least k >= 0 such that 30*(k0+k) + WheelRes[j] is a
+// multiple of p that is at least p^2, where S = 30*k0, s = S mod p,
+// and p >= 7 is prime
+static inline
+unsigned long long WheelFirst(unsigned long long S, long s, long p, long j)
+{
+   long pinv = WheelInv[WheelIdx[p % 30]];
+   unsigned long long pp = ((unsigned long long) p)*((unsigned long long) p);
+
+   if (pp >= S) {
+      // p*q with q >= p, q = WheelRes[j]/p mod 30
+      long t = (WheelRes[j]*pinv) % 30;
+      long q = p + (t - p % 30 + 30) % 30;
+      return (((unsigned long long) p)*((unsigned long long) q) - S - WheelRes[j])/30;
+   }
+   else {
+      // S + d with d = -S mod p, d = WheelRes[j] mod 30
+      long d0 = (s == 0) ? 0 : p - s;
+      long t = (((WheelRes[j] - d0 % 30 + 30) % 30) * pinv) % 30;
+      return (d0 + ((unsigned long long) p)*((unsigned long long) t) - WheelRes[j])/30;
+   }
+}
+
+// sieves the len bytes starting at 30*k0 by the primes bp[0..nbp),
+// which are >= 7 and increasing
+static
+void WheelSieve(unsigned char *seg, long len, unsigned long long k0,
+                const long *bp, long nbp)
+{
+   unsigned long long S = 30*k0;
+
+   for (long k = 0; k < len; k++) seg[k] = 0xff;
+   if (k0 == 0) seg[0] = 0xfe;  // 1 is not a prime
+
+   for (long i = 0; i < nbp; i++) {
+      long p = bp[i];
+      if (((unsigned long long) p)*((unsigned long long) p)/30 >= k0 + len) 
+         break;
+
+      long s = S % p;
+
+      for (long j = 0; j < 8; j++) {
+         unsigned char mask = ~(1 << j);
+         for (unsigned long long k = WheelFirst(S, s, p, j); 
+              k < (unsigned long long) len; k += p)
+            seg[k] &= mask;
+      }
+   }
+}
+
+
+#define PRIMESEQ_LIMIT ((2*NTL_PRIME_BND+1)*(2*NTL_PRIME_BND+1))
+
+struct PrimeSeqTables {
+   Vec<long> bp;              // primes 7 <= p <= 2*NTL_PRIME_BND+1
+   Vec<unsigned char> seg0;   // the first segment
+};
+
+static Lazy<PrimeSeqTables> primeseq_tables;
 // This is a GLOBAL VARIABLE
 
 
@@ -1014,24 +2319,42 @@ long PrimeSeq::next()
    }
 
    if (pshift < 0) {
+      static const long small[3] = { 2, 3, 5 };
+      if (pindex < 2) {
+         pindex++;
+         return small[pindex];
+      }
+
       shift(0);
-      return 2;
    }
 
    for (;;) {
-      const char *p = movesieve;
-      long i = pindex;
+      const unsigned char *p = movesieve;
+      long i = pindex + 1;
+      long j = i & 7;
+
+      for (long k = i >> 3; k < PRIMESIEVE_SEG; k++, j = 0) {
+         unsigned long w = p[k] >> j;
+         if (w) {
+            while (!(w & 1)) {
+               w >>= 1;
+               j++;
+            }
 
-      while ((++i) < NTL_PRIME_BND) {
-         if (p[i]) {
-            pindex = i;
-            return pshift + 2 * i + 3;
+            long res = 30*(pshift + k) + WheelRes[j];
+            if (res > PRIMESEQ_LIMIT) {
+               exhausted = 1;
+               return 0;
+            }
+
+            pindex = 8*k + j;
+            return res;
          }
       }
 
-      long newshift = pshift + 2*NTL_PRIME_BND;
+      long newshift = pshift + PRIMESIEVE_SEG;
 
-      if (newshift > 2 * NTL_PRIME_BND * (2 * NTL_PRIME_BND + 1)) {
+      if (30*newshift > PRIMESEQ_LIMIT) {
          /* end of the road */
          exhausted = 1;
          return 0;
@@ -1043,112 +2366,390 @@ long PrimeSeq::next()
 
 void PrimeSeq::shift(long newshift)
 {
-   long i;
-   long j;
-   long jstep;
-   long jstart;
-   long ibound;
-   char *p;
-
-   if (!lowsieve_storage.built())
+   if (!primeseq_tables.built())
       start();
 
-   const char *lowsieve = lowsieve_storage->elts();
-
+   const PrimeSeqTables& tab = *primeseq_tables;
 
    if (newshift < 0) {
       pshift = -1;
    }
    else if (newshift == 0) {
       pshift = 0;
-      movesieve = lowsieve;
+      movesieve = tab.seg0.elts();
    } 
    else if (newshift != pshift) {
       if (movesieve_mem.length() == 0) {
-         movesieve_mem.SetLength(NTL_PRIME_BND);
+         movesieve_mem.SetLength(PRIMESIEVE_SEG);
       }
 
       pshift = newshift;
-      movesieve = p = movesieve_mem.elts();
-      for (i = 0; i < NTL_PRIME_BND; i++)
+      WheelSieve(movesieve_mem.elts(), PRIMESIEVE_SEG, pshift, 
+                 tab.bp.elts(), tab.bp.length());
+      movesieve = movesieve_mem.elts();
+   }
+
+   pindex = -1;
+   exhausted = 0;
+}
+
+
+void PrimeSeq::start()
+{
+   do {
+      Lazy<PrimeSeqTables>::Builder builder(primeseq_tables);
+      if (!builder()) break;
+
+      UniquePtr<PrimeSeqTables> ptr;
+      ptr.make();
+
+      // the sieving primes, by a plain sieve on the odd numbers
+
+      long bnd = 2*NTL_PRIME_BND+1;
+      Vec<char> v;
+      v.SetLength(NTL_PRIME_BND+1);
+      char *p = v.elts();  // p[i] stands for 2*i+1
+
+      for (long i = 0; i <= NTL_PRIME_BND; i++)
          p[i] = 1;
 
-      jstep = 3;
-      ibound = pshift + 2 * NTL_PRIME_BND + 1;
-      for (i = 0; jstep * jstep <= ibound; i++) {
-         if (lowsieve[i]) {
-            if (!((jstart = (pshift + 2) / jstep + 1) & 1))
-               jstart++;
-            if (jstart <= jstep)
-               jstart = jstep;
-            jstart = (jstart * jstep - pshift - 3) / 2;
-            for (j = jstart; j < NTL_PRIME_BND; j += jstep)
+      for (long i = 1; (2*i+1)*(2*i+1) <= bnd; i++) {
+         if (p[i]) {
+            for (long j = (2*i+1)*(2*i+1)/2; j <= NTL_PRIME_BND; j += 2*i+1)
                p[j] = 0;
          }
-         jstep += 2;
       }
+
+      for (long i = 3; i <= NTL_PRIME_BND; i++) 
+         if (p[i]) ptr->bp.append(2*i+1);
+
+      ptr->seg0.SetLength(PRIMESIEVE_SEG);
+      WheelSieve(ptr->seg0.elts(), PRIMESIEVE_SEG, 0, 
+                 ptr->bp.elts(), ptr->bp.length());
+
+      builder.move(ptr);
+   } while (0);
+}
+
+void PrimeSeq::reset(long b)
+{
+   if (b > PRIMESEQ_LIMIT) {
+      exhausted = 1;
+      return;
+   }
+
+   if (b <= 5) {
+      shift(-1);
+      if (b <= 2)
+         pindex = -1;
+      else if (b == 3)
+         pindex = 0;
+      else
+         pindex = 1;
+
+      return;
    }
 
+   long k = b / 30;
+   long r = b % 30;
+   long j = 0;
+   while (WheelRes[j] < r) j++;
+
+   shift((k / PRIMESIEVE_SEG) * PRIMESIEVE_SEG);
+   pindex = 8*(k - pshift) + j - 1;
+}
+
+
+
+// Beyond PRIMERANGE_SIEVE_BND^2, the numbers are sieved only by the
+// primes up to PRIMERANGE_SIEVE_BND, and the survivors are tested
+// with IsPrime64.
+
+#define PRIMERANGE_SIEVE_BND (1L << 20)
+
+static const long PrimeRangeSmall[3] = { 2, 3, 5 };
+
+PrimeRange::PrimeRange(unsigned long long lo_, unsigned long long hi_)
+{
+   lo = lo_;
+   hi = hi_;
+   small = 0;
    pindex = -1;
-   exhausted = 0;
+   len = 0;
+   nactive = 0;
+   exhausted = (lo > hi);
+   k0 = lo/30;
+
+   // sieving primes up to min(sqrt(hi), PRIMERANGE_SIEVE_BND)
+
+   unsigned long long r = (unsigned long long) sqrt(double(hi));
+   while (r > 0 && (r > 0xffffffffULL || r*r > hi)) r--;
+   while (r < 0xffffffffULL && (r+1)*(r+1) <= hi) r++;
+
+   test = (r > (unsigned long long) PRIMERANGE_SIEVE_BND);
+   long bnd = test ? PRIMERANGE_SIEVE_BND : long(r);
+
+   PrimeSeq s;
+   s.reset(7);
+   long p;
+   while ((p = s.next()) && p <= bnd) bp.append(p);
+
+   off.SetLength(8*bp.length());
 }
 
+void PrimeRange::sieve()
+{
+   len = PRIMESIEVE_SEG;
+   if (hi/30 - k0 + 1 < (unsigned long long) len) len = long(hi/30 - k0 + 1);
+
+   if (seg.length() < len) seg.SetLength(len);
+   unsigned char *sp = seg.elts();
+
+   for (long k = 0; k < len; k++) sp[k] = 0xff;
+   if (k0 == 0) sp[0] = 0xfe;  // 1 is not a prime
+
+   unsigned long long S = 30*k0;
+   long nbp = bp.length();
+   const long *bpp = bp.elts();
+   long *offp = off.elts();
+
+   // primes whose squares have been reached
+
+   while (nactive < nbp && 
+          ((unsigned long long) bpp[nactive])*((unsigned long long) bpp[nactive])/30 
+             < k0 + len) {
+      long p = bpp[nactive];
+      long s = S % p;
+      for (long j = 0; j < 8; j++) 
+         offp[8*nactive + j] = long(WheelFirst(S, s, p, j));
+      nactive++;
+   }
+
+   for (long i = 0; i < nactive; i++) {
+      long p = bpp[i];
+      long *o = offp + 8*i;
 
-void PrimeSeq::start()
+      for (long j = 0; j < 8; j++) {
+         unsigned char mask = ~(1 << j);
+         long k;
+         for (k = o[j]; k < len; k += p) 
+            sp[k] &= mask;
+         o[j] = k - len;
+      }
+   }
+
+   pindex = -1;
+}
+
+unsigned long long PrimeRange::next()
 {
-   long i;
-   long j;
-   long jstep;
-   long jstart;
-   long ibnd;
-   char *p;
+   if (exhausted) return 0;
 
-   do {
-      Lazy< Vec<char> >::Builder builder(lowsieve_storage);
-      if (!builder()) break;
+   while (small < 3) {
+      unsigned long long p = PrimeRangeSmall[small++];
+      if (p >= lo && p <= hi) return p;
+   }
+
+   if (len == 0) sieve();
+
+   unsigned long long sqbnd = 
+      ((unsigned long long) PRIMERANGE_SIEVE_BND)*
+      ((unsigned long long) PRIMERANGE_SIEVE_BND);
+
+   for (;;) {
+      const unsigned char *sp = seg.elts();
+      long i = pindex + 1;
+      long j = i & 7;
+
+      for (long k = i >> 3; k < len; k++, j = 0) {
+         unsigned long w = sp[k] >> j;
+
+         for (; w; w >>= 1, j++) {
+            if (!(w & 1)) continue;
+
+            pindex = 8*k + j;
+
+            unsigned long long base = 30*(k0 + k);
+            if ((unsigned long long) WheelRes[j] > hi - base) {
+               exhausted = 1;
+               return 0;
+            }
+
+            unsigned long long n = base + WheelRes[j];
+            if (n < lo) continue;
+            if (test && n > sqbnd && !IsPrime64(n)) continue;
+
+            return n;
+         }
+      }
+
+      if (!advance()) return 0;
+   }
+}
+
+// moves on to the next segment
+long PrimeRange::advance()
+{
+   if (k0 + len > hi/30) {
+      exhausted = 1;
+      return 0;
+   }
+
+   k0 += len;
+   sieve();
+   return 1;
+}
+
+static inline
+long PopCount64(unsigned long long x)
+{
+   x = x - ((x >> 1) & 0x5555555555555555ULL);
+   x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+   x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+   return long((x * 0x0101010101010101ULL) >> 56);
+}
+
+unsigned long long PrimeRange::count()
+{
+   unsigned long long c = 0;
+
+   if (test) {
+      while (next()) c++;
+      return c;
+   }
+
+   if (exhausted) return 0;
+
+   while (small < 3) {
+      unsigned long long p = PrimeRangeSmall[small++];
+      if (p >= lo && p <= hi) c++;
+   }
+
+   if (len == 0) sieve();
+
+   for (;;) {
+      const unsigned char *sp = seg.elts();
+
+      if (pindex == -1 && 30*k0 >= lo && 
+          hi >= 29 && k0 + len - 1 <= (hi - 29)/30) {
+         // the whole segment is inside [lo, hi]
+
+         long k = 0;
+         for (; k + 8 <= len; k += 8) {
+            unsigned long long w;
+            memcpy(&w, sp + k, 8);
+            c += PopCount64(w);
+         }
+         for (; k < len; k++)
+            c += PopCount64(sp[k]);
+      }
+      else {
+         long i = pindex + 1;
+         long j = i & 7;
+
+         for (long k = i >> 3; k < len; k++, j = 0) {
+            unsigned long w = sp[k] >> j;
+
+            for (; w; w >>= 1, j++) {
+               if (!(w & 1)) continue;
+
+               unsigned long long base = 30*(k0 + k);
+               if ((unsigned long long) WheelRes[j] > hi - base) {
+                  exhausted = 1;
+                  return c;
+               }
+
+               if (base + WheelRes[j] >= lo) c++;
+            }
+         }
+      }
+
+      if (!advance()) break;
+   }
+
+   return c;
+}
+
+
+// splits [lo, hi] into pieces of at least one segment for the
+// thread pool; the pieces are [lo + i*step, lo + (i+1)*step - 1],
+// with the last one extending to hi
+static
+long PrimeRangeSplit(unsigned long long& step, 
+                     unsigned long long lo, unsigned long long hi)
+{
+   unsigned long long width = hi - lo;
+   unsigned long long segw = 30*((unsigned long long) PRIMESIEVE_SEG);
+   unsigned long long nc = width/segw + 1;
+   unsigned long long maxnc = 8*AvailableThreads();
+
+   if (nc > maxnc) nc = maxnc;
+   step = width/nc;
+   return long(nc);
+}
+
+void PrimeList(Vec<unsigned long long>& v, 
+               unsigned long long lo, unsigned long long hi)
+{
+   v.SetLength(0);
+   if (lo > hi) return;
+
+   unsigned long long step;
+   long nc = PrimeRangeSplit(step, lo, hi);
+
+   Vec< Vec<unsigned long long> > res;
+   res.SetLength(nc);
 
-      UniquePtr< Vec<char> > ptr;
-      ptr.make();
-      ptr->SetLength(NTL_PRIME_BND);
+   NTL_EXEC_RANGE(nc, first, last)
 
-      p = ptr->elts();
+      for (long i = first; i < last; i++) {
+         unsigned long long a = lo + i*step;
+         unsigned long long b = (i == nc-1) ? hi : a + step - 1;
 
-      for (i = 0; i < NTL_PRIME_BND; i++)
-         p[i] = 1;
-         
-      jstep = 1;
-      jstart = -1;
-      ibnd = (SqrRoot(2 * NTL_PRIME_BND + 1) - 3) / 2;
-      for (i = 0; i <= ibnd; i++) {
-         jstart += 2 * ((jstep += 2) - 1);
-         if (p[i])
-            for (j = jstart; j < NTL_PRIME_BND; j += jstep)
-               p[j] = 0;
+         PrimeRange r(a, b);
+         unsigned long long p;
+         while ((p = r.next())) res[i].append(p);
       }
 
-      builder.move(ptr);
-   } while (0);
+   NTL_EXEC_RANGE_END
 
+   long n = 0;
+   for (long i = 0; i < nc; i++) n += res[i].length();
+
+   v.SetLength(n);
+   n = 0;
+   for (long i = 0; i < nc; i++) 
+      for (long j = 0; j < res[i].length(); j++)
+         v[n++] = res[i][j];
 }
 
-void PrimeSeq::reset(long b)
+unsigned long long CountPrimes(unsigned long long lo, unsigned long long hi)
 {
-   if (b > (2*NTL_PRIME_BND+1)*(2*NTL_PRIME_BND+1)) {
-      exhausted = 1;
-      return;
-   }
+   if (lo > hi) return 0;
 
-   if (b <= 2) {
-      shift(-1);
-      return;
-   }
+   unsigned long long step;
+   long nc = PrimeRangeSplit(step, lo, hi);
+
+   Vec<unsigned long long> cnt(INIT_SIZE, nc, 0);
+
+   NTL_EXEC_RANGE(nc, first, last)
 
-   if ((b & 1) == 0) b++;
+      for (long i = first; i < last; i++) {
+         unsigned long long a = lo + i*step;
+         unsigned long long b = (i == nc-1) ? hi : a + step - 1;
 
-   shift(((b-3) / (2*NTL_PRIME_BND))* (2*NTL_PRIME_BND));
-   pindex = (b - pshift - 3)/2 - 1;
+         PrimeRange r(a, b);
+         cnt[i] = r.count();
+      }
+
+   NTL_EXEC_RANGE_END
+
+   unsigned long long c = 0;
+   for (long i = 0; i < nc; i++) c += cnt[i];
+   return c;
 }
- 
+
+
 long Jacobi(const ZZ& aa, const ZZ& nn)
 {
    ZZ a, n;
@@ -3509,14 +5110,53 @@ unsigned long RandomWord()
 }
 
 
+// the bulk generators below read at most this many bytes 
+// from the stream at a time
+
+#define VECTOR_RANDOM_BUF (4096)
+
 void VectorRandomWord(long k, unsigned long* x)
 {
    RandomStream& stream = LocalGetCurrentRandomStream();
-   unsigned char buf[NTL_BITS_PER_LONG/8];
+   unsigned char buf[VECTOR_RANDOM_BUF];
 
-   for (long i = 0; i < k; i++) {
-      stream.get(buf, NTL_BITS_PER_LONG/8);
-      x[i] = WordFromBytes(buf, NTL_BITS_PER_LONG/8);
+   const long nb = NTL_BITS_PER_LONG/8;
+
+   for (long i = 0; i < k; ) {
+      long m = min(k-i, VECTOR_RANDOM_BUF/nb);
+      stream.get(buf, m*nb);
+      for (long j = 0; j < m; j++)
+         x[i+j] = WordFromBytes(buf + j*nb, nb);
+      i += m;
+   }
+}
+
+void VectorRandomBnd(long k, long* x, long n)
+{
+   if (k <= 0) return;
+
+   if (n <= 1) {
+      for (long i = 0; i < k; i++) x[i] = 0;
+      return;
+   }
+
+   RandomStream& stream = LocalGetCurrentRandomStream();
+   unsigned char buf[VECTOR_RANDOM_BUF];
+
+   long l = NumBits(n-1);
+   long nb = (l+7)/8;
+   unsigned long mask = (1UL << l)-1UL;
+
+   // k candidates are needed at least, so reading them all at once
+   // leaves the stream where k single calls would leave it
+
+   for (long i = 0; i < k; ) {
+      long m = min(k-i, VECTOR_RANDOM_BUF/nb);
+      stream.get(buf, m*nb);
+      for (long j = 0; j < m; j++) {
+         long tmp = long(WordFromBytes(buf + j*nb, nb) & mask);
+         if (tmp < n) x[i++] = tmp;
+      }
    }
 }
 
@@ -3740,6 +5380,240 @@ void RandomBnd(ZZ& x, const ZZ& bnd)
 
 
 
+/**********************************************************
+
+Bulk generation of random ZZ's.  VectorRandomBndStream consumes
+the stream exactly as k calls to RandomBnd would (including the
+early rejection on the top two bytes), but reads it a buffer at
+a time.  This is safe because, with m values still to be
+generated, at least m*nb more bytes will be consumed, so at most
+that many are read ahead.  (Fixed-width candidates, which would
+allow the rejection test to be done on a whole buffer at once,
+use up to twice as many bytes, and the keystream is the
+dominant cost.)
+
+For large outputs, the blocks of VECTOR_RANDOM_BLOCK bytes
+come from independent substreams, as described in ZZ.h.
+
+***********************************************************/
+
+#define VECTOR_RANDOM_SPLIT (1L << 18)
+#define VECTOR_RANDOM_BLOCK (1L << 14)
+
+
+class RandomReadAhead {
+public:
+   RandomStream& stream;
+   unsigned char *buf;
+   long cap, pos, end;
+
+   RandomReadAhead(RandomStream& _stream, unsigned char *_buf, long _cap) 
+      : stream(_stream), buf(_buf), cap(_cap), pos(0), end(0) { }
+
+   // returns the next n bytes, reading at most lim bytes ahead
+   // (n <= lim, n <= cap)
+
+   const unsigned char *get(long n, long lim)
+   {
+      if (end - pos < n) {
+         long left = end - pos;
+         if (left > 0) std::memmove(buf, buf + pos, left);
+         pos = 0;
+         end = min(cap, lim);
+         stream.get(buf + left, end - left);
+      }
+
+      const unsigned char *res = buf + pos;
+      pos += n;
+      return res;
+   }
+};
+
+
+static
+void VectorRandomBndStream(long k, ZZ* const *x, const ZZ& bnd, 
+                           RandomStream& stream)
+{
+   long l = NumBits(bnd);
+   long nb = (l+7)/8;
+
+   long cap = max(nb, long(VECTOR_RANDOM_BUF));
+
+   NTL_TLS_LOCAL(Vec<unsigned char>, buf_mem);
+   Vec<unsigned char>::Watcher watch_buf_mem(buf_mem);
+   buf_mem.SetLength(cap + nb);
+   unsigned char *buf = buf_mem.elts() + cap;
+
+   RandomReadAhead rd(stream, buf_mem.elts(), cap);
+
+   long sz = (l + NTL_ZZ_NBITS - 1)/NTL_ZZ_NBITS;
+   for (long i = 0; i < k; i++) x[i]->SetSize(sz);
+   // pre-allocate, as RandomBnd does, so that the stream is
+   // not consumed if an allocation fails
+
+   if (nb <= 3) {
+      long lbnd = conv<long>(bnd);
+      unsigned long lmask = (1UL << l) - 1UL;
+
+      for (long i = 0; i < k; ) {
+         const unsigned char *c = rd.get(nb, (k-i)*nb);
+         long ltmp = long(WordFromBytes(c, nb) & lmask);
+         if (ltmp < lbnd) conv(*x[i++], ltmp);
+      }
+
+      return;
+   }
+
+   NTL_ZZRegister(hbnd);
+   RightShift(hbnd, bnd, (nb-2)*8);
+   long lhbnd = conv<long>(hbnd);
+
+   unsigned long mask = (1UL << (16 - nb*8 + l)) - 1UL;
+
+   for (long i = 0; i < k; ) {
+      long lim = (k-i)*nb;
+      long hpart = long(WordFromBytes(rd.get(2, lim), 2) & mask);
+
+      if (hpart > lhbnd) continue;
+
+      std::memcpy(buf, rd.get(nb-2, lim-2), nb-2);
+      buf[nb-2] = ((unsigned long) hpart);
+      buf[nb-1] = ((unsigned long) hpart) >> 8; 
+
+      ZZFromBytes(*x[i], buf, nb);
+      if (hpart < lhbnd || *x[i] < bnd) i++;
+   }
+}
+
+
+static
+void VectorRandomBitsStream(long k, ZZ* x, long l, RandomStream& stream)
+{
+   long nb = (l+7)/8;
+   unsigned char mask = (unsigned char) ((1UL << (8 - nb*8 + l)) - 1UL);
+
+   long m0 = max(1L, VECTOR_RANDOM_BUF/nb);
+
+   NTL_TLS_LOCAL(Vec<unsigned char>, buf_mem);
+   Vec<unsigned char>::Watcher watch_buf_mem(buf_mem);
+   buf_mem.SetLength(m0*nb);
+   unsigned char *buf = buf_mem.elts();
+
+   long sz = (l + NTL_ZZ_NBITS - 1)/NTL_ZZ_NBITS;
+   for (long i = 0; i < k; i++) x[i].SetSize(sz);
+   // pre-allocate, as RandomBits does
+
+   for (long i = 0; i < k; ) {
+      long m = min(k-i, m0);
+      stream.get(buf, m*nb);
+
+      for (long j = 0; j < m; j++) {
+         buf[j*nb + nb-1] &= mask;
+         ZZFromBytes(x[i+j], buf + j*nb, nb);
+      }
+
+      i += m;
+   }
+}
+
+
+void VectorRandomBnd(long k, ZZ* const *x, const ZZ& bnd)
+{
+   if (k <= 0) return;
+
+   if (bnd <= 1) {
+      for (long i = 0; i < k; i++) clear(*x[i]);
+      return;
+   }
+
+   // bnd may alias some *x[i]
+   ZZ b(bnd);
+
+   long nb = NumBytes(b);
+
+   if (double(k)*double(nb) < VECTOR_RANDOM_SPLIT) {
+      VectorRandomBndStream(k, x, b, LocalGetCurrentRandomStream());
+      return;
+   }
+
+   ZZ seed;
+   RandomBits(seed, 256);
+
+   long bsz = max(1L, VECTOR_RANDOM_BLOCK/nb);
+   long nblocks = (k + bsz - 1)/bsz;
+
+   NTL_EXEC_RANGE(nblocks, first, last)
+
+      RandomStreamPush push;
+      SetSeed(seed);
+      RandomStream& stream = LocalGetCurrentRandomStream();
+
+      for (long blk = first; blk < last; blk++) {
+         stream.set_nonce(blk);
+         long lo = blk*bsz;
+         long hi = min(k, lo+bsz);
+         VectorRandomBndStream(hi-lo, x+lo, b, stream);
+      }
+
+   NTL_EXEC_RANGE_END
+}
+
+
+void VectorRandomBnd(long k, ZZ* x, const ZZ& bnd)
+{
+   if (k <= 0) return;
+
+   Vec<ZZ*> xp;
+   xp.SetLength(k);
+   for (long i = 0; i < k; i++) xp[i] = &x[i];
+
+   VectorRandomBnd(k, xp.elts(), bnd);
+}
+
+
+void VectorRandomBits(long k, ZZ* x, long l)
+{
+   if (k <= 0) return;
+
+   if (l <= 0) {
+      for (long i = 0; i < k; i++) clear(x[i]);
+      return;
+   }
+
+   if (NTL_OVERFLOW(l, 1, 0))
+      ResourceError("VectorRandomBits: length too big");
+
+   long nb = (l+7)/8;
+
+   if (double(k)*double(nb) < VECTOR_RANDOM_SPLIT) {
+      VectorRandomBitsStream(k, x, l, LocalGetCurrentRandomStream());
+      return;
+   }
+
+   ZZ seed;
+   RandomBits(seed, 256);
+
+   long bsz = max(1L, VECTOR_RANDOM_BLOCK/nb);
+   long nblocks = (k + bsz - 1)/bsz;
+
+   NTL_EXEC_RANGE(nblocks, first, last)
+
+      RandomStreamPush push;
+      SetSeed(seed);
+      RandomStream& stream = LocalGetCurrentRandomStream();
+
+      for (long blk = first; blk < last; blk++) {
+         stream.set_nonce(blk);
+         long lo = blk*bsz;
+         long hi = min(k, lo+bsz);
+         VectorRandomBitsStream(hi-lo, x+lo, l, stream);
+      }
+
+   NTL_EXEC_RANGE_END
+}
+
+
+
 // More prime generation stuff...
 
 static
@@ -3864,6 +5738,154 @@ long GenPrime_long(long k, long err)
    return RandomPrime_long(k, t);
 }
 
+
+/**********************************************************************
+
+   Random candidates for Germain primes
+
+   GenGermainPrime tests independent random candidates q until both q
+   and 2*q+1 are found to be prime, so that every k-bit Germain prime
+   is equally likely.  The candidates are drawn uniformly from the
+   k-bit numbers q such that q and 2*q+1 are both prime to
+   M = 2*3*5*...*p_r, with M < 2^(k-8):  such a q is j*M + b, where j
+   is random and b is random modulo M, with independent residues
+   modulo 3, ..., p_r that are different from 0 and (p-1)/2, and b odd.
+   The few that fall outside [2^(k-1), 2^k) are drawn again.  Since
+   every k-bit Germain prime is of this form, this only saves the
+   tests of the candidates that trial division would reject.
+
+**********************************************************************/
+
+// returns 1 if q or 2*q+1 is divisible by a prime p < bnd, 
+// and 0 otherwise (q odd and larger than bnd)
+static
+long GermainTrialDivision(const ZZ& q, long bnd)
+{
+   TrialDivTable& T = GetTrialDivTable(bnd);
+   const long *primes = T.primes.elts();
+   const long *gstart = T.gstart.elts();
+   const long *bstart = T.bstart.elts();
+
+   NTL_ZZRegister(r);
+   long nb = T.bprod.length();
+   long b;
+
+   // 2*q+1 = 0 mod p iff q = (p-1)/2 mod p
+
+   for (b = 0; b < nb && primes[gstart[bstart[b+1]]-1] < bnd; b++) {
+      rem(r, q, T.bprod[b]);
+
+      for (long j = bstart[b]; j < bstart[b+1]; j++) {
+         long s = rem(r, T.gprod[j]);
+
+         for (long i = gstart[j]; i < gstart[j+1]; i++) {
+            long p = primes[i];
+            long t = s % p;
+            if (t == 0 || t == (p-1)/2) return 1;
+         }
+      }
+   }
+
+   for (long j = bstart[b]; j < T.gprod.length() && primes[gstart[j]] < bnd; j++) {
+      long s = rem(q, T.gprod[j]);
+
+      for (long i = gstart[j]; i < gstart[j+1] && primes[i] < bnd; i++) {
+         long p = primes[i];
+         long t = s % p;
+         if (t == 0 || t == (p-1)/2) return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+class GermainCandidates {
+public:
+   explicit GermainCandidates(long k);
+
+   void next(ZZ& q) const;
+   // q = the next candidate, using the current random stream
+
+private:
+   long k;
+   Vec<long> primes;  // the odd primes dividing M
+   Vec<ZZ> basis;     // basis[i] = 1 mod primes[i], 0 mod M/primes[i]
+   ZZ basis2;         // 1 mod 2, 0 mod M/2
+   ZZ M;
+   ZZ jlo, jnum;      // j is in [jlo, jlo+jnum)
+};
+
+GermainCandidates::GermainCandidates(long k_) : k(k_)
+{
+   M = 2;
+
+   PrimeSeq s;
+   long p = s.next();  // 2
+   for (p = s.next(); p && NumBits(M) + NumBits(p) <= k-8; p = s.next()) {
+      primes.append(p);
+      mul(M, M, p);
+   }
+
+   long r = primes.length();
+   basis.SetLength(r);
+
+   ZZ t;
+   for (long i = 0; i < r; i++) {
+      p = primes[i];
+      div(t, M, p);
+      mul(basis[i], t, InvMod(rem(t, p), p));
+   }
+
+   div(basis2, M, 2);
+   if (!IsOdd(basis2)) add(basis2, basis2, M);
+   rem(basis2, basis2, M);
+
+   ZZ lo, hi;
+   power2(lo, k-1);
+   power2(hi, k);
+   sub(hi, hi, 1);
+
+   div(jlo, lo, M);
+   div(jnum, hi, M);
+   sub(jnum, jnum, jlo);
+   add(jnum, jnum, 1);
+}
+
+void GermainCandidates::next(ZZ& q) const
+{
+   NTL_ZZRegister(b);
+   NTL_ZZRegister(j);
+
+   long r = primes.length();
+   const long *pp = primes.elts();
+   const ZZ *bp = basis.elts();
+
+   do {
+      // b is random modulo M, and the residues that are not allowed
+      // are replaced by random ones that are
+      RandomBnd(b, M);
+      if (!IsOdd(b)) add(b, b, basis2);
+
+      for (long i = 0; i < r; i++) {
+         long p = pp[i];
+         long t = rem(b, p);
+         if (t == 0 || t == (p-1)/2) {
+            long t1 = 1 + RandomBnd(p-2);
+            if (t1 >= (p-1)/2) t1++;
+            MulAddTo(b, bp[i], SubMod(t1, t, p));
+         }
+      }
+      rem(b, b, M);
+
+      RandomBnd(j, jnum);
+      add(j, j, jlo);
+      mul(q, j, M);
+      add(q, q, b);
+   } while (NumBits(q) != k);
+}
+
+
 void MultiThreadedGenGermainPrime(ZZ& n, long k, long err)
 {
    long nt = AvailableThreads();
@@ -3874,6 +5896,8 @@ void MultiThreadedGenGermainPrime(ZZ& n, long k, long err)
    if (NumBits(prime_bnd) >= k/2)
       prime_bnd = (1L << (k/2-1));
 
+   GermainCandidates gen(k);
+
    ZZ two;
    two = 2;
 
@@ -3905,7 +5929,6 @@ void MultiThreadedGenGermainPrime(ZZ& n, long k, long err)
 	 RandomStream& stream = GetCurrentRandomStream();
 
 	 ZZ cand, n1;
-         PrimeSeq s;
 
 	 while (low_water_mark == -1UL) {
 
@@ -3921,34 +5944,9 @@ void MultiThreadedGenGermainPrime(ZZ& n, long k, long err)
 				local_ctr <= low_water_mark; iter++) {
 
 
-	       RandomLen(cand, k);
-	       if (!IsOdd(cand)) add(cand, cand, 1);
-
-	       s.reset(3);
-	       long p;
-
-	       long sieve_passed = 1;
-
-	       p = s.next();
-	       while (p && p < prime_bnd) {
-		  long r = rem(cand, p);
-
-		  if (r == 0) {
-		     sieve_passed = 0;
-		     break;
-		  }
-
-		  // test if 2*r + 1 = 0 (mod p)
-		  if (r == p-r-1) {
-		     sieve_passed = 0;
-		     break;
-		  }
-
-		  p = s.next();
-	       }
-
-               if (!sieve_passed) continue;
+	       gen.next(cand);
 
+               if (GermainTrialDivision(cand, prime_bnd)) continue;
 
                if (MillerWitness(cand, two)) continue;
 
@@ -4066,15 +6064,14 @@ void GenGermainPrime(ZZ& n, long k, long err)
    if (NumBits(prime_bnd) >= k/2)
       prime_bnd = (1L << (k/2-1));
 
+   GermainCandidates gen(k);
+
 
    ZZ two;
    two = 2;
 
    ZZ n1;
 
-   
-   PrimeSeq s;
-
    ZZ iter;
    iter = 0;
 
@@ -4082,33 +6079,9 @@ void GenGermainPrime(ZZ& n, long k, long err)
    for (;;) {
       iter++;
 
-      RandomLen(n, k);
-      if (!IsOdd(n)) add(n, n, 1);
-
-      s.reset(3);
-      long p;
-
-      long sieve_passed = 1;
-
-      p = s.next();
-      while (p && p < prime_bnd) {
-         long r = rem(n, p);
-
-         if (r == 0) {
-            sieve_passed = 0;
-            break;
-         }
-
-         // test if 2*r + 1 = 0 (mod p)
-         if (r == p-r-1) {
-            sieve_passed = 0;
-            break;
-         }
-
-         p = s.next();
-      }
+      gen.next(n);
 
-      if (!sieve_passed) continue;
+      if (GermainTrialDivision(n, prime_bnd)) continue;
 
 
       if (MillerWitness(n, two)) continue;
@@ -0,0 +1,722 @@
+
+#include <NTL/ZZFactoring.h>
+#include <NTL/ZZ_pX.h>
+#include <NTL/vec_ZZ_p.h>
+#include <NTL/BasicThreadPool.h>
+
+#include <algorithm>
+
+
+NTL_START_IMPL
+
+
+void mul(ZZ& x, const vec_pair_ZZ_long& a)
+{
+   ZZ res, t;
+   set(res);
+
+   for (long i = 0; i < a.length(); i++) {
+      power(t, a[i].a, a[i].b);
+      mul(res, res, t);
+   }
+
+   x = res;
+}
+
+
+
+/**************************************************************
+
+   Brent's variant of Pollard's rho method.
+
+   The map is y -> y^2 + c, with y held in Montgomery form:
+   y -> y^2/R + cR is this map conjugated by the scaling y -> yR,
+   so the same cycle structure is obtained with one SqrMont per step.
+   The differences x-y are multiplied together in blocks of
+   RHO_BLOCK steps before taking a GCD with n; if the product
+   is 0 mod n, the last block is redone one step at a time.
+
+**************************************************************/
+
+
+#define RHO_BLOCK (128)
+
+
+static inline
+void RhoStep(ZZ& y, const ZZ& c, const ZZReducer& red)
+{
+   red.SqrMont(y, y);
+   AddMod(y, y, c, red.modulus());
+}
+
+
+static
+long RhoRun(ZZ& d, const ZZReducer& red, long c0, long& iters, long MaxIters)
+{
+   const ZZ& n = red.modulus();
+
+   ZZ c, x, y, ys, q, t, g;
+
+   conv(t, c0);
+   red.rem(t, t);
+   red.ToMont(c, t);
+
+   conv(y, 2);
+   red.rem(y, y);
+
+   set(q);
+   set(g);
+
+   long r = 1;
+
+   do {
+      x = y;
+      for (long i = 0; i < r; i++) RhoStep(y, c, red);
+      iters += r;
+
+      long k = 0;
+      do {
+         ys = y;
+         long m = min(long(RHO_BLOCK), r-k);
+         for (long i = 0; i < m; i++) {
+            RhoStep(y, c, red);
+            SubMod(t, x, y, n);
+            red.MulMont(q, q, t);
+         }
+         iters += m;
+         k += m;
+         GCD(g, q, n);
+      } while (k < r && IsOne(g));
+
+      r *= 2;
+   } while (IsOne(g) && iters < MaxIters);
+
+   if (IsOne(g)) return 0;
+
+   if (g == n) {
+      do {
+         RhoStep(ys, c, red);
+         SubMod(t, x, ys, n);
+         GCD(g, t, n);
+      } while (IsOne(g));
+
+      if (g == n) return 0;
+   }
+
+   d = g;
+   return 1;
+}
+
+
+long PollardRho(ZZ& d, const ZZ& n, long MaxIters)
+{
+   if (n <= 1 || !IsOdd(n)) LogicError("PollardRho: bad args");
+
+   ZZReducer red(n);
+
+   long iters = 0;
+   for (long c0 = 1; iters < MaxIters; c0++) {
+      if (RhoRun(d, red, c0, iters, MaxIters)) return 1;
+   }
+
+   return 0;
+}
+
+
+
+/**************************************************************
+
+   The elliptic curve method, on Montgomery curves
+   B y^2 = x^3 + A x^2 + x, with points (X : Z) given by their
+   x-coordinates only.  All coordinates are in Montgomery form
+   with respect to the ZZReducer for n.
+
+   Stage 2 writes each prime s in (B1, B2] as s = iD +/- j, with
+   0 < j < D/2 and gcd(j, D) = 1.  If Q has order s mod p, then
+   x([iD]Q) = x([j]Q) mod p, so p divides the product over i of
+   F(x([iD]Q)), where F is the polynomial with roots x([j]Q).
+   The x-coordinates are normalized using BatchInv, and F is
+   evaluated at a block of giant steps at a time using multipoint
+   evaluation mod n.
+
+**************************************************************/
+
+
+class ECMCurve {
+public:
+   const ZZReducer& red;
+   const ZZ& n;
+   ZZ a24;     // (A+2)/4
+   ZZ t1, t2, t3, t4;
+
+   explicit ECMCurve(const ZZReducer& _red)
+      : red(_red), n(_red.modulus()) { }
+
+   void dbl(ZZ& X2, ZZ& Z2, const ZZ& X, const ZZ& Z);
+
+   // (X3 : Z3) = P + Q, where (Xd : Zd) = P - Q
+   void add(ZZ& X3, ZZ& Z3, const ZZ& XP, const ZZ& ZP,
+            const ZZ& XQ, const ZZ& ZQ, const ZZ& Xd, const ZZ& Zd);
+
+   // k >= 1
+   void mul(ZZ& Xr, ZZ& Zr, const ZZ& X, const ZZ& Z, const ZZ& k);
+
+private:
+   ECMCurve(const ECMCurve&); // disabled
+   void operator=(const ECMCurve&); // disabled
+};
+
+
+void ECMCurve::dbl(ZZ& X2, ZZ& Z2, const ZZ& X, const ZZ& Z)
+{
+   AddMod(t1, X, Z, n);
+   red.SqrMont(t1, t1);
+   SubMod(t2, X, Z, n);
+   red.SqrMont(t2, t2);
+   SubMod(t3, t1, t2, n);
+   red.MulMont(X2, t1, t2);
+   red.MulMont(t4, a24, t3);
+   AddMod(t4, t4, t2, n);
+   red.MulMont(Z2, t3, t4);
+}
+
+
+void ECMCurve::add(ZZ& X3, ZZ& Z3, const ZZ& XP, const ZZ& ZP,
+                   const ZZ& XQ, const ZZ& ZQ, const ZZ& Xd, const ZZ& Zd)
+{
+   SubMod(t1, XP, ZP, n);
+   AddMod(t2, XQ, ZQ, n);
+   red.MulMont(t1, t1, t2);
+   AddMod(t2, XP, ZP, n);
+   SubMod(t3, XQ, ZQ, n);
+   red.MulMont(t2, t2, t3);
+   AddMod(t3, t1, t2, n);
+   red.SqrMont(t3, t3);
+   SubMod(t4, t1, t2, n);
+   red.SqrMont(t4, t4);
+   red.MulMont(t3, Zd, t3);
+   red.MulMont(Z3, Xd, t4);
+   swap(X3, t3);
+}
+
+
+void ECMCurve::mul(ZZ& Xr, ZZ& Zr, const ZZ& X, const ZZ& Z, const ZZ& k)
+{
+   ZZ X0, Z0, X1, Z1, XP, ZP;
+
+   XP = X;
+   ZP = Z;
+
+   X0 = XP;
+   Z0 = ZP;
+   dbl(X1, Z1, XP, ZP);
+
+   for (long i = NumBits(k)-2; i >= 0; i--) {
+      if (bit(k, i)) {
+         add(X0, Z0, X0, Z0, X1, Z1, XP, ZP);
+         dbl(X1, Z1, X1, Z1);
+      }
+      else {
+         add(X1, Z1, X0, Z0, X1, Z1, XP, ZP);
+         dbl(X0, Z0, X0, Z0);
+      }
+   }
+
+   swap(Xr, X0);
+   swap(Zr, Z0);
+}
+
+
+// Sets up the curve and starting point from sigma, by Suyama's
+// parametrization:  u = sigma^2-5, v = 4 sigma, (X : Z) = (u^3 : v^3),
+// (A+2)/4 = (v-u)^3 (3u+v) / (16 u^3 v).
+// Returns 0 if the curve is usable, 1 if d is a factor of n,
+// and -1 otherwise.
+
+static
+long ECMSetup(ZZ& d, ZZ& X, ZZ& Z, ECMCurve& E, const ZZ& sigma)
+{
+   const ZZ& n = E.n;
+   ZZ u, v, t, w, num, den;
+
+   SqrMod(u, sigma, n);
+   SubMod(u, u, 5, n);
+   MulMod(v, sigma, 4, n);
+
+   PowerMod(X, u, 3, n);
+   PowerMod(Z, v, 3, n);
+
+   SubMod(t, v, u, n);
+   PowerMod(num, t, 3, n);
+   MulMod(t, u, 3, n);
+   AddMod(t, t, v, n);
+   MulMod(num, num, t, n);
+
+   MulMod(den, X, v, n);
+   MulMod(den, den, 16, n);
+
+   if (InvModStatus(w, den, n)) {
+      if (w == n) return -1;
+      d = w;
+      return 1;
+   }
+
+   MulMod(t, num, w, n);
+
+   E.red.ToMont(E.a24, t);
+   E.red.ToMont(X, X);
+   E.red.ToMont(Z, Z);
+
+   return 0;
+}
+
+
+// (X : Z) = [k](X : Z) for each prime power k <= B1
+
+static
+void ECMStage1(ZZ& X, ZZ& Z, ECMCurve& E, long B1, const AtomicBool& stop)
+{
+   PrimeSeq s;
+   ZZ k;
+
+   for (long p = s.next(); p && p <= B1 && !stop; p = s.next()) {
+      long q = p;
+      while (q <= B1/p) q *= p;
+      conv(k, q);
+      E.mul(X, Z, X, Z, k);
+   }
+}
+
+
+// the current ZZ_p modulus is n;  x[i] = X[i]/Z[i] mod n.
+// Returns 0 on success, 1 if d is a factor of n, and -1 otherwise.
+
+static
+long ECMNormalize(ZZ& d, vec_ZZ_p& x, const Vec<ZZ>& X, const Vec<ZZ>& Z,
+                  const ZZ& n)
+{
+   long m = X.length();
+
+   vec_ZZ_p z;
+   z.SetLength(m);
+
+   ZZ_p prod;
+   set(prod);
+   for (long i = 0; i < m; i++) {
+      conv(z[i], Z[i]);
+      mul(prod, prod, z[i]);
+   }
+
+   ZZ t;
+   if (InvModStatus(t, rep(prod), n)) {
+      if (t != n) {
+         d = t;
+         return 1;
+      }
+
+      for (long i = 0; i < m; i++) {
+         GCD(t, Z[i], n);
+         if (!IsOne(t) && t != n) {
+            d = t;
+            return 1;
+         }
+      }
+
+      return -1;
+   }
+
+   BatchInv(z, z);
+
+   x.SetLength(m);
+   for (long i = 0; i < m; i++) {
+      conv(x[i], X[i]);
+      mul(x[i], x[i], z[i]);
+   }
+
+   return 0;
+}
+
+
+// D is chosen from these primorials, to minimize the number
+// phi(D)/2 of baby steps plus the number (B2-B1)/D of giant steps
+
+static const long ECMStage2D[] = { 210, 2310, 30030 };
+static const long ECMStage2Phi[] = { 48, 480, 5760 };
+
+
+static
+long ECMStage2(ZZ& d, const ZZ& X, const ZZ& Z, ECMCurve& E,
+               long B1, long B2, const AtomicBool& stop)
+{
+   const ZZ& n = E.n;
+
+   long D = 0, best = 0;
+   for (long l = 0; l < 3; l++) {
+      long cost = ECMStage2Phi[l]/2 + (B2-B1)/ECMStage2D[l];
+      if (D == 0 || cost < best) {
+         D = ECMStage2D[l];
+         best = cost;
+      }
+   }
+
+   long status;
+
+   // baby steps:  [j]Q for odd j < D/2 with gcd(j, D) = 1
+
+   Vec<ZZ> BX, BZ;
+   ZZ X2, Z2, Xj, Zj, Xprev, Zprev;
+
+   E.dbl(X2, Z2, X, Z);
+
+   // [j-2]Q and [j]Q, starting with [-1]Q = [1]Q
+
+   Xprev = X; Zprev = Z;
+   Xj = X; Zj = Z;
+
+   for (long j = 1; j < D/2; j += 2) {
+      if (GCD(j, D) == 1) {
+         append(BX, Xj);
+         append(BZ, Zj);
+      }
+
+      // [j+2]Q = [j]Q + [2]Q, with difference [j-2]Q
+      E.add(Xprev, Zprev, Xj, Zj, X2, Z2, Xprev, Zprev);
+      swap(Xprev, Xj);
+      swap(Zprev, Zj);
+   }
+
+   vec_ZZ_p bx;
+   status = ECMNormalize(d, bx, BX, BZ, n);
+   if (status) return status > 0;
+
+   ZZ_pX F;
+   BuildFromRoots(F, bx);
+   long L = bx.length();
+
+   // giant steps:  [iD]Q for i0 <= i <= i1
+
+   long i0 = max(1L, B1/D);
+   long i1 = B2/D + 1;
+
+   ZZ XD, ZD, Xi, Zi, Xi1, Zi1, k;
+
+   conv(k, D);
+   E.mul(XD, ZD, X, Z, k);
+   conv(k, i0);
+   E.mul(Xi, Zi, XD, ZD, k);
+   conv(k, i0+1);
+   E.mul(Xi1, Zi1, XD, ZD, k);
+
+   Vec<ZZ> GX, GZ;
+   vec_ZZ_p gx, v;
+   ZZ_p acc, t;
+   ZZ g;
+
+   set(acc);
+
+   for (long i = i0; i <= i1 && !stop; ) {
+      GX.SetLength(0);
+      GZ.SetLength(0);
+
+      for (; i <= i1 && GX.length() < L; i++) {
+         append(GX, Xi);
+         append(GZ, Zi);
+
+         // [(i+2)D]Q = [(i+1)D]Q + [D]Q, with difference [iD]Q
+         E.add(Xi, Zi, Xi1, Zi1, XD, ZD, Xi, Zi);
+         swap(Xi, Xi1);
+         swap(Zi, Zi1);
+      }
+
+      status = ECMNormalize(d, gx, GX, GZ, n);
+      if (status) return status > 0;
+
+      eval(v, F, gx);
+      for (long l = 0; l < v.length(); l++)
+         mul(acc, acc, v[l]);
+
+      GCD(g, rep(acc), n);
+      if (!IsOne(g)) {
+         if (g != n) {
+            d = g;
+            return 1;
+         }
+
+         // acc was a unit before this block, so some v[l] is not;
+         // backtrack one giant step, and then one baby step, at a time
+
+         for (long l = 0; l < v.length(); l++) {
+            GCD(g, rep(v[l]), n);
+            if (IsOne(g)) continue;
+            if (g != n) {
+               d = g;
+               return 1;
+            }
+
+            for (long j = 0; j < L; j++) {
+               sub(t, gx[l], bx[j]);
+               GCD(g, rep(t), n);
+               if (!IsOne(g) && g != n) {
+                  d = g;
+                  return 1;
+               }
+            }
+         }
+
+         return 0;
+      }
+   }
+
+   return 0;
+}
+
+
+// the current ZZ_p modulus is n
+
+static
+long ECMOneCurve(ZZ& d, const ZZReducer& red, const ZZ& sigma,
+                 long B1, long B2, const AtomicBool& stop)
+{
+   ECMCurve E(red);
+   ZZ X, Z, g;
+
+   long status = ECMSetup(d, X, Z, E, sigma);
+   if (status) return status > 0;
+
+   ECMStage1(X, Z, E, B1, stop);
+   if (stop) return 0;
+
+   GCD(g, Z, E.n);
+   if (!IsOne(g)) {
+      if (g == E.n) return 0;
+      d = g;
+      return 1;
+   }
+
+   if (B2 <= B1) return 0;
+
+   return ECMStage2(d, X, Z, E, B1, B2, stop);
+}
+
+
+long ECM(ZZ& d, const ZZ& n, long B1, long B2, long NumCurves, long verbose)
+{
+   if (n <= 6 || !IsOdd(n) || B1 < 2) LogicError("ECM: bad args");
+
+   if (NumCurves <= 0) return 0;
+
+   // the curves are chosen up front, so that the choice does not
+   // depend on the thread pool
+
+   Vec<ZZ> sigma;
+   sigma.SetLength(NumCurves);
+   for (long i = 0; i < NumCurves; i++) {
+      RandomBnd(sigma[i], n-6);
+      add(sigma[i], sigma[i], 6);
+   }
+
+   Vec<ZZ> res;
+   res.SetLength(NumCurves);
+
+   ZZ_pContext context(n);
+   AtomicBool found(false);
+
+   NTL_EXEC_RANGE(NumCurves, first, last)
+
+      ZZ_pPush push(context);
+      ZZReducer red(n);
+
+      for (long i = first; i < last && !found; i++) {
+         if (ECMOneCurve(res[i], red, sigma[i], B1, B2, found))
+            found = true;
+      }
+
+   NTL_EXEC_RANGE_END
+
+   if (!found) return 0;
+
+   long i;
+   for (i = 0; IsZero(res[i]); i++) ;
+
+   if (verbose) {
+      cerr << "ECM: factor " << res[i] << " found with sigma = "
+           << sigma[i] << "\n";
+   }
+
+   d = res[i];
+   return 1;
+}
+
+
+
+/**************************************************************
+
+   Complete factorization
+
+**************************************************************/
+
+
+#define FACTOR_TRIAL_BITS (16)
+#define FACTOR_RHO_ITERS (1L << 17)
+
+
+// B1 and number of curves, for factors of about 15, 20, ... 50 digits;
+// each level is run once, and factor gives up after the last one
+
+static const long FactorECMLevels[][2] = {
+   {     2000,    25 },
+   {    11000,    90 },
+   {    50000,   300 },
+   {   250000,   700 },
+   {  1000000,  1800 },
+   {  3000000,  5100 },
+   { 11000000, 10600 },
+   { 43000000, 19300 }
+};
+
+#define FACTOR_ECM_NLEVELS (8)
+
+
+// r = floor(n^(1/k)), for n > 0 and k >= 2, by Newton's method
+// from above
+
+static
+void KthRoot(ZZ& r, const ZZ& n, long k)
+{
+   ZZ x, y, t;
+
+   power2(x, (NumBits(n) + k - 1)/k);
+
+   for (;;) {
+      power(t, x, k-1);
+      div(t, n, t);
+      mul(y, x, k-1);
+      add(y, y, t);
+      div(y, y, k);
+      if (y >= x) break;
+      swap(x, y);
+   }
+
+   r = x;
+}
+
+
+// returns the largest e such that n = r^e, for n > 1 with no prime
+// factors below 2^FACTOR_TRIAL_BITS
+
+static
+long PerfectPower(ZZ& r, const ZZ& n)
+{
+   ZZ m, s, t;
+   m = n;
+   long e = 1;
+
+   PrimeSeq seq;
+   long k = seq.next();
+
+   while (k && k <= NumBits(m)/FACTOR_TRIAL_BITS) {
+      KthRoot(s, m, k);
+      power(t, s, k);
+      if (t == m) {
+         swap(m, s);
+         e *= k;
+      }
+      else
+         k = seq.next();
+   }
+
+   r = m;
+   return e;
+}
+
+
+static
+bool FactorLess(const pair_ZZ_long& x, const pair_ZZ_long& y)
+{
+   return x.a < y.a;
+}
+
+
+void factor(vec_pair_ZZ_long& factors, const ZZ& n, long verbose)
+{
+   if (IsZero(n)) LogicError("factor: n = 0");
+
+   vec_pair_ZZ_long res;
+   ZZ m, d, q, r;
+
+   abs(m, n);
+
+   PrimeSeq s;
+   for (long p = s.next(); p && NumBits(p) <= FACTOR_TRIAL_BITS && !IsOne(m);
+        p = s.next()) {
+      long e = 0;
+      while (divide(m, m, p)) e++;
+      if (e) append(res, cons(conv<ZZ>(p), e));
+   }
+
+   // pairs (c, e) with c^e dividing the remaining cofactor
+
+   vec_pair_ZZ_long stack;
+   if (!IsOne(m)) append(stack, cons(m, 1L));
+
+   long level = 0;
+
+   while (stack.length() > 0) {
+      pair_ZZ_long c = stack[stack.length()-1];
+      stack.SetLength(stack.length()-1);
+
+      if (ProbPrime(c.a)) {
+         if (verbose) cerr << "prime factor " << c.a << "\n";
+         append(res, c);
+         continue;
+      }
+
+      long k = PerfectPower(r, c.a);
+      if (k > 1) {
+         append(stack, cons(r, c.b*k));
+         continue;
+      }
+
+      if (verbose)
+         cerr << "factoring " << NumBits(c.a) << "-bit cofactor\n";
+
+      if (PollardRho(d, c.a, FACTOR_RHO_ITERS)) {
+         if (verbose) cerr << "rho: factor " << d << "\n";
+      }
+      else {
+         for (;;) {
+            long B1 = FactorECMLevels[level][0];
+            long curves = FactorECMLevels[level][1];
+            long B2 = (B1 <= NTL_MAX_LONG/100) ? 100*B1 : NTL_MAX_LONG;
+
+            if (verbose)
+               cerr << "ECM: B1 = " << B1 << ", " << curves << " curves\n";
+
+            if (ECM(d, c.a, B1, B2, curves, verbose)) break;
+
+            if (level == FACTOR_ECM_NLEVELS-1)
+               ResourceError("factor: no factor found by ECM");
+
+            level++;
+         }
+      }
+
+      div(q, c.a, d);
+      append(stack, cons(d, c.b));
+      append(stack, cons(q, c.b));
+   }
+
+   std::sort(res.elts(), res.elts() + res.length(), FactorLess);
+
+   factors.SetLength(0);
+   for (long i = 0; i < res.length(); i++) {
+      long l = factors.length();
+      if (l > 0 && factors[l-1].a == res[i].a)
+         factors[l-1].b += res[i].b;
+      else
+         append(factors, res[i]);
+   }
+}
+
+
+NTL_END_IMPL
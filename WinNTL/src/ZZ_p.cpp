@@ -172,6 +172,21 @@ void ZZ_p::DoInstall()
 
 
 
+void ZZ_p::BuildReducer()
+{
+   do { // NOTE: thread safe lazy init
+      Lazy<ZZReducer>::Builder builder(ZZ_pInfo->Reducer);
+      if (!builder()) break;
+
+      UniquePtr<ZZReducer> red;
+      red.make();
+      red->init(ZZ_pInfo->p);
+
+      builder.move(red);
+   } while (0);
+}
+
+
 void ZZ_p::init(const ZZ& p)
 {
    ZZ_pContext c(p);
@@ -355,4 +370,16 @@ void div(ZZ_p& x, long a, const ZZ_p& b)
    }
 }
 
+
+void VectorRandom(long k, ZZ_p* x)
+{
+   if (k <= 0) return;
+
+   Vec<ZZ*> xp;
+   xp.SetLength(k);
+   for (long i = 0; i < k; i++) xp[i] = &x[i].LoopHole();
+
+   VectorRandomBnd(k, xp.elts(), ZZ_p::modulus());
+}
+
 NTL_END_IMPL
@@ -0,0 +1,212 @@
+
+#include <NTL/ZZ_pMont.h>
+
+
+NTL_START_IMPL
+
+
+ZZ rep(const ZZ_pMont& a)
+{
+   ZZ x;
+   ZZ_pMont::reducer().FromMont(x, a._ZZ_pMont__rep);
+   NTL_OPT_RETURN(ZZ, x);
+}
+
+void conv(ZZ_pMont& x, const ZZ& a)
+{
+   // ToMont reduces a mod p first
+   ZZ_pMont::reducer().ToMont(x._ZZ_pMont__rep, a);
+}
+
+void conv(ZZ_pMont& x, long a)
+{
+   if (a == 0)
+      clear(x);
+   else {
+      NTL_ZZRegister(y);
+
+      conv(y, a);
+      conv(x, y);
+   }
+}
+
+void set(ZZ_pMont& x)
+{
+   conv(x, 1);
+}
+
+long IsOne(const ZZ_pMont& a)
+{
+   NTL_ZZRegister(t);
+   ZZ_pMont::reducer().FromMont(t, a._ZZ_pMont__rep);
+   return IsOne(t);
+}
+
+void mul(ZZ_pMont& x, const ZZ_pMont& a, long b)
+{
+   // (a*R)*b = (a*b)*R, so b is used in the usual representation
+   NTL_ZZRegister(t);
+
+   conv(t, b);
+   if (b < 0 || t >= ZZ_p::modulus()) rem(t, t, ZZ_p::modulus());
+   MulMod(x._ZZ_pMont__rep, a._ZZ_pMont__rep, t, ZZ_p::modulus());
+}
+
+void inv(ZZ_pMont& x, const ZZ_pMont& a)
+{
+   const ZZReducer& red = ZZ_pMont::reducer();
+   NTL_ZZRegister(t);
+   NTL_ZZRegister(T);
+
+   red.FromMont(t, a._ZZ_pMont__rep);
+
+   if (InvModStatus(T, t, ZZ_p::modulus())) {
+      if (!IsZero(t) && ZZ_p::DivHandler) {
+         ZZ_p aa;
+         aa.LoopHole() = t;
+         (*ZZ_p::DivHandler)(aa);
+      }
+
+      InvModError("ZZ_pMont: division by non-invertible element",
+                   t, ZZ_p::modulus());
+   }
+
+   red.ToMont(x._ZZ_pMont__rep, T);
+}
+
+void div(ZZ_pMont& x, const ZZ_pMont& a, const ZZ_pMont& b)
+{
+   ZZ_pMont T;
+
+   inv(T, b);
+   mul(x, a, T);
+}
+
+void power(ZZ_pMont& x, const ZZ_pMont& a, const ZZ& e)
+{
+   const ZZReducer& red = ZZ_pMont::reducer();
+
+   if (IsZero(e)) {
+      set(x);
+      return;
+   }
+
+   ZZ_pMont base;
+   if (sign(e) < 0)
+      inv(base, a);
+   else
+      base = a;
+
+   // left-to-right binary exponentiation, all in Montgomery form
+
+   ZZ_pMont res(base);
+   long k = NumBits(e);
+
+   for (long i = k-2; i >= 0; i--) {
+      red.SqrMont(res._ZZ_pMont__rep, res._ZZ_pMont__rep);
+      if (bit(e, i))
+         red.MulMont(res._ZZ_pMont__rep, res._ZZ_pMont__rep,
+                     base._ZZ_pMont__rep);
+   }
+
+   x = res;
+}
+
+void power(ZZ_pMont& x, const ZZ_pMont& a, long e)
+{
+   NTL_ZZRegister(E);
+   conv(E, e);
+   power(x, a, E);
+}
+
+ostream& operator<<(ostream& s, const ZZ_pMont& a)
+{
+   return s << rep(a);
+}
+
+istream& operator>>(istream& s, ZZ_pMont& x)
+{
+   NTL_ZZRegister(y);
+
+   NTL_INPUT_CHECK_RET(s, s >> y);
+   conv(x, y);
+
+   return s;
+}
+
+
+void conv(vec_ZZ_pMont& x, const vec_ZZ_p& a)
+{
+   const ZZReducer& red = ZZ_pMont::reducer();
+   long n = a.length();
+   x.SetLength(n);
+   for (long i = 0; i < n; i++)
+      red.ToMont(x[i]._ZZ_pMont__rep, rep(a[i]));
+}
+
+void conv(vec_ZZ_p& x, const vec_ZZ_pMont& a)
+{
+   const ZZReducer& red = ZZ_pMont::reducer();
+   long n = a.length();
+   x.SetLength(n);
+   for (long i = 0; i < n; i++)
+      red.FromMont(x[i].LoopHole(), a[i]._ZZ_pMont__rep);
+}
+
+void add(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b)
+{
+   long n = a.length();
+   if (b.length() != n) LogicError("vector add: dimension mismatch");
+
+   x.SetLength(n);
+   for (long i = 0; i < n; i++)
+      add(x[i], a[i], b[i]);
+}
+
+void sub(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b)
+{
+   long n = a.length();
+   if (b.length() != n) LogicError("vector sub: dimension mismatch");
+
+   x.SetLength(n);
+   for (long i = 0; i < n; i++)
+      sub(x[i], a[i], b[i]);
+}
+
+void mul(vec_ZZ_pMont& x, const vec_ZZ_pMont& a, const ZZ_pMont& b_in)
+{
+   ZZ_pMont b = b_in;
+   long n = a.length();
+   x.SetLength(n);
+   for (long i = 0; i < n; i++)
+      mul(x[i], a[i], b);
+}
+
+void InnerProduct(ZZ_pMont& x, const vec_ZZ_pMont& a, const vec_ZZ_pMont& b)
+{
+   const ZZReducer& red = ZZ_pMont::reducer();
+   const ZZ& p = ZZ_p::modulus();
+
+   // the sum of the (aR)*(bR) is (sum a*b)*R^2, and one reduction
+   // gives (sum a*b)*R, provided the sum is below p*R;
+   // as p >= 2^(NumBits(p)-1), this holds if the sum has at most
+   // maxbits bits, and otherwise the sum is first reduced mod p
+
+   long maxbits = NumBits(p) - 1 + ZZ_p::ModulusSize()*NTL_ZZ_NBITS;
+
+   long n = min(a.length(), b.length());
+   NTL_ZZRegister(accum);
+   NTL_ZZRegister(t);
+
+   clear(accum);
+   for (long i = 0; i < n; i++) {
+      mul(t, a[i]._ZZ_pMont__rep, b[i]._ZZ_pMont__rep);
+      add(accum, accum, t);
+   }
+
+   if (NumBits(accum) > maxbits) red.rem(accum, accum);
+   red.FromMont(x._ZZ_pMont__rep, accum);
+}
+
+
+NTL_END_IMPL
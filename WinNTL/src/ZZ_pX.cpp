@@ -1318,13 +1318,8 @@ void MulByXMod(ZZ_pX& h, const ZZ_pX& a, const ZZ_pX& f)
 
 void random(ZZ_pX& x, long n)
 {
-   long i;
-
    x.rep.SetLength(n);
-
-   for (i = 0; i < n; i++)
-      random(x.rep[i]); 
-
+   VectorRandom(n, x.rep.elts());
    x.normalize();
 }
 
@@ -813,8 +813,75 @@ void eval(ZZ_p& b, const ZZ_pX& f, const ZZ_p& a)
 
 
 
+// Multipoint evaluation with a subproduct tree:  the points are
+// split into blocks of EVAL_LEAF, the leaves of the tree are the
+// products of X - a[i] over the blocks, and each node is the product
+// of its children.  f is reduced modulo the root, and the remainders
+// are reduced down the tree, after which each point is evaluated by
+// Horner in the remainder for its block.  All the divisors are monic,
+// so this also works if p is not prime.
+
+#define EVAL_LEAF (16)
+
+static
+void TreeEval(vec_ZZ_p& b, const ZZ_pX& f, const vec_ZZ_p& a)
+{
+   long m = a.length();
+   long nleaves = (m + EVAL_LEAF - 1)/EVAL_LEAF;
+   long i, j;
+
+   Vec< Vec<ZZ_pX> > tree;
+   tree.SetLength(1);
+   tree[0].SetLength(nleaves);
+
+   vec_ZZ_p blk;
+   for (j = 0; j < nleaves; j++) {
+      long lo = j*EVAL_LEAF, hi = min(m, lo+EVAL_LEAF);
+      blk.SetLength(hi-lo);
+      for (i = lo; i < hi; i++) blk[i-lo] = a[i];
+      BuildFromRoots(tree[0][j], blk);
+   }
+
+   while (tree[tree.length()-1].length() > 1) {
+      long k = tree.length();
+      tree.SetLength(k+1);
+      const Vec<ZZ_pX>& lo = tree[k-1];
+      Vec<ZZ_pX>& hi = tree[k];
+      long len = lo.length();
+
+      hi.SetLength((len+1)/2);
+      for (j = 0; j < len/2; j++)
+         mul(hi[j], lo[2*j], lo[2*j+1]);
+      if (len & 1) hi[len/2] = lo[len-1];
+   }
+
+   long top = tree.length()-1;
+   Vec<ZZ_pX> r, r1;
+   r.SetLength(1);
+   rem(r[0], f, tree[top][0]);
+
+   for (long lev = top-1; lev >= 0; lev--) {
+      long len = tree[lev].length();
+      r1.SetLength(len);
+      for (j = 0; j < len; j++)
+         rem(r1[j], r[j/2], tree[lev][j]);
+      swap(r, r1);
+   }
+
+   // b may alias a, but a[i] is only needed for b[i]
+
+   b.SetLength(m);
+   for (j = 0; j < nleaves; j++) {
+      long lo = j*EVAL_LEAF, hi = min(m, lo+EVAL_LEAF);
+      for (i = lo; i < hi; i++)
+         eval(b[i], r[j], a[i]);
+   }
+}
+
+
 void eval(vec_ZZ_p& b, const ZZ_pX& f, const vec_ZZ_p& a)
-// naive algorithm:  repeats Horner
+// repeats Horner, or uses a subproduct tree for many points
+// and a polynomial of large degree
 {
    if (&b == &f.rep) {
       vec_ZZ_p bb;
@@ -824,6 +891,12 @@ void eval(vec_ZZ_p& b, const ZZ_pX& f, const vec_ZZ_p& a)
    }
 
    long m = a.length();
+
+   if (m >= NTL_ZZ_pX_EVAL_CROSSOVER && deg(f) >= NTL_ZZ_pX_EVAL_CROSSOVER) {
+      TreeEval(b, f, a);
+      return;
+   }
+
    b.SetLength(m);
    long i;
    for (i = 0; i < m; i++) 
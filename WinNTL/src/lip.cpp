@@ -32,6 +32,8 @@
 #include <NTL/SmartPtr.h>
 
 #include <NTL/sp_arith.h>
+#include <NTL/FFT.h>
+#include <NTL/FFT_impl.h>
 
 
 #ifdef NTL_GMP_LIP
@@ -507,9 +509,620 @@ _ntl_addmulsq(long n, _ntl_limb_t *a, const _ntl_limb_t *b)
 }
 
 
+
+/**********************************************************************
+
+   SIMD basecase kernels
+
+   On x86-64, the schoolbook multiplication and squaring and the
+   mul_1/addmul_1/submul_1 row operations have vectorized versions,
+   selected at run time by CPUID:
+
+   * AVX-512 IFMA:  vpmadd52luq/vpmadd52huq multiply 52-bit inputs.
+     If b is pre-shifted to b*2^(52-NBITS), the low half of a*b is
+     (a*b mod 2^NBITS)*2^(52-NBITS) and the high half is
+     floor(a*b/2^NBITS), which is exactly our limb split.
+
+   * AVX2:  vpmuludq gives four exact 32x32-bit products.  With 30-bit
+     limbs, these are the limb products themselves; with 50-bit limbs,
+     the limbs are split into 25-bit halves.
+
+   The nail bits leave enough room to add up a whole column of
+   products in a vector lane, so the basecase kernels compute the
+   columns of the product independently (product scanning), and then
+   do one carry pass.  The row kernels resolve carries in the vector
+   registers one limb at a time, with a scalar fix-up pass in the
+   (very rare) case that a carry ripples further.
+
+   There is no AVX2 row kernel for 50-bit limbs: four 32-bit
+   multiplications per limb product are slower than one 64-bit one.
+
+   Defining NTL_AVOID_MPN_SIMD disables all of this, and defining
+   NTL_AVOID_AVX512 disables the IFMA kernels.
+
+   The 30-bit limb versions are only built by MSVC on x64, where long
+   has 32 bits;  they are exercised by the windows job of
+   .github/workflows/build.yml (the IFMA kernel only when the runner
+   supports it), and not by builds on LP64 hosts.
+
+**********************************************************************/
+
+
+#if (!defined(NTL_AVOID_MPN_SIMD) && (defined(__x86_64__) || defined(_M_X64)) \
+     && (defined(__GNUC__) || defined(_MSC_VER)) \
+     && ((NTL_BITS_PER_LIMB_T == 64 && NTL_ZZ_NBITS <= 50 && NTL_ZZ_NBITS % 2 == 0) \
+         || (NTL_BITS_PER_LIMB_T == 32 && NTL_ZZ_NBITS <= 30)))
+#define NTL_MPN_SIMD
+#endif
+
+
+#ifdef NTL_MPN_SIMD
+
+#include <immintrin.h>
+
+#if (defined(_MSC_VER))
+#include <intrin.h>
+#define MPN_TARGET_AVX2
+#define MPN_TARGET_IFMA
+#else
+#include <cpuid.h>
+#define MPN_TARGET_AVX2 __attribute__((target("avx2")))
+#define MPN_TARGET_IFMA __attribute__((target("avx2,avx512f,avx512ifma")))
+#endif
+
+
+#define MPN_SIMD_AVX2 (1)
+#define MPN_SIMD_IFMA (2)
+
+static void
+mpn_cpuid(unsigned int leaf, unsigned int *r)
+{
+#if (defined(_MSC_VER))
+   int regs[4];
+   __cpuidex(regs, leaf, 0);
+   for (long i = 0; i < 4; i++) r[i] = regs[i];
+#else
+   __cpuid_count(leaf, 0, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static unsigned long long
+mpn_xgetbv()
+{
+#if (defined(_MSC_VER))
+   return _xgetbv(0);
+#else
+   unsigned int lo, hi;
+   __asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+   return (((unsigned long long) hi) << 32) | lo;
+#endif
+}
+
+static int
+mpn_simd_detect()
+{
+   unsigned int r[4];
+
+   mpn_cpuid(0, r);
+   if (r[0] < 7) return 0;
+
+   // OSXSAVE and AVX, and the OS must save the ymm state
+   mpn_cpuid(1, r);
+   if (!(r[2] & (1U << 27)) || !(r[2] & (1U << 28))) return 0;
+   unsigned long long xcr0 = mpn_xgetbv();
+   if ((xcr0 & 0x6) != 0x6) return 0;
+
+   mpn_cpuid(7, r);
+   if (!(r[1] & (1U << 5))) return 0;
+
+#ifndef NTL_AVOID_AVX512
+   // AVX512F and AVX512IFMA, and the OS must save the zmm and mask state
+   if ((xcr0 & 0xe6) == 0xe6 && (r[1] & (1U << 16)) && (r[1] & (1U << 21)))
+      return MPN_SIMD_IFMA;
+#endif
+
+   return MPN_SIMD_AVX2;
+}
+
+// this is zero until static initialization has run, which just means
+// that the scalar code is used before then
+static const int mpn_simd_level = mpn_simd_detect();
+
+
+// the basecase kernels handle up to MPN_SIMD_MAXU by MPN_SIMD_MAXV
+// limbs at a time, and are used when the product of the sizes is at
+// least MPN_SIMD_IFMA_AREA or MPN_SIMD_AVX2_AREA; the row kernels are
+// used from MPN_SIMD_ROW_MIN limbs on
+
+#define MPN_SIMD_MAXU (128)
+#define MPN_SIMD_MAXV (64)
+#define MPN_SIMD_IFMA_AREA (36)
+#define MPN_SIMD_AVX2_AREA (100)
+#define MPN_SIMD_ROW_MIN (8)
+
+#if (NTL_BITS_PER_LIMB_T == 64)
+#define MPN_SIMD_ROW_LEVEL MPN_SIMD_IFMA
+#else
+#define MPN_SIMD_ROW_LEVEL MPN_SIMD_AVX2
+#endif
+
+#define MPN_IFMA_SHIFT (52-NTL_ZZ_NBITS)
+
+// The unmasked forms of these intrinsics take an undefined pass-through
+// operand, which GCC reports with -Wmaybe-uninitialized;  with a full
+// mask, the zero-masking forms are the same instructions.
+
+#define MPN_IFMA_SRLI(x, k) _mm512_maskz_srli_epi64(__mmask8(0xff), x, k)
+#define MPN_IFMA_ALIGNR(x, y, k) \
+   _mm512_maskz_alignr_epi64(__mmask8(0xff), x, y, k)
+
+typedef unsigned long long mpn_simd_word;
+
+
+// rp[0..un+vn) = up[0..un) * vp[0..vn),
+// for 1 <= un <= MPN_SIMD_MAXU and 1 <= vn <= MPN_SIMD_MAXV
+
+// The product column k is the sum of u[k-j]*v[j].  A vector holds
+// columns k0..k0+7, and for each j, it accumulates the products of
+// v[j] with u[k0-j..k0-j+7], which are read from a copy of u that is
+// padded with zeros on both sides.
+
+MPN_TARGET_IFMA static void
+mpn_ifma_mul(_ntl_limb_t *rp, const _ntl_limb_t *up, long un,
+             const _ntl_limb_t *vp, long vn)
+{
+   mpn_simd_word P[MPN_SIMD_MAXV + MPN_SIMD_MAXU + 8];
+   mpn_simd_word B[MPN_SIMD_MAXV];
+   mpn_simd_word L[8], H[8];
+
+   long off = vn-1;
+   for (long i = 0; i < off; i++) P[i] = 0;
+   for (long i = 0; i < un; i++) P[off+i] = up[i];
+   for (long i = 0; i < 8; i++) P[off+un+i] = 0;
+   for (long j = 0; j < vn; j++) B[j] = mpn_simd_word(vp[j]) << MPN_IFMA_SHIFT;
+
+   long ncols = un+vn-1;
+   mpn_simd_word carry = 0, hprev = 0;
+
+   for (long k0 = 0; k0 < ncols; k0 += 8) {
+      // two sets of accumulators, to hide the latency of the multiplier
+      __m512i l0 = _mm512_setzero_si512(), h0 = _mm512_setzero_si512();
+      __m512i l1 = _mm512_setzero_si512(), h1 = _mm512_setzero_si512();
+
+      long jlo = max(0L, k0-un+1), jhi = min(vn-1, k0+7);
+      long j = jlo;
+
+      for (; j < jhi; j += 2) {
+         __m512i a0 = _mm512_loadu_si512(P+off+k0-j);
+         __m512i b0 = _mm512_set1_epi64(B[j]);
+         __m512i a1 = _mm512_loadu_si512(P+off+k0-j-1);
+         __m512i b1 = _mm512_set1_epi64(B[j+1]);
+         l0 = _mm512_madd52lo_epu64(l0, a0, b0);
+         h0 = _mm512_madd52hi_epu64(h0, a0, b0);
+         l1 = _mm512_madd52lo_epu64(l1, a1, b1);
+         h1 = _mm512_madd52hi_epu64(h1, a1, b1);
+      }
+
+      if (j == jhi) {
+         __m512i a0 = _mm512_loadu_si512(P+off+k0-j);
+         __m512i b0 = _mm512_set1_epi64(B[j]);
+         l0 = _mm512_madd52lo_epu64(l0, a0, b0);
+         h0 = _mm512_madd52hi_epu64(h0, a0, b0);
+      }
+
+      _mm512_storeu_si512(L, MPN_IFMA_SRLI(_mm512_add_epi64(l0, l1),
+                                           MPN_IFMA_SHIFT));
+      _mm512_storeu_si512(H, _mm512_add_epi64(h0, h1));
+
+      // column k is L[k] + H[k-1], plus the carry
+      long m = min(8L, ncols-k0);
+      for (long l = 0; l < m; l++) {
+         mpn_simd_word x = L[l] + hprev + carry;
+         rp[k0+l] = _ntl_limb_t(x & NTL_LIMB_MASK);
+         carry = x >> NTL_ZZ_NBITS;
+         hprev = H[l];
+      }
+   }
+
+   rp[ncols] = _ntl_limb_t(hprev + carry);
+}
+
+
+#if (NTL_BITS_PER_LIMB_T == 64)
+
+#define MPN_IFMA_LOAD(m, p) _mm512_maskz_loadu_epi64(m, p)
+#define MPN_IFMA_STORE(p, m, x) _mm512_mask_storeu_epi64(p, m, x)
+
+#else
+
+#define MPN_IFMA_LOAD(m, p) \
+   _mm512_maskz_cvtepu32_epi64(m, \
+      _mm512_castsi512_si256(_mm512_maskz_loadu_epi32(__mmask16(m), p)))
+#define MPN_IFMA_STORE(p, m, x) _mm512_mask_cvtepi64_storeu_epi32(p, m, x)
+
+#endif
+
+
+// MODE 0: (return, rp[0..n)) = up[0..n)*vl
+// MODE 1: (return, rp[0..n)) = rp[0..n) + up[0..n)*vl
+// MODE 2: (-return, rp[0..n)) = rp[0..n) - up[0..n)*vl
+
+// In lane i, d = r[i] +/- lo[i] +/- hi[i-1] is less than 2^(NBITS+2)
+// (with a bias of 2^(NBITS+1) for MODE 2), and e = (d mod 2^NBITS)
+// + (d[i-1] >> NBITS) is almost always a limb.  If not, e is stored
+// anyway, and fixed up at the end.
+
+template<long MODE>
+MPN_TARGET_IFMA static _ntl_limb_t
+mpn_ifma_row(_ntl_limb_t *rp, const _ntl_limb_t *up, long n, _ntl_limb_t vl)
+{
+   const __m512i zero = _mm512_setzero_si512();
+   const __m512i mask = _mm512_set1_epi64((long long) NTL_LIMB_MASK);
+   const __m512i nmask = _mm512_set1_epi64(~((long long) NTL_LIMB_MASK));
+   const __m512i bias = _mm512_set1_epi64(2LL << NTL_ZZ_NBITS);
+   const __m512i two = _mm512_set1_epi64(2);
+   const __m512i b = _mm512_set1_epi64((long long) vl << MPN_IFMA_SHIFT);
+
+   __m512i hprev = zero, cprev = zero, hi = zero, d = zero;
+   __mmask8 bad = 0;
+
+   for (long i = 0; i < n; i += 8) {
+      __mmask8 m = (n-i >= 8) ? __mmask8(0xff) : __mmask8((1U << (n-i)) - 1);
+
+      __m512i a = MPN_IFMA_LOAD(m, up+i);
+      __m512i lo = MPN_IFMA_SRLI(_mm512_madd52lo_epu64(zero, a, b),
+                                 MPN_IFMA_SHIFT);
+      hi = _mm512_madd52hi_epu64(zero, a, b);
+      __m512i hsh = MPN_IFMA_ALIGNR(hi, hprev, 7);
+
+      if (MODE == 0)
+         d = _mm512_add_epi64(lo, hsh);
+      else if (MODE == 1)
+         d = _mm512_add_epi64(_mm512_add_epi64(MPN_IFMA_LOAD(m, rp+i), lo), hsh);
+      else
+         d = _mm512_sub_epi64(_mm512_add_epi64(MPN_IFMA_LOAD(m, rp+i), bias),
+                              _mm512_add_epi64(lo, hsh));
+
+      __m512i c = MPN_IFMA_SRLI(d, NTL_ZZ_NBITS);
+      __m512i e = _mm512_add_epi64(_mm512_and_si512(d, mask),
+                                   MPN_IFMA_ALIGNR(c, cprev, 7));
+      if (MODE == 2 && i == 0)
+         e = _mm512_add_epi64(e, _mm512_maskz_mov_epi64(1, two));
+      if (MODE == 2)
+         e = _mm512_sub_epi64(e, two);
+
+      bad |= _mm512_mask_test_epi64_mask(m, e, nmask);
+      MPN_IFMA_STORE(rp+i, m, e);
+
+      hprev = hi;
+      cprev = c;
+   }
+
+   mpn_simd_word H[8], C[8];
+   _mm512_storeu_si512(H, hi);
+   _mm512_storeu_si512(C, MPN_IFMA_SRLI(d, NTL_ZZ_NBITS));
+   long l = (n-1) & 7;
+
+   _ntl_limb_t res;
+   if (MODE == 2)
+      res = _ntl_limb_t(H[l] + 2 - C[l]);
+   else
+      res = _ntl_limb_t(H[l] + C[l]);
+
+   if (bad) {
+      // propagate the carries, which are in -2..2, from each limb to
+      // the next; a (signed) carry is kept biased by 1
+
+      _ntl_limb_t carry = 1;
+      for (long i = 0; i < n; i++) {
+         _ntl_limb_t x = rp[i] + carry + NTL_LIMB_MASK;
+         rp[i] = CLIP(x);
+         carry = x >> NTL_ZZ_NBITS;
+      }
+
+      if (MODE == 2)
+         res -= carry-1;
+      else
+         res += carry-1;
+   }
+
+   return res;
+}
+
+
+#if (NTL_BITS_PER_LIMB_T == 64)
+
+// rp[0..un+vn) = up[0..un) * vp[0..vn), as for mpn_ifma_mul
+
+// With u = u1*2^h + u0 and v = v1*2^h + v0, where h = NBITS/2, a
+// column holds the sums of u0*v0, of u0*v1 + u1*v0 and of u1*v1
+// (which has the weight of the next column).
+
+#define MPN_AVX2_HALF (NTL_ZZ_NBITS/2)
+#define MPN_AVX2_HMASK ((mpn_simd_word(1) << MPN_AVX2_HALF) - 1)
+
+MPN_TARGET_AVX2 static void
+mpn_avx2_mul(_ntl_limb_t *rp, const _ntl_limb_t *up, long un,
+             const _ntl_limb_t *vp, long vn)
+{
+   mpn_simd_word P0[MPN_SIMD_MAXV + MPN_SIMD_MAXU + 4];
+   mpn_simd_word P1[MPN_SIMD_MAXV + MPN_SIMD_MAXU + 4];
+   mpn_simd_word B0[MPN_SIMD_MAXV], B1[MPN_SIMD_MAXV];
+   mpn_simd_word C0[4], C1[4], C2[4];
+
+   long off = vn-1;
+   for (long i = 0; i < off; i++) P0[i] = P1[i] = 0;
+   for (long i = 0; i < un; i++) {
+      P0[off+i] = up[i] & MPN_AVX2_HMASK;
+      P1[off+i] = up[i] >> MPN_AVX2_HALF;
+   }
+   for (long i = 0; i < 4; i++) P0[off+un+i] = P1[off+un+i] = 0;
+   for (long j = 0; j < vn; j++) {
+      B0[j] = vp[j] & MPN_AVX2_HMASK;
+      B1[j] = vp[j] >> MPN_AVX2_HALF;
+   }
+
+   long ncols = un+vn-1;
+   mpn_simd_word carry = 0, prev = 0;
+
+   for (long k0 = 0; k0 < ncols; k0 += 4) {
+      __m256i c0 = _mm256_setzero_si256();
+      __m256i c1 = _mm256_setzero_si256();
+      __m256i c2 = _mm256_setzero_si256();
+
+      long jlo = max(0L, k0-un+1), jhi = min(vn-1, k0+3);
+
+      for (long j = jlo; j <= jhi; j++) {
+         __m256i a0 = _mm256_loadu_si256((const __m256i *) (P0+off+k0-j));
+         __m256i a1 = _mm256_loadu_si256((const __m256i *) (P1+off+k0-j));
+         __m256i b0 = _mm256_set1_epi64x(B0[j]);
+         __m256i b1 = _mm256_set1_epi64x(B1[j]);
+         c0 = _mm256_add_epi64(c0, _mm256_mul_epu32(a0, b0));
+         c1 = _mm256_add_epi64(c1, _mm256_mul_epu32(a0, b1));
+         c1 = _mm256_add_epi64(c1, _mm256_mul_epu32(a1, b0));
+         c2 = _mm256_add_epi64(c2, _mm256_mul_epu32(a1, b1));
+      }
+
+      _mm256_storeu_si256((__m256i *) C0, c0);
+      _mm256_storeu_si256((__m256i *) C1, c1);
+      _mm256_storeu_si256((__m256i *) C2, c2);
+
+      long m = min(4L, ncols-k0);
+      for (long l = 0; l < m; l++) {
+         mpn_simd_word x = C0[l] + ((C1[l] & MPN_AVX2_HMASK) << MPN_AVX2_HALF) 
+                           + prev + carry;
+         rp[k0+l] = CLIP(x);
+         carry = x >> NTL_ZZ_NBITS;
+         prev = (C1[l] >> MPN_AVX2_HALF) + C2[l];
+      }
+   }
+
+   rp[ncols] = _ntl_limb_t(prev + carry);
+}
+
+#else
+
+// rp[0..un+vn) = up[0..un) * vp[0..vn), as for mpn_ifma_mul
+
+// The limb products have at most 60 bits, so 16 of them can be added
+// up before they are split into low and high parts.
+
+MPN_TARGET_AVX2 static void
+mpn_avx2_mul(_ntl_limb_t *rp, const _ntl_limb_t *up, long un,
+             const _ntl_limb_t *vp, long vn)
+{
+   mpn_simd_word P[MPN_SIMD_MAXV + MPN_SIMD_MAXU + 4];
+   mpn_simd_word L[4], H[4];
+
+   long off = vn-1;
+   for (long i = 0; i < off; i++) P[i] = 0;
+   for (long i = 0; i < un; i++) P[off+i] = up[i];
+   for (long i = 0; i < 4; i++) P[off+un+i] = 0;
+
+   const __m256i mask = _mm256_set1_epi64x((long long) NTL_LIMB_MASK);
+
+   long ncols = un+vn-1;
+   mpn_simd_word carry = 0, hprev = 0;
+
+   for (long k0 = 0; k0 < ncols; k0 += 4) {
+      __m256i lo = _mm256_setzero_si256(), hi = _mm256_setzero_si256();
+
+      long jlo = max(0L, k0-un+1), jhi = min(vn-1, k0+3);
+
+      for (long j = jlo; j <= jhi; j += 16) {
+         long jend = min(jhi+1, j+16);
+         __m256i acc = _mm256_setzero_si256();
+
+         for (long jj = j; jj < jend; jj++) {
+            __m256i a = _mm256_loadu_si256((const __m256i *) (P+off+k0-jj));
+            __m256i b = _mm256_set1_epi64x(vp[jj]);
+            acc = _mm256_add_epi64(acc, _mm256_mul_epu32(a, b));
+         }
+
+         lo = _mm256_add_epi64(lo, _mm256_and_si256(acc, mask));
+         hi = _mm256_add_epi64(hi, _mm256_srli_epi64(acc, NTL_ZZ_NBITS));
+      }
+
+      _mm256_storeu_si256((__m256i *) L, lo);
+      _mm256_storeu_si256((__m256i *) H, hi);
+
+      long m = min(4L, ncols-k0);
+      for (long l = 0; l < m; l++) {
+         mpn_simd_word x = L[l] + hprev + carry;
+         rp[k0+l] = _ntl_limb_t(x & NTL_LIMB_MASK);
+         carry = x >> NTL_ZZ_NBITS;
+         hprev = H[l];
+      }
+   }
+
+   rp[ncols] = _ntl_limb_t(hprev + carry);
+}
+
+
+// the row operations, as for mpn_ifma_row, with 4 limbs at a time
+
+MPN_TARGET_AVX2 static inline __m256i
+mpn_avx2_shift_in(__m256i x, __m256i prev)
+// (prev[3], x[0], x[1], x[2])
+{
+   return _mm256_blend_epi32(_mm256_permute4x64_epi64(x, 0x93),
+                             _mm256_permute4x64_epi64(prev, 0x93), 0x03);
+}
+
+template<long MODE>
+MPN_TARGET_AVX2 static _ntl_limb_t
+mpn_avx2_row(_ntl_limb_t *rp, const _ntl_limb_t *up, long n, _ntl_limb_t vl)
+{
+   const __m256i zero = _mm256_setzero_si256();
+   const __m256i mask = _mm256_set1_epi64x((long long) NTL_LIMB_MASK);
+   const __m256i nmask = _mm256_set1_epi64x(~((long long) NTL_LIMB_MASK));
+   const __m256i bias = _mm256_set1_epi64x(2LL << NTL_ZZ_NBITS);
+   const __m256i two = _mm256_set1_epi64x(2);
+   const __m256i b = _mm256_set1_epi64x((long long) vl);
+   const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+   __m256i hprev = zero, cprev = zero, hi = zero, d = zero, bad = zero;
+
+   for (long i = 0; i < n; i += 4) {
+      long k = min(4L, n-i);
+      __m128i m = _mm_setr_epi32(0 < k ? -1 : 0, 1 < k ? -1 : 0, 
+                                 2 < k ? -1 : 0, 3 < k ? -1 : 0);
+
+      __m256i a = _mm256_cvtepu32_epi64(_mm_maskload_epi32((const int *) (up+i), m));
+      __m256i p = _mm256_mul_epu32(a, b);
+      __m256i lo = _mm256_and_si256(p, mask);
+      hi = _mm256_srli_epi64(p, NTL_ZZ_NBITS);
+      __m256i hsh = mpn_avx2_shift_in(hi, hprev);
+
+      if (MODE == 0)
+         d = _mm256_add_epi64(lo, hsh);
+      else {
+         __m256i r = _mm256_cvtepu32_epi64(_mm_maskload_epi32((const int *) (rp+i), m));
+         if (MODE == 1)
+            d = _mm256_add_epi64(_mm256_add_epi64(r, lo), hsh);
+         else
+            d = _mm256_sub_epi64(_mm256_add_epi64(r, bias),
+                                 _mm256_add_epi64(lo, hsh));
+      }
+
+      __m256i c = _mm256_srli_epi64(d, NTL_ZZ_NBITS);
+      __m256i e = _mm256_add_epi64(_mm256_and_si256(d, mask),
+                                   mpn_avx2_shift_in(c, cprev));
+      if (MODE == 2 && i == 0)
+         e = _mm256_add_epi64(e, _mm256_blend_epi32(zero, two, 0x03));
+      if (MODE == 2)
+         e = _mm256_sub_epi64(e, two);
+
+      __m256i m256 = _mm256_cvtepi32_epi64(m);
+      bad = _mm256_or_si256(bad, _mm256_and_si256(_mm256_and_si256(e, nmask), m256));
+      __m128i e32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(e, pack));
+      _mm_maskstore_epi32((int *) (rp+i), m, e32);
+
+      hprev = hi;
+      cprev = c;
+   }
+
+   mpn_simd_word H[4], C[4];
+   _mm256_storeu_si256((__m256i *) H, hi);
+   _mm256_storeu_si256((__m256i *) C, _mm256_srli_epi64(d, NTL_ZZ_NBITS));
+   long l = (n-1) & 3;
+
+   _ntl_limb_t res;
+   if (MODE == 2)
+      res = _ntl_limb_t(H[l] + 2 - C[l]);
+   else
+      res = _ntl_limb_t(H[l] + C[l]);
+
+   if (!_mm256_testz_si256(bad, bad)) {
+      _ntl_limb_t carry = 1;
+      for (long i = 0; i < n; i++) {
+         _ntl_limb_t x = rp[i] + carry + NTL_LIMB_MASK;
+         rp[i] = CLIP(x);
+         carry = x >> NTL_ZZ_NBITS;
+      }
+
+      if (MODE == 2)
+         res -= carry-1;
+      else
+         res += carry-1;
+   }
+
+   return res;
+}
+
+#endif
+
+
+// rp[0..un+vn) = up[0..un) * vp[0..vn), for 1 <= vn <= MPN_SIMD_MAXV;
+// u is done in chunks of MPN_SIMD_MAXU limbs
+
+static void
+mpn_simd_mul(_ntl_limb_t *rp, const _ntl_limb_t *up, long un,
+             const _ntl_limb_t *vp, long vn)
+{
+   void (*kernel)(_ntl_limb_t *, const _ntl_limb_t *, long, 
+                  const _ntl_limb_t *, long);
+
+   if (mpn_simd_level == MPN_SIMD_IFMA)
+      kernel = mpn_ifma_mul;
+   else
+      kernel = mpn_avx2_mul;
+
+   if (un <= MPN_SIMD_MAXU) {
+      kernel(rp, up, un, vp, vn);
+      return;
+   }
+
+   kernel(rp, up, MPN_SIMD_MAXU, vp, vn);
+
+   _ntl_limb_t T[MPN_SIMD_MAXU + MPN_SIMD_MAXV];
+
+   for (long i = MPN_SIMD_MAXU; i < un; i += MPN_SIMD_MAXU) {
+      long len = min(long(MPN_SIMD_MAXU), un-i);
+      kernel(T, up+i, len, vp, vn);
+      for (long k = vn; k < len+vn; k++) rp[i+k] = T[k];
+      _ntl_mpn_add(rp+i, rp+i, len+vn, T, vn);
+   }
+}
+
+
+static inline bool
+mpn_simd_use_mul(long un, long vn)
+{
+   if (!mpn_simd_level || vn > MPN_SIMD_MAXV) return false;
+
+   if (mpn_simd_level == MPN_SIMD_IFMA)
+      return un*vn >= MPN_SIMD_IFMA_AREA;
+   else
+      return un*vn >= MPN_SIMD_AVX2_AREA;
+}
+
+
+template<long MODE>
+static inline _ntl_limb_t
+mpn_simd_row(_ntl_limb_t *rp, const _ntl_limb_t *up, long n, _ntl_limb_t vl)
+{
+#if (NTL_BITS_PER_LIMB_T == 64)
+   return mpn_ifma_row<MODE>(rp, up, n, vl);
+#else
+   if (mpn_simd_level == MPN_SIMD_IFMA)
+      return mpn_ifma_row<MODE>(rp, up, n, vl);
+   else
+      return mpn_avx2_row<MODE>(rp, up, n, vl);
+#endif
+}
+
+#endif
+
+
 _ntl_limb_t
 _ntl_mpn_mul_1 (_ntl_limb_t* rp, const _ntl_limb_t* up, long n, _ntl_limb_t vl) 
 {
+#ifdef NTL_MPN_SIMD
+   if (n >= MPN_SIMD_ROW_MIN && mpn_simd_level >= MPN_SIMD_ROW_LEVEL)
+      return mpn_simd_row<0>(rp, up, n, vl);
+#endif
+
    _ntl_limb_t carry = 0;
    for (long i = 0; i < n; i++) 
       _ntl_mulp(rp[i], up[i], vl, carry);
@@ -520,6 +1133,11 @@ _ntl_mpn_mul_1 (_ntl_limb_t* rp, const _ntl_limb_t* up, long n, _ntl_limb_t vl)
 _ntl_limb_t
 _ntl_mpn_addmul_1 (_ntl_limb_t* rp, const _ntl_limb_t* up, long n, _ntl_limb_t vl)
 {
+#ifdef NTL_MPN_SIMD
+   if (n >= MPN_SIMD_ROW_MIN && mpn_simd_level >= MPN_SIMD_ROW_LEVEL)
+      return mpn_simd_row<1>(rp, up, n, vl);
+#endif
+
    _ntl_limb_t carry = 0;
    for (long i = 0; i < n; i++) 
       _ntl_addmulp(rp[i], up[i], vl, carry);
@@ -531,6 +1149,11 @@ _ntl_mpn_addmul_1 (_ntl_limb_t* rp, const _ntl_limb_t* up, long n, _ntl_limb_t v
 _ntl_limb_t
 _ntl_mpn_submul_1 (_ntl_limb_t* rp, const _ntl_limb_t* up, long n, _ntl_limb_t vl)
 {
+#ifdef NTL_MPN_SIMD
+   if (n >= MPN_SIMD_ROW_MIN && mpn_simd_level >= MPN_SIMD_ROW_LEVEL)
+      return mpn_simd_row<2>(rp, up, n, vl);
+#endif
+
    _ntl_limb_t carry = 0;
    for (long i = 0; i < n; i++) {
       _ntl_submulp(rp[i], up[i], vl, carry);
@@ -590,6 +1213,13 @@ _ntl_mpn_shift_submul_1(_ntl_limb_t* NTL_RESTRICT rp, _ntl_limb_t shift_in, cons
 static inline void
 _ntl_mpn_base_sqr(_ntl_limb_t *c, const _ntl_limb_t *a, long sa)
 {
+#ifdef NTL_MPN_SIMD
+   if (mpn_simd_use_mul(sa, sa)) {
+      mpn_simd_mul(c, a, sa, a, sa);
+      return;
+   }
+#endif
+
    long sc = 2*sa;
 
    for (long i = 0; i < sc; i++) c[i] = 0;
@@ -612,6 +1242,13 @@ _ntl_mpn_base_sqr(_ntl_limb_t *c, const _ntl_limb_t *a, long sa)
 static inline _ntl_limb_t
 _ntl_mpn_base_mul (_ntl_limb_t* rp, const _ntl_limb_t* up, long un, const _ntl_limb_t* vp, long vn)
 {
+#ifdef NTL_MPN_SIMD
+  if (mpn_simd_use_mul(un, vn)) {
+    mpn_simd_mul(rp, up, un, vp, vn);
+    return rp[un+vn-1];
+  }
+#endif
+
   rp[un] = _ntl_mpn_mul_1 (rp, up, un, vp[0]);
 
   while (--vn >= 1)
@@ -717,7 +1354,12 @@ void kar_fix(_ntl_limb_t *c, const _ntl_limb_t *T, long sT, long hsa)
 }
 
 
+#ifdef NTL_MPN_SIMD
+// the vectorized basecase is fast enough to move the crossover up
+#define KARX (mpn_simd_level == MPN_SIMD_IFMA ? 64 : (mpn_simd_level ? 32 : 16))
+#else
 #define KARX (16)
+#endif
 
 static
 void kar_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
@@ -798,89 +1440,814 @@ void kar_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa,
    }
 }
 
-NTL_TLS_GLOBAL_DECL(Vec<_ntl_limb_t>, kmem)
+NTL_TLS_GLOBAL_DECL(Vec<_ntl_limb_t>, kmem)
+
+static
+void kar_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+             const _ntl_limb_t *b, long sb)
+{
+   long n = sa;
+   long sp = 0;
+   do {
+      long hn = (n+1) >> 1;
+      sp += hn * 3 + 7;
+      n = hn+1;
+   } while (n >= KARX);
+
+   NTL_TLS_GLOBAL_ACCESS(kmem);
+   Vec<_ntl_limb_t>::Watcher kmem_watcher(kmem);
+
+   kmem.SetLength(sp);
+   kar_mul(c, a, sa, b, sb, kmem.elts(), sp);
+}
+
+
+#ifdef NTL_MPN_SIMD
+#define KARSX (mpn_simd_level == MPN_SIMD_IFMA ? 64 : 32)
+#else
+#define KARSX (32) 
+#endif
+
+static
+void kar_sq(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+            _ntl_limb_t *stk, long sp)
+{
+   if (sa < KARSX) {
+      /* classic algorithm */
+
+      _ntl_mpn_base_sqr(c, a, sa);
+   }
+   else {
+      long hsa = (sa + 1) >> 1;
+      _ntl_limb_t *T1, *T2;
+
+      sp -= (hsa << 1) + 2;
+      if (sp < 0) TerminalError("internal error: kmem overflow");
+
+      T1 = c;
+      T2 = stk;  stk += (hsa << 1) + 2;
+
+      long sT1 = kar_fold(T1, a, sa, hsa);
+      kar_sq(T2, T1, sT1, stk, sp);
+
+      kar_sq(c + (hsa << 1), a+hsa, sa-hsa, stk, sp);
+      kar_sub(T2, c + (hsa << 1), 2*(sa-hsa));
+
+      kar_sq(c, a, hsa, stk, sp);
+      kar_sub(T2, c, 2*hsa);
+
+      kar_add(c, T2, 2*sT1, hsa);
+   }
+}
+
+
+static
+void kar_sq(_ntl_limb_t *c, const _ntl_limb_t *a, long sa) 
+{
+   long n = sa;
+   long sp = 0;
+   do {
+      long hn = (n+1) >> 1;
+      sp += 2*hn + 5;
+      n = hn+1;
+   } while (n >= KARSX);
+
+   NTL_TLS_GLOBAL_ACCESS(kmem);
+   Vec<_ntl_limb_t>::Watcher kmem_watcher(kmem);
+
+   kmem.SetLength(sp);
+   kar_sq(c, a, sa, kmem.elts(), sp);
+}
+
+
+
+
+
+// Toom-Cook implementation: 3-way and 4-way splitting, used for operands
+// above the Karatsuba range.  Toom-3 evaluates at 0, 1, -1, 2, infinity,
+// and Toom-4 at 0, 1, -1, 2, -2, 3, infinity.  With these points,
+// the interpolation can be organized so that every intermediate
+// quantity is a non-negative combination of the coefficients of the
+// product, so only the values at -1 and -2 need to carry a sign,
+// and all of the arithmetic can be done with the unsigned mpn routines.
+
+#define TOOM3X (160)
+#define TOOM4X (384)
+#define TOOM3SX (192)
+#define TOOM4SX (448)
+
+// crossovers for the small-prime FFT (see fft_mul below)
+#define FFTX (1536)
+#define FFTSX (1024)
+
+// As for Karatsuba, the scratch space for a whole product is allocated
+// once, by the top-level toom_mul, in the thread-local vector tmem.
+// Each level of the recursion takes its temporaries from the front of
+// the space stk of sp limbs it is given, and passes the rest down.
+// toom_space computes how much space a product needs.
+
+// the scratch space of toom3_mul and toom4_mul for pieces of n limbs,
+// not counting that of the recursive calls
+#define TOOM3_SPACE(n) (8*((n)+1) + 4*(2*(n)+2) + 1)
+#define TOOM4_SPACE(n) (12*((n)+1) + 6*(2*(n)+2) + 1)
+
+static
+void toom_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+              const _ntl_limb_t *b, long sb, _ntl_limb_t *stk, long sp);
+
+static inline
+long toom_strip(const _ntl_limb_t *p, long n)
+{
+   while (n > 0 && p[n-1] == 0) n--;
+   return n;
+}
+
+// T = x, where T has n1 limbs and x has len <= n1 limbs
+static inline
+void toom_set(_ntl_limb_t *T, long n1, const _ntl_limb_t *x, long len)
+{
+   for (long i = 0; i < len; i++) T[i] = x[i];
+   for (long i = len; i < n1; i++) T[i] = 0;
+}
+
+// T = T*k + x, where T has n1 limbs and x has len < n1 limbs;
+// the result is assumed to fit in n1 limbs
+static inline
+void toom_horner(_ntl_limb_t *T, long n1, const _ntl_limb_t *x, long len, 
+                 _ntl_limb_t k)
+{
+   if (k & (k-1))
+      _ntl_mpn_mul_1(T, T, n1, k);
+   else if (k > 1)
+      _ntl_mpn_lshift(T, T, n1, COUNT_BITS(k)-1);
+
+   _ntl_mpn_add(T, T, n1, x, len);
+}
+
+// T = |E - O|, returns 1 if E < O, and 0 otherwise;
+// E, O, and T all have n limbs
+static
+long toom_absdiff(_ntl_limb_t *T, const _ntl_limb_t *E, 
+                  const _ntl_limb_t *O, long n)
+{
+   if (_ntl_mpn_cmp(E, O, n) >= 0) {
+      _ntl_mpn_sub_n(T, E, O, n);
+      return 0;
+   }
+   else {
+      _ntl_mpn_sub_n(T, O, E, n);
+      return 1;
+   }
+}
+
+// (E, O) = (v + (-1)^neg*vm, v - (-1)^neg*vm)/2, in place;
+// v and vm have n limbs, tmp has n limbs
+static
+void toom_split(_ntl_limb_t *v, _ntl_limb_t *vm, long neg, long n, 
+                _ntl_limb_t *tmp)
+{
+   _ntl_mpn_add_n(tmp, v, vm, n);
+   if (!neg) {
+      _ntl_mpn_sub_n(vm, v, vm, n);
+      for (long i = 0; i < n; i++) v[i] = tmp[i];
+   }
+   else {
+      _ntl_mpn_sub_n(v, v, vm, n);
+      for (long i = 0; i < n; i++) vm[i] = tmp[i];
+   }
+
+   _ntl_mpn_rshift(v, v, n, 1);
+   _ntl_mpn_rshift(vm, vm, n, 1);
+}
+
+// x = x - k*y, where x has sx limbs and y has sy limbs;
+// the result is assumed to be non-negative; tmp has sy+1 limbs
+static
+void toom_submul(_ntl_limb_t *x, long sx, const _ntl_limb_t *y, long sy, 
+                 _ntl_limb_t k, _ntl_limb_t *tmp)
+{
+   sy = toom_strip(y, sy);
+   if (sy == 0) return;
+
+   if (k == 1) {
+      _ntl_mpn_sub(x, x, sx, y, sy);
+   }
+   else {
+      if ((k & (k-1)) == 0)
+         tmp[sy] = _ntl_mpn_lshift(tmp, y, sy, COUNT_BITS(k)-1);
+      else
+         tmp[sy] = _ntl_mpn_mul_1(tmp, y, sy, k);
+      _ntl_mpn_sub(x, x, sx, tmp, sy+1);
+   }
+}
+
+// x = x/d, where d < 8 is an odd number that is known to divide x.
+// The quotient is computed from the low-order end, using the inverse 
+// of d mod NTL_ZZ_RADIX, which avoids the floating point division 
+// in _ntl_mpn_divmod_1.
+static
+void toom_divexact(_ntl_limb_t *x, long n, _ntl_limb_t d)
+{
+   _ntl_limb_t dinv = d; // correct to 3 bits
+   for (long i = 0; i < 5; i++) dinv = dinv*(2 - d*dinv);
+   dinv = CLIP(dinv);
+
+   _ntl_limb_t c = 0;
+   for (long i = 0; i < n; i++) {
+      _ntl_limb_t l = x[i] - c;
+      _ntl_limb_t borrow = (l >> NTL_ZZ_NBITS) != 0;
+      _ntl_limb_t q = CLIP(CLIP(l)*dinv);
+      x[i] = q;
+      // q*d = CLIP(l) + c*RADIX, with 0 <= c < d; we compute c
+      // without overflowing q*d, even if the nails are small
+      c = (((q >> 3)*d + (((q & 7)*d) >> 3)) >> (NTL_ZZ_NBITS-3)) + borrow;
+   }
+}
+
+// c = c + x*RADIX^k, where c has sc limbs, and x has sx limbs;
+// the result is assumed to fit in sc limbs
+static
+void toom_add(_ntl_limb_t *c, long sc, const _ntl_limb_t *x, long sx, long k)
+{
+   sx = toom_strip(x, sx);
+   if (sx == 0) return;
+   _ntl_mpn_add(c+k, c+k, sc-k, x, sx);
+}
+
+
+// Toom-3 evaluation: a = (a2, a1, a0), where a0 and a1 have n limbs
+// and a2 has s limbs.  Computes a(1), |a(-1)|, and a(2), each with n+1 limbs,
+// returning the sign of a(-1); E and O are scratch space of n+1 limbs.
+static
+long toom3_eval(_ntl_limb_t *as1, _ntl_limb_t *asm1, _ntl_limb_t *as2, 
+                const _ntl_limb_t *a, long n, long s,
+                _ntl_limb_t *E, _ntl_limb_t *O)
+{
+   long n1 = n + 1;
+   const _ntl_limb_t *a0 = a, *a1 = a + n, *a2 = a + 2*n;
+
+   toom_set(E, n1, a2, s);
+   toom_horner(E, n1, a0, n, 1);
+   toom_set(O, n1, a1, n);
+   _ntl_mpn_add_n(as1, E, O, n1);
+   long neg = toom_absdiff(asm1, E, O, n1);
+
+   toom_set(as2, n1, a2, s);
+   toom_horner(as2, n1, a1, n, 2);
+   toom_horner(as2, n1, a0, n, 2);
+
+   return neg;
+}
+
+// Toom-3: assumes n = ceil(sa/3) and 2*n < sb <= sa.
+// If b == a, computes a square.
+
+static
+void toom3_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+               const _ntl_limb_t *b, long sb, _ntl_limb_t *stk, long sp)
+{
+   bool sq = (a == b);
+
+   long n = (sa + 2)/3;
+   long s = sa - 2*n;
+   long t = sb - 2*n;
+   long n1 = n + 1;
+   long L = 2*n + 2;
+
+   sp -= TOOM3_SPACE(n);
+   if (sp < 0) TerminalError("internal error: tmem overflow");
+
+   _ntl_limb_t *as1 = stk;  stk += TOOM3_SPACE(n);
+   _ntl_limb_t *asm1 = as1 + n1;
+   _ntl_limb_t *as2 = asm1 + n1;
+   _ntl_limb_t *bs1 = as2 + n1;
+   _ntl_limb_t *bsm1 = bs1 + n1;
+   _ntl_limb_t *bs2 = bsm1 + n1;
+   _ntl_limb_t *E = bs2 + n1;
+   _ntl_limb_t *O = E + n1;
+   _ntl_limb_t *v1 = O + n1;
+   _ntl_limb_t *vm1 = v1 + L;
+   _ntl_limb_t *v2 = vm1 + L;
+   _ntl_limb_t *tmp = v2 + L;
+
+   // evaluation
+
+   long neg = toom3_eval(as1, asm1, as2, a, n, s, E, O);
+
+   if (sq) {
+      bs1 = as1;  bsm1 = asm1;  bs2 = as2;
+      neg = 0;
+   }
+   else {
+      neg ^= toom3_eval(bs1, bsm1, bs2, b, n, t, E, O);
+   }
+
+   // pointwise products: c0 and c4 go directly into c
+
+   toom_mul(c, a, n, b, n, stk, sp);
+   for (long i = 2*n; i < 4*n; i++) c[i] = 0;
+   toom_mul(c + 4*n, a + 2*n, s, b + 2*n, t, stk, sp);
+   toom_mul(v1, as1, n1, bs1, n1, stk, sp);
+   toom_mul(vm1, asm1, n1, bsm1, n1, stk, sp);
+   toom_mul(v2, as2, n1, bs2, n1, stk, sp);
+
+   const _ntl_limb_t *c0 = c;
+   const _ntl_limb_t *c4 = c + 4*n;
+
+   // interpolation
+
+   toom_split(v1, vm1, neg, L, tmp);
+   // v1 = c0 + c2 + c4, vm1 = c1 + c3
+
+   toom_submul(v1, L, c0, 2*n, 1, tmp);
+   toom_submul(v1, L, c4, s+t, 1, tmp);
+   // v1 = c2
+
+   toom_submul(v2, L, c0, 2*n, 1, tmp);
+   toom_submul(v2, L, v1, L-1, 4, tmp);
+   toom_submul(v2, L, c4, s+t, 16, tmp);
+   _ntl_mpn_rshift(v2, v2, L, 1);
+   // v2 = c1 + 4*c3
+
+   _ntl_mpn_sub_n(v2, v2, vm1, L);
+   toom_divexact(v2, L, 3);
+   // v2 = c3
+
+   _ntl_mpn_sub_n(vm1, vm1, v2, L);
+   // vm1 = c1
+
+   long sc = sa + sb;
+   toom_add(c, sc, vm1, L, n);
+   toom_add(c, sc, v1, L, 2*n);
+   toom_add(c, sc, v2, L, 3*n);
+}
+
+
+// Toom-4 evaluation: a = (a3, a2, a1, a0), where a0, a1, a2 have n limbs
+// and a3 has s limbs.  Computes a(1), |a(-1)|, a(2), |a(-2)|, and a(3), 
+// each with n+1 limbs, along with the signs of a(-1) and a(-2);
+// E and O are scratch space of n+1 limbs.
+static
+void toom4_eval(_ntl_limb_t *as1, _ntl_limb_t *asm1, _ntl_limb_t *as2,
+                _ntl_limb_t *asm2, _ntl_limb_t *as3, long& neg1, long& neg2,
+                const _ntl_limb_t *a, long n, long s,
+                _ntl_limb_t *E, _ntl_limb_t *O)
+{
+   long n1 = n + 1;
+   const _ntl_limb_t *a0 = a, *a1 = a + n, *a2 = a + 2*n, *a3 = a + 3*n;
+
+   toom_set(E, n1, a2, n);
+   toom_horner(E, n1, a0, n, 1);
+   toom_set(O, n1, a3, s);
+   toom_horner(O, n1, a1, n, 1);
+   _ntl_mpn_add_n(as1, E, O, n1);
+   neg1 = toom_absdiff(asm1, E, O, n1);
+
+   toom_set(E, n1, a2, n);
+   toom_horner(E, n1, a0, n, 4);
+   toom_set(O, n1, a3, s);
+   toom_horner(O, n1, a1, n, 4);
+   _ntl_mpn_lshift(O, O, n1, 1);
+   _ntl_mpn_add_n(as2, E, O, n1);
+   neg2 = toom_absdiff(asm2, E, O, n1);
+
+   toom_set(as3, n1, a3, s);
+   toom_horner(as3, n1, a2, n, 3);
+   toom_horner(as3, n1, a1, n, 3);
+   toom_horner(as3, n1, a0, n, 3);
+}
+
+// Toom-4: assumes n = ceil(sa/4) and 3*n < sb <= sa.
+// If b == a, computes a square.
+
+static
+void toom4_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+               const _ntl_limb_t *b, long sb, _ntl_limb_t *stk, long sp)
+{
+   bool sq = (a == b);
+
+   long n = (sa + 3)/4;
+   long s = sa - 3*n;
+   long t = sb - 3*n;
+   long n1 = n + 1;
+   long L = 2*n + 2;
+
+   sp -= TOOM4_SPACE(n);
+   if (sp < 0) TerminalError("internal error: tmem overflow");
+
+   _ntl_limb_t *as1 = stk;  stk += TOOM4_SPACE(n);
+   _ntl_limb_t *asm1 = as1 + n1;
+   _ntl_limb_t *as2 = asm1 + n1;
+   _ntl_limb_t *asm2 = as2 + n1;
+   _ntl_limb_t *as3 = asm2 + n1;
+   _ntl_limb_t *bs1 = as3 + n1;
+   _ntl_limb_t *bsm1 = bs1 + n1;
+   _ntl_limb_t *bs2 = bsm1 + n1;
+   _ntl_limb_t *bsm2 = bs2 + n1;
+   _ntl_limb_t *bs3 = bsm2 + n1;
+   _ntl_limb_t *E = bs3 + n1;
+   _ntl_limb_t *O = E + n1;
+   _ntl_limb_t *v1 = O + n1;
+   _ntl_limb_t *vm1 = v1 + L;
+   _ntl_limb_t *v2 = vm1 + L;
+   _ntl_limb_t *vm2 = v2 + L;
+   _ntl_limb_t *v3 = vm2 + L;
+   _ntl_limb_t *tmp = v3 + L;
+
+   // evaluation
+
+   long neg1, neg2;
+   toom4_eval(as1, asm1, as2, asm2, as3, neg1, neg2, a, n, s, E, O);
+
+   if (sq) {
+      bs1 = as1;  bsm1 = asm1;  bs2 = as2;  bsm2 = asm2;  bs3 = as3;
+      neg1 = neg2 = 0;
+   }
+   else {
+      long bneg1, bneg2;
+      toom4_eval(bs1, bsm1, bs2, bsm2, bs3, bneg1, bneg2, b, n, t, E, O);
+      neg1 ^= bneg1;
+      neg2 ^= bneg2;
+   }
+
+   // pointwise products: c0 and c6 go directly into c
+
+   toom_mul(c, a, n, b, n, stk, sp);
+   for (long i = 2*n; i < 6*n; i++) c[i] = 0;
+   toom_mul(c + 6*n, a + 3*n, s, b + 3*n, t, stk, sp);
+   toom_mul(v1, as1, n1, bs1, n1, stk, sp);
+   toom_mul(vm1, asm1, n1, bsm1, n1, stk, sp);
+   toom_mul(v2, as2, n1, bs2, n1, stk, sp);
+   toom_mul(vm2, asm2, n1, bsm2, n1, stk, sp);
+   toom_mul(v3, as3, n1, bs3, n1, stk, sp);
+
+   const _ntl_limb_t *c0 = c;
+   const _ntl_limb_t *c6 = c + 6*n;
+
+   // interpolation
+
+   toom_split(v1, vm1, neg1, L, tmp);
+   // v1 = c0 + c2 + c4 + c6, vm1 = c1 + c3 + c5
+
+   toom_split(v2, vm2, neg2, L, tmp);
+   _ntl_mpn_rshift(vm2, vm2, L, 1);
+   // v2 = c0 + 4*c2 + 16*c4 + 64*c6, vm2 = c1 + 4*c3 + 16*c5
+
+   toom_submul(v1, L, c0, 2*n, 1, tmp);
+   toom_submul(v1, L, c6, s+t, 1, tmp);
+   // v1 = c2 + c4
+
+   toom_submul(v2, L, c0, 2*n, 1, tmp);
+   toom_submul(v2, L, c6, s+t, 64, tmp);
+   _ntl_mpn_rshift(v2, v2, L, 2);
+   // v2 = c2 + 4*c4
+
+   _ntl_mpn_sub_n(v2, v2, v1, L);
+   toom_divexact(v2, L, 3);
+   // v2 = c4
+
+   _ntl_mpn_sub_n(v1, v1, v2, L);
+   // v1 = c2
+
+   toom_submul(v3, L, c0, 2*n, 1, tmp);
+   toom_submul(v3, L, v1, L-1, 9, tmp);
+   toom_submul(v3, L, v2, L-1, 81, tmp);
+   toom_submul(v3, L, c6, s+t, 729, tmp);
+   toom_divexact(v3, L, 3);
+   // v3 = c1 + 9*c3 + 81*c5
+
+   _ntl_mpn_sub_n(v3, v3, vm2, L);
+   toom_divexact(v3, L, 5);
+   // v3 = c3 + 13*c5
+
+   _ntl_mpn_sub_n(vm2, vm2, vm1, L);
+   toom_divexact(vm2, L, 3);
+   // vm2 = c3 + 5*c5
+
+   _ntl_mpn_sub_n(v3, v3, vm2, L);
+   _ntl_mpn_rshift(v3, v3, L, 3);
+   // v3 = c5
+
+   toom_submul(vm2, L, v3, L-1, 5, tmp);
+   // vm2 = c3
+
+   _ntl_mpn_sub_n(vm1, vm1, vm2, L);
+   _ntl_mpn_sub_n(vm1, vm1, v3, L);
+   // vm1 = c1
+
+   long sc = sa + sb;
+   toom_add(c, sc, vm1, L, n);
+   toom_add(c, sc, v1, L, 2*n);
+   toom_add(c, sc, vm2, L, 3*n);
+   toom_add(c, sc, v2, L, 4*n);
+   toom_add(c, sc, v3, L, 5*n);
+}
+
+
+// FFT multiplication: each limb is viewed as a coefficient of a polynomial,
+// and the polynomials are multiplied modulo several of the FFT primes
+// (using the same tables as ZZ_pX and zz_pX arithmetic).  Enough primes
+// are used so that the coefficients of the product can be recovered
+// exactly by CRT, after which the carries are propagated.
+// Assumes sa, sb >= 1 and sa+sb-1 <= 2^NTL_FFTMaxRoot.
+// If b == a and sb == sa, computes a square.
+
+static
+void fft_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+             const _ntl_limb_t *b, long sb)
+{
+   bool sq = (a == b && sa == sb);
+
+   long len = sa + sb - 1;
+   long k = NextPowerOfTwo(len);
+   long n = 1L << k;
+
+   // the truncated FFT needs admissible sizes
+   long yn = FFTRoundUp(len, k);
+   long xa = FFTRoundUp(sa, k);
+   long xb = FFTRoundUp(sb, k);
+
+   // coefficients of the product are less than len*RADIX^2
+   long bound = 2*NTL_ZZ_NBITS + NumBits(len) + 1;
+   long nprimes = 0;
+   for (long bits = 0; bits < bound; nprimes++) {
+      UseFFTPrime(nprimes);
+      bits += NumBits(GetFFTPrime(nprimes)) - 1;
+   }
+
+   UniqueArray<long> mem;
+   mem.SetLength((nprimes+1)*n);
+   long *B = mem.get() + nprimes*n;
+
+   for (long i = 0; i < nprimes; i++) {
+      const FFTPrimeInfo& info = *FFTTables[i];
+      long q = info.q;
+      mulmod_t qinv = info.qinv;
+      long *A = mem.get() + i*n;
+
+      for (long j = 0; j < sa; j++) 
+         A[j] = sp_CorrectExcess(long(a[j]), q);
+      for (long j = sa; j < xa; j++) A[j] = 0;
+      new_fft(A, A, k, info, yn, xa);
+
+      if (sq) {
+         for (long j = 0; j < yn; j++)
+            A[j] = MulMod(A[j], A[j], q, qinv);
+      }
+      else {
+         for (long j = 0; j < sb; j++) 
+            B[j] = sp_CorrectExcess(long(b[j]), q);
+         for (long j = sb; j < xb; j++) B[j] = 0;
+         new_fft(B, B, k, info, yn, xb);
+
+         for (long j = 0; j < yn; j++)
+            A[j] = MulMod(A[j], B[j], q, qinv);
+      }
+
+      new_ifft(A, A, k, info, yn);
+   }
+
+   // CRT: for each coefficient, we compute the mixed-radix digits
+   // y[0], ..., y[nprimes-1], so that the value is
+   //    y[0] + q[0]*(y[1] + q[1]*(y[2] + ...)),
+   // and then evaluate this (as a number of a few limbs) with Horner.
+   // inv[i][j] = 1/q[j] mod q[i], for j < i.
+
+   UniqueArray<long> prime, inv;
+   UniqueArray<mulmod_t> primeinv;
+   UniqueArray<mulmod_precon_t> invpre;
+   prime.SetLength(nprimes);
+   primeinv.SetLength(nprimes);
+   inv.SetLength(nprimes*nprimes);
+   invpre.SetLength(nprimes*nprimes);
+
+   for (long i = 0; i < nprimes; i++) {
+      prime[i] = GetFFTPrime(i);
+      primeinv[i] = GetFFTPrimeInv(i);
+      for (long j = 0; j < i; j++) {
+         long t = InvMod(prime[j] % prime[i], prime[i]);
+         inv[i*nprimes+j] = t;
+         invpre[i*nprimes+j] = PrepMulModPrecon(t, prime[i], primeinv[i]);
+      }
+   }
+
+   // acc holds the pending carry, which has at most nprimes+2 limbs
+   long sacc = nprimes + 2;
+   UniqueArray<_ntl_limb_t> acc_store, X_store;
+   UniqueArray<long> y_store;
+   acc_store.SetLength(sacc);
+   y_store.SetLength(nprimes);
+   X_store.SetLength(sacc);
+   _ntl_limb_t *acc = acc_store.get();
+   long *y = y_store.get();
+   _ntl_limb_t *X = X_store.get();
+
+   for (long i = 0; i < sacc; i++) acc[i] = 0;
+
+   for (long j = 0; j < sa+sb; j++) {
+      if (j < len) {
+         for (long i = 0; i < nprimes; i++) {
+            long qi = prime[i];
+            long t = mem[i*n+j];
+            for (long l = 0; l < i; l++) {
+               t = SubMod(t, y[l] % qi, qi);
+               t = MulModPrecon(t, inv[i*nprimes+l], qi, invpre[i*nprimes+l]);
+            }
+            y[i] = t;
+         }
+
+         for (long i = 0; i < sacc; i++) X[i] = 0;
+         X[0] = y[nprimes-1];
+         for (long i = nprimes-2; i >= 0; i--) {
+            _ntl_mpn_mul_1(X, X, sacc, prime[i]);
+            _ntl_mpn_add_1(X, X, sacc, y[i]);
+         }
+
+         _ntl_mpn_add_n(acc, acc, X, sacc);
+      }
+
+      c[j] = acc[0];
+      for (long i = 0; i < sacc-1; i++) acc[i] = acc[i+1];
+      acc[sacc-1] = 0;
+   }
+}
+
+
+// general multiplication routine, with no restrictions on sa and sb 
+// (other than sa, sb >= 1). If a == b and sa == sb, computes a square.
+// Unbalanced products that are too lopsided for Toom-3 are 
+// broken up into a sequence of balanced products.
+
+static
+void toom_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+              const _ntl_limb_t *b, long sb, _ntl_limb_t *stk, long sp)
+{
+   if (a == b && sa == sb) {
+      if (sa >= FFTSX && 2*sa-1 <= (1L << NTL_FFTMaxRoot))
+         fft_mul(c, a, sa, a, sa);
+      else if (sa >= TOOM4SX)
+         toom4_mul(c, a, sa, a, sa, stk, sp);
+      else if (sa >= TOOM3SX)
+         toom3_mul(c, a, sa, a, sa, stk, sp);
+      else if (sa >= KARSX)
+         kar_sq(c, a, sa);
+      else
+         _ntl_mpn_base_sqr(c, a, sa);
+
+      return;
+   }
+
+   if (sa < sb) {
+      _ntl_swap(a, b);
+      _ntl_swap(sa, sb);
+   }
+
+   if (sb < TOOM3X) {
+      if (sb >= KARX)
+         kar_mul(c, a, sa, b, sb);
+      else
+         _ntl_mpn_base_mul(c, a, sa, b, sb);
+
+      return;
+   }
+
+   if (sb >= FFTX) {
+      if (sa+sb-1 <= (1L << NTL_FFTMaxRoot)) {
+         fft_mul(c, a, sa, b, sb);
+         return;
+      }
+
+      // too large for a single transform: split a in half
+      long h = sa/2;
+      sp -= sa-h+sb;
+      if (sp < 0) TerminalError("internal error: tmem overflow");
+
+      _ntl_limb_t *T = stk;  stk += sa-h+sb;
+
+      toom_mul(c, a, h, b, sb, stk, sp);
+      for (long i = h+sb; i < sa+sb; i++) c[i] = 0;
+      toom_mul(T, a+h, sa-h, b, sb, stk, sp);
+      _ntl_mpn_add(c+h, c+h, sa+sb-h, T, sa-h+sb);
+      return;
+   }
+
+   if (sb >= TOOM4X && sb > 3*((sa+3)/4)) {
+      toom4_mul(c, a, sa, b, sb, stk, sp);
+      return;
+   }
+
+   if (sb > 2*((sa+2)/3)) {
+      toom3_mul(c, a, sa, b, sb, stk, sp);
+      return;
+   }
+
+   // unbalanced case: process a in chunks of sb limbs
 
-static
-void kar_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
-             const _ntl_limb_t *b, long sb)
-{
-   long n = sa;
-   long sp = 0;
-   do {
-      long hn = (n+1) >> 1;
-      sp += hn * 3 + 7;
-      n = hn+1;
-   } while (n >= KARX);
+   sp -= 2*sb;
+   if (sp < 0) TerminalError("internal error: tmem overflow");
 
-   NTL_TLS_GLOBAL_ACCESS(kmem);
-   Vec<_ntl_limb_t>::Watcher kmem_watcher(kmem);
+   _ntl_limb_t *T = stk;  stk += 2*sb;
 
-   kmem.SetLength(sp);
-   kar_mul(c, a, sa, b, sb, kmem.elts(), sp);
+   toom_mul(c, a, sb, b, sb, stk, sp);
+   for (long i = 2*sb; i < sa+sb; i++) c[i] = 0;
+
+   for (long i = sb; i < sa; i += sb) {
+      long len = min(sb, sa-i);
+      toom_mul(T, a+i, len, b, sb, stk, sp);
+      _ntl_mpn_add(c+i, c+i, sa+sb-i, T, len+sb);
+   }
 }
 
 
-#define KARSX (32) 
+// the scratch space used by toom_mul(c, a, sa, b, sb, stk, sp), where
+// same says if a == b;  this follows the case analysis of toom_mul
 
 static
-void kar_sq(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
-            _ntl_limb_t *stk, long sp)
+long toom_space(long sa, long sb, bool same)
 {
-   if (sa < KARSX) {
-      /* classic algorithm */
+   long n, s, t, sp;
 
-      _ntl_mpn_base_sqr(c, a, sa);
+   if (same && sa == sb) {
+      if (sa >= FFTSX && 2*sa-1 <= (1L << NTL_FFTMaxRoot))
+         return 0;
+      else if (sa >= TOOM4SX) {
+         n = (sa + 3)/4;
+         s = sa - 3*n;
+         sp = max(toom_space(n, n, true), toom_space(s, s, true));
+         sp = max(sp, toom_space(n+1, n+1, true));
+         return TOOM4_SPACE(n) + sp;
+      }
+      else if (sa >= TOOM3SX) {
+         n = (sa + 2)/3;
+         s = sa - 2*n;
+         sp = max(toom_space(n, n, true), toom_space(s, s, true));
+         sp = max(sp, toom_space(n+1, n+1, true));
+         return TOOM3_SPACE(n) + sp;
+      }
+      else
+         return 0;
    }
-   else {
-      long hsa = (sa + 1) >> 1;
-      _ntl_limb_t *T1, *T2;
 
-      sp -= (hsa << 1) + 2;
-      if (sp < 0) TerminalError("internal error: kmem overflow");
+   if (sa < sb) _ntl_swap(sa, sb);
 
-      T1 = c;
-      T2 = stk;  stk += (hsa << 1) + 2;
+   if (sb < TOOM3X) return 0;
 
-      long sT1 = kar_fold(T1, a, sa, hsa);
-      kar_sq(T2, T1, sT1, stk, sp);
+   if (sb >= FFTX) {
+      if (sa+sb-1 <= (1L << NTL_FFTMaxRoot)) return 0;
 
-      kar_sq(c + (hsa << 1), a+hsa, sa-hsa, stk, sp);
-      kar_sub(T2, c + (hsa << 1), 2*(sa-hsa));
+      long h = sa/2;
+      sp = max(toom_space(h, sb, same), toom_space(sa-h, sb, false));
+      return sa-h+sb + sp;
+   }
 
-      kar_sq(c, a, hsa, stk, sp);
-      kar_sub(T2, c, 2*hsa);
+   if (sb >= TOOM4X && sb > 3*((sa+3)/4)) {
+      n = (sa + 3)/4;
+      s = sa - 3*n;
+      t = sb - 3*n;
+      sp = max(toom_space(n, n, same), toom_space(s, t, same));
+      sp = max(sp, toom_space(n+1, n+1, same));
+      return TOOM4_SPACE(n) + sp;
+   }
 
-      kar_add(c, T2, 2*sT1, hsa);
+   if (sb > 2*((sa+2)/3)) {
+      n = (sa + 2)/3;
+      s = sa - 2*n;
+      t = sb - 2*n;
+      sp = max(toom_space(n, n, same), toom_space(s, t, same));
+      sp = max(sp, toom_space(n+1, n+1, same));
+      return TOOM3_SPACE(n) + sp;
    }
+
+   sp = max(toom_space(sb, sb, same), toom_space(sb, sb, false));
+   if (sa % sb) sp = max(sp, toom_space(sa % sb, sb, false));
+   return 2*sb + sp;
 }
 
+NTL_TLS_GLOBAL_DECL(Vec<_ntl_limb_t>, tmem)
 
 static
-void kar_sq(_ntl_limb_t *c, const _ntl_limb_t *a, long sa) 
+void toom_mul(_ntl_limb_t *c, const _ntl_limb_t *a, long sa, 
+              const _ntl_limb_t *b, long sb)
 {
-   long n = sa;
-   long sp = 0;
-   do {
-      long hn = (n+1) >> 1;
-      sp += 2*hn + 5;
-      n = hn+1;
-   } while (n >= KARSX);
+   long sp = toom_space(sa, sb, a == b);
 
-   NTL_TLS_GLOBAL_ACCESS(kmem);
-   Vec<_ntl_limb_t>::Watcher kmem_watcher(kmem);
+   NTL_TLS_GLOBAL_ACCESS(tmem);
+   Vec<_ntl_limb_t>::Watcher tmem_watcher(tmem);
 
-   kmem.SetLength(sp);
-   kar_sq(c, a, sa, kmem.elts(), sp);
+   tmem.SetLength(sp);
+   toom_mul(c, a, sa, b, sb, tmem.elts(), sp);
 }
 
 
 
-
-
-
 void
 _ntl_mpn_sqr(_ntl_limb_t *c, const _ntl_limb_t *a, long sa)
 {
+  if (sa >= TOOM3SX) {
+    toom_mul(c, a, sa, a, sa);
+    return;
+  }
+
   if (sa >= KARSX) {
     kar_sq(c, a, sa);
     return;
@@ -899,6 +2266,11 @@ _ntl_mpn_mul (_ntl_limb_t* rp, const _ntl_limb_t* up, long un, const _ntl_limb_t
     return rp[2*un-1];
   }
 
+  if (vn >= TOOM3X) {
+    toom_mul(rp, up, un, vp, vn);
+    return rp[un+vn-1];
+  }
+
   if (vn >= KARX) {
     kar_mul(rp, up, un, vp, vn);
     return rp[un+vn-1];
@@ -1001,6 +2373,295 @@ _ntl_mpn_mod_1 (const _ntl_limb_t *a, long sa, _ntl_limb_t d)
    return carry;
 }
 
+/*
+ * Subquadratic division.
+ *
+ * For large operands, _ntl_mpn_tdiv_qr normalizes the divisor and
+ * then uses a recursive divide-and-conquer strategy (as in Burnikel and
+ * Ziegler, "Fast Recursive Division", and GMP's mpn_dcpi1_div_qr), so
+ * that division costs a small multiple of multiplication.
+ * For very large divisors and much larger dividends, the main loop 
+ * instead uses a reciprocal of the divisor computed by Newton iteration,
+ * so that each block of the quotient costs just two multiplications
+ * (computing the reciprocal only pays off if there are several blocks).
+ *
+ * All of the routines below assume the divisor dp is normalized,
+ * i.e., the top bit of dp[dn-1] is set, and they leave the
+ * remainder in the low-order limbs of the numerator np.
+ */
+
+#define DIV_DCX (32)
+#define DIV_NEWTONX (2048)
+
+
+// Schoolbook division of (np, nn) by (dp, dn), with nn >= dn.
+// The low-order nn-dn limbs of the quotient are stored in q, and the
+// high-order limb (0 or 1) is returned.
+static _ntl_limb_t
+div_sb_qr(_ntl_limb_t *q, _ntl_limb_t *np, long nn, 
+          const _ntl_limb_t *dp, long dn)
+{
+   _ntl_limb_t qh = (_ntl_mpn_cmp(np+nn-dn, dp, dn) >= 0);
+   if (qh) _ntl_mpn_sub_n(np+nn-dn, np+nn-dn, dp, dn);
+
+   _ntl_limb_t d1 = dp[dn-1];
+   double d1_inv = 1.0/DBL(d1);
+
+   for (long i = nn-dn-1; i >= 0; i--) {
+      // since d1 is normalized, the estimate may be too large by at most 2
+      _ntl_limb_t n1 = np[i+dn];
+      _ntl_limb_t qdigit;
+      if (n1 >= d1)
+         qdigit = NTL_ZZ_RADIX-1;
+      else
+         qdigit = _ntl_quo21p(n1, np[i+dn-1], d1, d1_inv);
+
+      _ntl_limb_t carry = n1 - _ntl_mpn_submul_1(np+i, dp, dn, qdigit);
+      while (carry) {
+         carry += _ntl_mpn_add_n(np+i, np+i, dp, dn);
+         qdigit--;
+      }
+
+      np[i+dn] = 0;
+      q[i] = qdigit;
+   }
+
+   return qh;
+}
+
+
+// Divides (np, 2*n) by (dp, n).  The low-order n limbs of the quotient
+// are stored in q, and the high-order limb (0 or 1) is returned.
+// tp is scratch space of n limbs.
+static _ntl_limb_t
+div_dc_qr_n(_ntl_limb_t *q, _ntl_limb_t *np, const _ntl_limb_t *dp, long n,
+            _ntl_limb_t *tp)
+{
+   if (n < DIV_DCX) return div_sb_qr(q, np, 2*n, dp, n);
+
+   long lo = n/2;
+   long hi = n - lo;
+   _ntl_limb_t qh, ql, cy;
+
+   // high half of the quotient, using the high half of the divisor,
+   // followed by a correction for the low half of the divisor
+
+   qh = div_dc_qr_n(q+lo, np+2*lo, dp+lo, hi, tp);
+
+   _ntl_mpn_mul(tp, q+lo, hi, dp, lo);
+   cy = _ntl_mpn_sub_n(np+lo, np+lo, tp, n);
+   if (qh) cy += _ntl_mpn_sub_n(np+n, np+n, dp, lo);
+
+   while (cy) {
+      qh -= _ntl_mpn_sub_1(q+lo, q+lo, hi, 1);
+      cy -= _ntl_mpn_add_n(np+lo, np+lo, dp, n);
+   }
+
+   // same for the low half of the quotient
+
+   ql = div_dc_qr_n(q, np+hi, dp+hi, lo, tp);
+
+   _ntl_mpn_mul(tp, dp, hi, q, lo);
+   cy = _ntl_mpn_sub_n(np, np, tp, n);
+   if (ql) cy += _ntl_mpn_sub_n(np+lo, np+lo, dp, hi);
+
+   while (cy) {
+      _ntl_mpn_sub_1(q, q, lo, 1);
+      cy -= _ntl_mpn_add_n(np, np, dp, n);
+   }
+
+   return qh;
+}
+
+
+// Divides (np, dn+qn) by (dp, dn), where qn <= dn.  The low-order qn 
+// limbs of the quotient are stored in q, and the high-order limb 
+// (0 or 1) is returned.  The quotient is first computed using just
+// the high-order qn limbs of the divisor, and then corrected.
+// tp is scratch space of dn limbs.
+static _ntl_limb_t
+div_dc_qr_short(_ntl_limb_t *q, _ntl_limb_t *np, long qn, 
+                const _ntl_limb_t *dp, long dn, _ntl_limb_t *tp)
+{
+   if (qn == dn) return div_dc_qr_n(q, np, dp, dn, tp);
+   if (qn < DIV_DCX) return div_sb_qr(q, np, dn+qn, dp, dn);
+
+   long s = dn - qn;
+   _ntl_limb_t qh, cy;
+
+   qh = div_dc_qr_n(q, np+s, dp+s, qn, tp);
+
+   if (qn >= s)
+      _ntl_mpn_mul(tp, q, qn, dp, s);
+   else
+      _ntl_mpn_mul(tp, dp, s, q, qn);
+
+   cy = _ntl_mpn_sub_n(np, np, tp, dn);
+   if (qh) cy += _ntl_mpn_sub_n(np+qn, np+qn, dp, s);
+
+   while (cy) {
+      qh -= _ntl_mpn_sub_1(q, q, qn, 1);
+      cy -= _ntl_mpn_add_n(np, np, dp, dn);
+   }
+
+   return qh;
+}
+
+
+// Computes I (n limbs), such that RADIX^n + I = floor((RADIX^{2n}-1)/D),
+// where D = (dp, n).  For large n, this uses Newton iteration, starting 
+// from the reciprocal of the high-order half of D.  The result of the
+// Newton step is within a few units of the correct value, and is
+// corrected by multiplying back.
+static void
+div_invert(_ntl_limb_t *I, const _ntl_limb_t *dp, long n)
+{
+   if (n < DIV_NEWTONX) {
+      UniqueArray<_ntl_limb_t> mem;
+      mem.SetLength(3*n);
+      _ntl_limb_t *np = mem.get();
+      _ntl_limb_t *tp = np + 2*n;
+
+      for (long i = 0; i < 2*n; i++) np[i] = NTL_ZZ_RADIX-1;
+      div_dc_qr_n(I, np, dp, n, tp);
+      return;
+   }
+
+   long h = (n+1)/2;
+   long l = n - h;
+
+   UniqueArray<_ntl_limb_t> mem;
+   mem.SetLength((h+1) + (n+h+2) + (n+1) + (n+h+2) + (n+2) + 2*(2*n+1));
+   _ntl_limb_t *X = mem.get();         // h+1 limbs
+   _ntl_limb_t *P = X + (h+1);         // n+h+2 limbs
+   _ntl_limb_t *E = P + (n+h+2);       // n+1 limbs
+   _ntl_limb_t *T = E + (n+1);         // n+h+2 limbs
+   _ntl_limb_t *Y = T + (n+h+2);       // n+2 limbs
+   _ntl_limb_t *S = Y + (n+2);         // 2*n+1 limbs
+   _ntl_limb_t *V = S + (2*n+1);       // 2*n+1 limbs
+
+   // X = RADIX^h + reciprocal of the high-order h limbs of D
+   div_invert(X, dp+l, h);
+   X[h] = 1;
+
+   // E = |RADIX^{n+h} - D*X|, which is less than 2*RADIX^n
+   _ntl_mpn_mul(P, dp, n, X, h+1);
+   long neg = (P[n+h] != 0);
+   if (neg) {
+      for (long i = 0; i <= n; i++) E[i] = P[i];
+   }
+   else {
+      for (long i = 0; i <= n; i++) E[i] = (NTL_ZZ_RADIX-1) - P[i];
+      _ntl_mpn_add_1(E, E, n+1, 1);
+   }
+
+   // Y = X*RADIX^l +/- floor(X*E/RADIX^{2h})
+   _ntl_mpn_mul(T, E, n+1, X, h+1);
+   for (long i = 0; i < l; i++) Y[i] = 0;
+   for (long i = 0; i <= h; i++) Y[l+i] = X[i];
+   Y[n+1] = 0;
+   if (neg)
+      _ntl_mpn_sub(Y, Y, n+2, T+2*h, l+2);
+   else
+      _ntl_mpn_add(Y, Y, n+2, T+2*h, l+2);
+
+   // correct Y, so that D*Y <= RADIX^{2n}-1 < D*(Y+1)
+   _ntl_mpn_mul(S, Y, n+1, dp, n);
+   while (S[2*n]) {
+      _ntl_mpn_sub(S, S, 2*n+1, dp, n);
+      _ntl_mpn_sub_1(Y, Y, n+1, 1);
+   }
+
+   while (!_ntl_mpn_add(V, S, 2*n, dp, n)) {
+      for (long i = 0; i < 2*n; i++) S[i] = V[i];
+      _ntl_mpn_add_1(Y, Y, n+1, 1);
+   }
+
+   for (long i = 0; i < n; i++) I[i] = Y[i];
+}
+
+
+// Divides (np, 2*n) by (dp, n), where the high-order n limbs of np
+// are less than (dp, n), using the reciprocal I computed by div_invert.
+// The quotient is stored in q (n limbs).
+// tp is scratch space of 2*n limbs.
+static void
+div_newton_qr_n(_ntl_limb_t *q, _ntl_limb_t *np, const _ntl_limb_t *dp, 
+                long n, const _ntl_limb_t *I, _ntl_limb_t *tp)
+{
+   // this estimate is never too large, and is too small by 
+   // only a few units
+   _ntl_mpn_mul(tp, np+n, n, I, n);
+   _ntl_mpn_add_n(q, tp+n, np+n, n);
+
+   // the remainder fits in n+1 limbs
+   _ntl_mpn_mul(tp, q, n, dp, n);
+   _ntl_mpn_sub_n(np, np, tp, n+1);
+
+   while (np[n] || _ntl_mpn_cmp(np, dp, n) >= 0) {
+      np[n] -= _ntl_mpn_sub_n(np, np, dp, n);
+      _ntl_mpn_add_1(q, q, n, 1);
+   }
+}
+
+
+// Divides (a, sa) by (d, sd), with the same interface as _ntl_mpn_tdiv_qr.
+static void
+div_dc_tdiv_qr(_ntl_limb_t *q, _ntl_limb_t *r, 
+               const _ntl_limb_t *a, long sa, const _ntl_limb_t *d, long sd)
+{
+   long shift = NTL_ZZ_NBITS - COUNT_BITS(d[sd-1]);
+   long nn = sa + 1;
+   long qn = nn - sd;
+
+   UniqueArray<_ntl_limb_t> mem;
+   mem.SetLength(nn + sd + 2*sd);
+   _ntl_limb_t *np = mem.get();
+   _ntl_limb_t *dp = np + nn;
+   _ntl_limb_t *tp = dp + sd;
+
+   if (shift) {
+      _ntl_mpn_lshift(dp, d, sd, shift);
+      np[sa] = _ntl_mpn_lshift(np, a, sa, shift);
+   }
+   else {
+      for (long i = 0; i < sd; i++) dp[i] = d[i];
+      for (long i = 0; i < sa; i++) np[i] = a[i];
+      np[sa] = 0;
+   }
+
+   // the top sd limbs of np are less than dp, so the quotient has
+   // qn limbs; we compute it in blocks of sd limbs, starting with
+   // a (possibly) shorter block at the top
+
+   long b = qn % sd;
+   if (b == 0) b = sd;
+   long i = qn - b;
+
+   div_dc_qr_short(q+i, np+i, b, dp, sd, tp);
+
+   if (i > 0) {
+      if (sd >= DIV_NEWTONX && i >= 4*sd) {
+         UniqueArray<_ntl_limb_t> I;
+         I.SetLength(sd);
+         div_invert(I.get(), dp, sd);
+
+         for (i -= sd; i >= 0; i -= sd)
+            div_newton_qr_n(q+i, np+i, dp, sd, I.get(), tp);
+      }
+      else {
+         for (i -= sd; i >= 0; i -= sd)
+            div_dc_qr_n(q+i, np+i, dp, sd, tp);
+      }
+   }
+
+   if (shift)
+      _ntl_mpn_rshift(r, np, sd, shift);
+   else
+      for (long i = 0; i < sd; i++) r[i] = np[i];
+}
+
+
 // NOTE: no aliasing allowed (more recent versions of GMP allow a==r)
 void 
 _ntl_mpn_tdiv_qr (_ntl_limb_t *q, _ntl_limb_t *r,long  /* qxn */, 
@@ -1011,6 +2672,11 @@ _ntl_mpn_tdiv_qr (_ntl_limb_t *q, _ntl_limb_t *r,long  /* qxn */,
       return;
    }
 
+   if (sd >= DIV_DCX && sa-sd >= DIV_DCX) {
+      div_dc_tdiv_qr(q, r, a, sa, d, sd);
+      return;
+   }
+
    // compute dhi = high order NTL_ZZ_NBITS of (d[sd-1], ..., d[0])
    _ntl_limb_t d1 = d[sd-1];
    _ntl_limb_t d0 = d[sd-2];
@@ -1375,6 +3041,204 @@ void ForceNormal(_ntl_gbigint x)
 
 
 
+/* Pooled storage.
+ *
+ * Blocks are grouped in size classes:  class k holds blocks of exactly
+ * MIN_SETL << k limbs.  Each thread keeps a LIFO free list per class,
+ * and _ntl_gsetlength takes blocks from there before calling malloc.
+ * The link to the next block is kept in the DATA part of the block.
+ *
+ * Class 0 is always pooled:  values of up to MIN_SETL-1 limbs always 
+ * get a block of exactly MIN_SETL limbs, and most integers in matrix, 
+ * lattice and polynomial code are of this kind.  Up to SMALL_BLOCK_MAX
+ * of these are kept.
+ *
+ * The other classes are only used while the thread is inside a pool
+ * scope (see _ntl_gpool_enter/_ntl_gpool_leave, and ZZArenaScope in
+ * ZZ.h).  Inside a scope, new allocations are rounded up to a class
+ * size, and freed blocks are kept (up to POOL_MAX_BYTES in all), so
+ * that the temporaries of a computation are recycled within the
+ * thread without touching malloc's locks.  When the outermost scope
+ * is left, the blocks kept in the classes k > 0 are released at once.
+ *
+ * When a thread exits, all its lists are released, and any later 
+ * frees in that thread (e.g., of static objects, at program exit) go
+ * straight to free().
+ *
+ * Blocks are ordinary malloc'd blocks, so a block may be freed by a
+ * thread other than the one that allocated it.
+ */
+
+#define SMALL_BLOCK_MAX (4096)
+#define POOL_CLASSES (24)
+#define POOL_MAX_BYTES (1L << 26)
+
+static NTL_CHEAP_THREAD_LOCAL _ntl_gbigint pool_head[POOL_CLASSES];
+static NTL_CHEAP_THREAD_LOCAL long pool_count0 = 0;   // length of list 0
+static NTL_CHEAP_THREAD_LOCAL long pool_depth = 0;    // nesting of scopes
+static NTL_CHEAP_THREAD_LOCAL long pool_state = 0;
+// 0: not yet used, 1: in use, 2: released
+static NTL_CHEAP_THREAD_LOCAL long pool_bytes = 0;    // bytes on the lists
+
+// the counters of _ntl_gpool_get_stats are only kept if NTL_POOL_STATS
+// is set, so that the allocation paths do not pay for them otherwise
+
+#ifdef NTL_POOL_STATS
+static NTL_CHEAP_THREAD_LOCAL _ntl_gpool_stats pool_stats;
+#define POOL_STAT(stmt) stmt
+#else
+#define POOL_STAT(stmt)
+#endif
+
+static
+void pool_release(long first_class)
+{
+   for (long k = first_class; k < POOL_CLASSES; k++) {
+      while (pool_head[k]) {
+         _ntl_gbigint x = pool_head[k];
+         memcpy(&pool_head[k], DATA(x), sizeof(_ntl_gbigint));
+         pool_bytes -= STORAGE(ALLOC(x) >> 2);
+         free((void*) x);
+      }
+   }
+
+   if (first_class == 0) pool_count0 = 0;
+}
+
+struct _ntl_gpool_list {
+   _ntl_gpool_list() { pool_state = 1; }
+   ~_ntl_gpool_list() { pool_release(0); pool_state = 2; }
+};
+
+NTL_TLS_GLOBAL_DECL(_ntl_gpool_list, gpool_list)
+
+// the class of a block of len limbs, or -1
+static inline
+long pool_class(long len)
+{
+   if (len < MIN_SETL || len % MIN_SETL) return -1;
+   long q = len/MIN_SETL;
+   if (q & (q-1)) return -1;
+   long k = 0;
+   while (q > 1) { q >>= 1; k++; }
+   return k < POOL_CLASSES ? k : -1;
+}
+
+// the smallest class size >= len, or len if there is none
+static inline
+long pool_round(long len)
+{
+   long m = MIN_SETL;
+   for (long k = 0; k < POOL_CLASSES; k++, m <<= 1) 
+      if (m >= len) return m;
+   return len;
+}
+
+// a block of class k, or 0
+static inline
+_ntl_gbigint pool_get(long k)
+{
+   _ntl_gbigint x = pool_head[k];
+   if (x) {
+      memcpy(&pool_head[k], DATA(x), sizeof(_ntl_gbigint));
+      if (k == 0) pool_count0--;
+      pool_bytes -= STORAGE(MIN_SETL << k);
+      POOL_STAT(pool_stats.hits++);
+   }
+   return x;
+}
+
+// keeps x, of class k, if there is room
+static inline
+bool pool_put(_ntl_gbigint x, long k)
+{
+   if (pool_state == 2) return false;
+
+   long sz = STORAGE(MIN_SETL << k);
+
+   if (pool_depth == 0) {
+      if (k != 0 || pool_count0 >= SMALL_BLOCK_MAX) return false;
+   }
+   else {
+      if (pool_bytes + sz > POOL_MAX_BYTES) return false;
+   }
+
+   if (pool_state == 0) {
+      // registers the lists for release at thread exit
+      NTL_TLS_GLOBAL_ACCESS(gpool_list);
+      (void) gpool_list;
+   }
+
+   memcpy(DATA(x), &pool_head[k], sizeof(_ntl_gbigint));
+   pool_head[k] = x;
+   if (k == 0) pool_count0++;
+
+   pool_bytes += sz;
+#ifdef NTL_POOL_STATS
+   pool_stats.pooled++;
+   if (pool_bytes > pool_stats.peak_cached_bytes)
+      pool_stats.peak_cached_bytes = pool_bytes;
+#endif
+
+   return true;
+}
+
+#ifdef NTL_POOL_STATS
+static inline
+void pool_live(long delta)
+{
+   pool_stats.live_bytes += delta;
+   if (pool_stats.live_bytes > pool_stats.peak_live_bytes)
+      pool_stats.peak_live_bytes = pool_stats.live_bytes;
+}
+#endif
+
+void _ntl_gpool_enter()
+{
+   pool_depth++;
+}
+
+void _ntl_gpool_leave()
+{
+   if (pool_depth <= 0) 
+      LogicError("_ntl_gpool_leave: no pool scope");
+
+   pool_depth--;
+   if (pool_depth == 0) {
+      pool_release(1);
+
+      // trim list 0 back to its size outside scopes
+      while (pool_count0 > SMALL_BLOCK_MAX) {
+         _ntl_gbigint x = pool_head[0];
+         memcpy(&pool_head[0], DATA(x), sizeof(_ntl_gbigint));
+         pool_count0--;
+         pool_bytes -= STORAGE(MIN_SETL);
+         free((void*) x);
+      }
+   }
+}
+
+void _ntl_gpool_get_stats(_ntl_gpool_stats *st)
+{
+#ifdef NTL_POOL_STATS
+   *st = pool_stats;
+#else
+   memset(st, 0, sizeof(*st));
+#endif
+   st->cached_bytes = pool_bytes;
+}
+
+void _ntl_gpool_reset_stats()
+{
+#ifdef NTL_POOL_STATS
+   pool_stats.allocs = pool_stats.hits = 0;
+   pool_stats.frees = pool_stats.pooled = 0;
+   pool_stats.peak_cached_bytes = pool_bytes;
+   pool_stats.peak_live_bytes = pool_stats.live_bytes;
+#endif
+}
+
+
 void _ntl_gsetlength(_ntl_gbigint *v, long len)
 {
    _ntl_gbigint x = *v;
@@ -1406,6 +3270,8 @@ void _ntl_gsetlength(_ntl_gbigint *v, long len)
 
       if (len <= oldlen) return;
 
+      long oldlen0 = oldlen;
+
       len++;  /* always allocate at least one more than requested */
 
       oldlen = _ntl_vec_grow(oldlen);
@@ -1419,11 +3285,32 @@ void _ntl_gsetlength(_ntl_gbigint *v, long len)
       if (NTL_OVERFLOW(len, NTL_ZZ_NBITS, 0))
          ResourceError("size too big in _ntl_gsetlength");
 
+      if (pool_depth > 0) len = pool_round(len);
+
       if (STORAGE_OVF(len))
          ResourceError("reallocation failed in _ntl_gsetlength");
 
-      if (!(x = (_ntl_gbigint)NTL_SNS_REALLOC((void *) x, 1, STORAGE(len), 0))) {
-         MemoryError();
+      POOL_STAT(pool_stats.allocs++);
+      long k = (pool_depth > 0) ? pool_class(len) : -1;
+      _ntl_gbigint y;
+
+      if (k >= 0 && (y = pool_get(k))) {
+         // move the contents, and give the old block back
+         long sx = SIZE(x);
+         if (sx < 0) sx = -sx;
+         SIZE(y) = SIZE(x);
+         memcpy(DATA(y), DATA(x), sx*sizeof(_ntl_limb_t));
+
+         long k1 = pool_class(oldlen0);
+         POOL_STAT(pool_live(STORAGE(len) - STORAGE(oldlen0)));
+         if (k1 < 0 || !pool_put(x, k1)) free((void*) x);
+         x = y;
+      }
+      else {
+         if (!(x = (_ntl_gbigint)NTL_SNS_REALLOC((void *) x, 1, STORAGE(len), 0))) {
+            MemoryError();
+         }
+         POOL_STAT(pool_live(STORAGE(len) - STORAGE(oldlen0)));
       }
       ALLOC(x) = len << 2;
    }
@@ -1435,9 +3322,22 @@ void _ntl_gsetlength(_ntl_gbigint *v, long len)
       if (NTL_OVERFLOW(len, NTL_ZZ_NBITS, 0))
          ResourceError("size too big in _ntl_gsetlength");
 
+      if (pool_depth > 0) len = pool_round(len);
+
       if (STORAGE_OVF(len))
          ResourceError("reallocation failed in _ntl_gsetlength");
 
+      POOL_STAT(pool_stats.allocs++);
+      POOL_STAT(pool_live(STORAGE(len)));
+
+      long k = pool_class(len);
+      if (k >= 0 && (k == 0 || pool_depth > 0) && (x = pool_get(k))) {
+         // ALLOC(x) is already len << 2
+         SIZE(x) = 0;
+         *v = x;
+         return;
+      }
+
       if (!(x = (_ntl_gbigint)NTL_SNS_MALLOC(1, STORAGE(len), 0))) {
          MemoryError();
       }
@@ -1458,6 +3358,14 @@ void _ntl_gfree(_ntl_gbigint x)
    if (ALLOC(x) & 1)
       TerminalError("Internal error: can't free this _ntl_gbigint");
 
+   long len = ALLOC(x) >> 2;
+   POOL_STAT(pool_stats.frees++);
+   POOL_STAT(pool_live(-STORAGE(len)));
+
+   long k = pool_class(len);
+   if (k >= 0 && pool_put(x, k))
+      return;
+
    free((void*) x);
    return;
 }
@@ -1593,6 +3501,35 @@ long _ntl_gbit(_ntl_gbigint a, long p)
    return 0;
 }
 
+long _ntl_gbits(_ntl_gbigint a, long p, long w)
+{
+   long bl, sh, sa, got;
+   _ntl_limb_t *adata;
+   _ntl_ulong res;
+
+   if (p < 0 || w <= 0 || !a) return 0;
+   if (w >= NTL_BITS_PER_LONG) LogicError("_ntl_gbits: w too large");
+
+   bl = p/NTL_ZZ_NBITS;
+   sh = p - NTL_ZZ_NBITS*bl;
+
+   sa = SIZE(a);
+   if (sa < 0) sa = -sa;
+
+   if (sa <= bl) return 0;
+
+   adata = DATA(a);
+   res = ((_ntl_ulong) adata[bl]) >> sh;
+   got = NTL_ZZ_NBITS - sh;
+
+   for (bl++; got < w && bl < sa; bl++) {
+      res |= ((_ntl_ulong) adata[bl]) << got;
+      got += NTL_ZZ_NBITS;
+   }
+
+   return long(res & ((1UL << w) - 1UL));
+}
+
 void _ntl_glowbits(_ntl_gbigint a, long b, _ntl_gbigint *cc)
 {
    _ntl_gbigint c;
@@ -2442,6 +4379,53 @@ void _ntl_grshift(_ntl_gbigint n, long k, _ntl_gbigint *rres)
 
 
 
+
+// Single-limb operands.  These are most of the entries of matrices
+// and polynomials over ZZ with small entries, and for them the
+// general code below spends more time on dispatch than arithmetic.
+
+// c = a + b, for |a|, |b| single limbs, where aneg, bneg are the signs
+static inline void
+add_limbs(_ntl_limb_t x, long aneg, _ntl_limb_t y, long bneg,
+          _ntl_gbigint *cc)
+{
+   _ntl_gbigint c = *cc;
+   if (MustAlloc(c, 2)) {
+      _ntl_gsetlength(&c, 2);
+      *cc = c;
+   }
+
+   _ntl_limb_t *cdata = DATA(c);
+   long sc;
+
+   if (aneg == bneg) {
+      // a carry occurred iff the clipped sum is less than x
+      _ntl_limb_t sum = CLIP(x + y);
+      cdata[0] = sum;
+      if (sum < x) {
+         cdata[1] = 1;
+         sc = 2;
+      }
+      else
+         sc = 1;
+
+      if (aneg) sc = -sc;
+   }
+   else if (x == y) 
+      sc = 0;
+   else if (x > y) {
+      cdata[0] = x - y;
+      sc = aneg ? -1 : 1;
+   }
+   else {
+      cdata[0] = y - x;
+      sc = bneg ? -1 : 1;
+   }
+
+   SIZE(c) = sc;
+}
+
+
 void
 _ntl_gadd(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
 {
@@ -2463,6 +4447,11 @@ _ntl_gadd(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
    GET_SIZE_NEG(sa, aneg, a);
    GET_SIZE_NEG(sb, bneg, b);
 
+   if (sa == 1 && sb == 1) {
+      add_limbs(DATA(a)[0], aneg, DATA(b)[0], bneg, cc);
+      return;
+   }
+
    if (sa < sb) {
       SWAP_BIGINT(a, b);
       SWAP_LONG(sa, sb);
@@ -2762,6 +4751,11 @@ _ntl_gsub(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
    GET_SIZE_NEG(sa, aneg, a);
    GET_SIZE_NEG(sb, bneg, b);
 
+   if (sa == 1 && sb == 1) {
+      add_limbs(DATA(a)[0], aneg, DATA(b)[0], !bneg, cc);
+      return;
+   }
+
    if (sa < sb) {
       SWAP_BIGINT(a, b);
       SWAP_LONG(sa, sb);
@@ -2884,6 +4878,41 @@ _ntl_gsubpos(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
    SIZE(c) = sc;
 }
 
+// c = a*b, for |a|, |b| single limbs;  a and b are read before c
+// is written, so any of them may alias
+static inline void
+mul_limbs(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
+{
+   _ntl_limb_t x = DATA(a)[0], y = DATA(b)[0], hi, lo;
+
+#if (!defined(NTL_GMP_LIP))
+   hi = 0;
+   _ntl_mulp(lo, x, y, hi);
+#elif (defined(NTL_VIABLE_LL) && NTL_NAIL_BITS == 0)
+   ll_type prod;
+   ll_mul(prod, x, y);
+   lo = ll_get_lo(prod);
+   hi = ll_get_hi(prod);
+#else
+   lo = x;
+   hi = NTL_MPN(mul_1)(&lo, &lo, 1, y);
+#endif
+
+   long neg = (SIZE(a) < 0) != (SIZE(b) < 0);
+
+   _ntl_gbigint c = *cc;
+   if (MustAlloc(c, 2)) {
+      _ntl_gsetlength(&c, 2);
+      *cc = c;
+   }
+
+   _ntl_limb_t *cdata = DATA(c);
+   cdata[0] = lo;
+   cdata[1] = hi;
+   long sc = hi ? 2 : 1;
+   SIZE(c) = neg ? -sc : sc;
+}
+
 #if 1
 
 // This version is faster for small inputs.
@@ -2924,6 +4953,11 @@ void _ntl_gmul(_ntl_gbigint a, _ntl_gbigint b, _ntl_gbigint *cc)
    GET_SIZE_NEG(sa, aneg, a);
    GET_SIZE_NEG(sb, bneg, b);
 
+   if (sa == 1 && sb == 1) {
+      mul_limbs(a, b, cc);
+      return;
+   }
+
    if (a != *cc && b != *cc) {
       // no aliasing
 
@@ -3723,84 +5757,537 @@ done:
 
 
 
+// Lehmer's estimate of the leading quotients of a/n, from the
+// leading limbs of a and n, which are positive with SIZE(a) >= SIZE(n).
+// Returns 0 if there is nothing to be gained, and otherwise sets g
+// so that (a, n) -> (g[0]*a - g[1]*n, g[3]*n - g[2]*a) is an even
+// number of Euclidean steps, which carry the cofactors along as
+// (u, w) -> (g[0]*u + g[1]*w, g[2]*u + g[3]*w).  g is the identity
+// when 0 is returned.  Used by the Lehmer GCD, XGCD and rational
+// reconstruction loops, and by the base case of the half-GCD.
+
+static long
+lehmer_step(_ntl_gbigint a, _ntl_gbigint n, long *g)
+{
+   long diff;
+   long ilo;
+   long sa;
+   long sn;
+   long temp;
+   long fast;
+   long parity;
+   long gotthem;
+   _ntl_limb_t *p;
+   long try11;
+   long try12;
+   long try21;
+   long try22;
+   double hi;
+   double lo;
+   double dt;
+   double fhi, fhi1;
+   double flo, flo1;
+   double num;
+   double den;
+   double dirt;
+
+   fhi1 = double(1L) + double(32L)/NTL_FDOUBLE_PRECISION;
+   flo1 = double(1L) - double(32L)/NTL_FDOUBLE_PRECISION;
+
+   fhi = double(1L) + double(8L)/NTL_FDOUBLE_PRECISION;
+   flo = double(1L) - double(8L)/NTL_FDOUBLE_PRECISION;
+
+   g[0] = 1;
+   g[1] = 0;
+   g[2] = 0;
+   g[3] = 1;
+
+   gotthem = 0;
+   sa = SIZE(a);
+   sn = SIZE(n);
+   diff = sa - sn;
+   if (diff != 0 && diff != 1) return 0;
+
+   p = DATA(a) + (sa-1);
+   num = DBL(*p) * NTL_ZZ_FRADIX;
+   if (sa > 1)
+      num += DBL(*(--p));
+   num *= NTL_ZZ_FRADIX;
+   if (sa > 2)
+      num += DBL(*(p - 1));
+
+   p = DATA(n) + (sn-1);
+   den = DBL(*p) * NTL_ZZ_FRADIX;
+   if (sn > 1)
+      den += DBL(*(--p));
+   den *= NTL_ZZ_FRADIX;
+   if (sn > 2)
+      den += DBL(*(p - 1));
+
+   hi = fhi1 * (num + double(1L)) / den;
+   lo = flo1 * num / (den + double(1L));
+   if (diff > 0)
+   {
+      hi *= NTL_ZZ_FRADIX;
+      lo *= NTL_ZZ_FRADIX;
+   }
+   try11 = 1;
+   try12 = 0;
+   try21 = 0;
+   try22 = 1;
+   parity = 1;
+   fast = 1; 
+   while (fast > 0)
+   {
+      parity = 1 - parity;
+      if (hi >= NTL_NSP_BOUND)
+         fast = 0;
+      else
+      {
+         ilo = (long)lo;
+         dirt = hi - double(ilo);
+         if (dirt < 1.0/NTL_FDOUBLE_PRECISION || !ilo || ilo < (long)hi)
+            fast = 0;
+         else
+         {
+            dt = lo-double(ilo);
+            lo = flo / dirt;
+            if (dt > 1.0/NTL_FDOUBLE_PRECISION)
+               hi = fhi / dt;
+            else
+               hi = double(NTL_NSP_BOUND);
+            temp = try11;
+            try11 = try21;
+            if ((NTL_WSP_BOUND - temp) / ilo < try21)
+               fast = 0;
+            else
+               try21 = temp + ilo * try21;
+            temp = try12;
+            try12 = try22;
+            if ((NTL_WSP_BOUND - temp) / ilo < try22)
+               fast = 0;
+            else
+               try22 = temp + ilo * try22;
+            if ((fast > 0) && (parity > 0))
+            {
+               gotthem = 1;
+               g[0] = try11;
+               g[1] = try12;
+               g[2] = try21;
+               g[3] = try22;
+            }
+         }
+      }
+   }
+
+   return gotthem;
+}
+
+
+
+
+
+
+#ifdef NTL_GMP_LIP
+
+void _ntl_ggcd(_ntl_gbigint m1, _ntl_gbigint m2, _ntl_gbigint *r)
+{
+   GRegister(s1);
+   GRegister(s2);
+   GRegister(res);
+
+   long k1, k2, k_min, l1, l2, ss1, ss2, sres;
+
+   _ntl_gcopy(m1, &s1);
+   _ntl_gabs(&s1);
+
+   _ntl_gcopy(m2, &s2);
+   _ntl_gabs(&s2);
+
+   if (ZEROP(s1)) {
+      _ntl_gcopy(s2, r);
+      return;
+   }
+
+   if (ZEROP(s2)) {
+      _ntl_gcopy(s1, r);
+      return;
+   }
+
+   k1 = _ntl_gmakeodd(&s1);
+   k2 = _ntl_gmakeodd(&s2);
+
+   if (k1 <= k2)
+      k_min = k1;
+   else
+      k_min = k2;
+
+   l1 = _ntl_g2log(s1);
+   l2 = _ntl_g2log(s2);
+
+   ss1 = SIZE(s1);
+   ss2 = SIZE(s2);
+
+   if (ss1 >= ss2)
+      sres = ss1;
+   else
+      sres = ss2;
+
+   /* set to max: gmp documentation is unclear on this point */
+
+   _ntl_gsetlength(&res, sres);
+   
+   // NOTE: older versions of GMP require first operand has
+   // at least as many bits as the second.
+   // It seems this requirement has been relaxed in more
+   // recent versions.
+
+   if (l1 >= l2)
+      SIZE(res) = mpn_gcd(DATA(res), DATA(s1), ss1, DATA(s2), ss2);
+   else
+      SIZE(res) = mpn_gcd(DATA(res), DATA(s2), ss2, DATA(s1), ss1);
+
+   _ntl_glshift(res, k_min, &res);
+
+   _ntl_gcopy(res, r);
+}
+
+void
+_ntl_ggcd_alt(_ntl_gbigint mm1, _ntl_gbigint mm2, _ntl_gbigint *rres)
+{
+   _ntl_ggcd(mm1, mm2, rres);
+}
+
+
+#else
+
+
+
+/*********************************************************************
+ *
+ * Half-GCD
+ *
+ * For large inputs, GCD and extended GCD are computed with a
+ * subquadratic half-GCD in the style of Schoenhage and Thull-Yap,
+ * which reduces the inputs to a size where the Lehmer code finishes.
+ *
+ * hgcd(M, a, b) takes a >= b >= 0 and advances (a, b) along its
+ * Euclidean remainder sequence until a >= 2^m > b, where
+ * m = ceil(NumBits(a)/2), recording the quotients in M, so that
+ * (a_in, b_in)^T = M (a, b)^T.  The work is done recursively on the
+ * high-order bits, whose quotients agree with those of the full
+ * numbers except possibly for the last few; any such quotients are
+ * detected (the remainders come out of order) and undone, so that the
+ * computed sequence is always exactly the Euclidean one.  In
+ * particular, the cofactors returned by XGCD and InvMod are the same
+ * as with the Lehmer code.
+ *
+ *********************************************************************/
+
+#define HGCDX (60)        // crossover for XGCD/InvMod, in limbs
+#define HGCD_GCDX (300)   // crossover for GCD, in limbs
+#define HGCD_BASEX (60)   // base case of hgcd, in limbs
+
+
+// a product of matrices [[q, 1], [1, 0]] with q >= 1
+
+struct _ntl_hgcd_matrix {
+   _ntl_gbigint_wrapped m00, m01, m10, m11;
+   long det;
+
+   void one()
+   {
+      _ntl_gone(&m00); _ntl_gzero(&m01);
+      _ntl_gzero(&m10); _ntl_gone(&m11);
+      det = 1;
+   }
+
+   bool is_one() { return ZEROP(m01) && ZEROP(m10); }
+};
+
+
+// M = M * [[q, 1], [1, 0]]
+
+static void
+hgcd_mul_q(_ntl_hgcd_matrix& M, _ntl_gbigint q, _ntl_gbigint_wrapped& t)
+{
+   _ntl_gmul(q, M.m00, &t);
+   _ntl_gadd(t, M.m01, &t);
+   _ntl_swap(M.m01, M.m00);
+   _ntl_swap(M.m00, t);
+
+   _ntl_gmul(q, M.m10, &t);
+   _ntl_gadd(t, M.m11, &t);
+   _ntl_swap(M.m11, M.m10);
+   _ntl_swap(M.m10, t);
+
+   M.det = -M.det;
+}
+
+
+// M = M * S
+
+static void
+hgcd_mul(_ntl_hgcd_matrix& M, _ntl_hgcd_matrix& S,
+         _ntl_gbigint_wrapped& t1, _ntl_gbigint_wrapped& t2)
+{
+   _ntl_gmul(M.m00, S.m00, &t1);
+   _ntl_gmul(M.m01, S.m10, &t2);
+   _ntl_gadd(t1, t2, &t1);
+   _ntl_gmul(M.m00, S.m01, &t2);
+   _ntl_swap(M.m00, t1);
+   _ntl_gmul(M.m01, S.m11, &t1);
+   _ntl_gadd(t1, t2, &M.m01);
+
+   _ntl_gmul(M.m10, S.m00, &t1);
+   _ntl_gmul(M.m11, S.m10, &t2);
+   _ntl_gadd(t1, t2, &t1);
+   _ntl_gmul(M.m10, S.m01, &t2);
+   _ntl_swap(M.m10, t1);
+   _ntl_gmul(M.m11, S.m11, &t1);
+   _ntl_gadd(t1, t2, &M.m11);
+
+   M.det *= S.det;
+}
+
+
+// (a, b)^T = M^{-1} (a, b)^T
+
+static void
+hgcd_apply_inv(_ntl_hgcd_matrix& M,
+               _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b,
+               _ntl_gbigint_wrapped& t1, _ntl_gbigint_wrapped& t2)
+{
+   _ntl_gmul(M.m11, a, &t1);
+   _ntl_gmul(M.m01, b, &t2);
+   _ntl_gsub(t1, t2, &t1);
+
+   _ntl_gmul(M.m00, b, &t2);
+   _ntl_gmul(M.m10, a, &b);
+   _ntl_gsub(t2, b, &b);
+
+   _ntl_swap(a, t1);
+
+   if (M.det < 0) {
+      _ntl_gnegate(&a);
+      _ntl_gnegate(&b);
+   }
+}
+
+
+// one Euclidean step: (a, b) = (b, a mod b)
+
+static void
+hgcd_step(_ntl_hgcd_matrix& M,
+          _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b,
+          _ntl_gbigint_wrapped& q, _ntl_gbigint_wrapped& t)
+{
+   _ntl_gdiv(a, b, &q, &a);
+   _ntl_swap(a, b);
+   hgcd_mul_q(M, q, t);
+}
+
+
+// undoes the last step recorded in M.
+// The last quotient q is recovered from the second row of M:
+// if M = M' [[q, 1], [1, 0]] with M' != 1, then the second row of
+// M' is (u, v) with u > v, and that of M is (q*u + v, u).
+
+static void
+hgcd_backstep(_ntl_hgcd_matrix& M,
+              _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b,
+              _ntl_gbigint_wrapped& q, _ntl_gbigint_wrapped& t)
+{
+   if (ZEROP(M.m11))
+      _ntl_gcopy(M.m00, &q);
+   else
+      _ntl_gdiv(M.m10, M.m11, &q, 0);
+
+   _ntl_gmul(q, M.m01, &t);
+   _ntl_gsub(M.m00, t, &t);
+   _ntl_swap(M.m00, M.m01);
+   _ntl_swap(M.m01, t);
+
+   _ntl_gmul(q, M.m11, &t);
+   _ntl_gsub(M.m10, t, &t);
+   _ntl_swap(M.m10, M.m11);
+   _ntl_swap(M.m11, t);
+
+   M.det = -M.det;
+
+   _ntl_gmul(q, a, &t);
+   _ntl_gadd(t, b, &t);
+   _ntl_swap(b, a);
+   _ntl_swap(a, t);
+}
 
 
+// after applying the quotients of a truncated problem,
+// (a, b) is a genuine pair of consecutive remainders iff a > b >= 0,
+// except that a final quotient 1 with b = 0 may have come from the
+// non-genuine pair (a, a)
 
+static bool
+hgcd_valid(_ntl_hgcd_matrix& M,
+           _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b,
+           _ntl_gbigint_wrapped& t)
+{
+   if (M.is_one()) return true;
+   if (_ntl_gsign(b) < 0 || _ntl_gcompare(a, b) <= 0) return false;
+   if (ZEROP(b) && !ZEROP(M.m11)) {
+      // the last quotient is floor(m10/m11)
+      _ntl_gsub(M.m10, M.m11, &t);
+      if (_ntl_gcompare(t, M.m11) < 0) return false;
+   }
+   return true;
+}
 
+static void
+hgcd_fix(_ntl_hgcd_matrix& M,
+         _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b,
+         _ntl_gbigint_wrapped& q, _ntl_gbigint_wrapped& t)
+{
+   while (!hgcd_valid(M, a, b, t))
+      hgcd_backstep(M, a, b, q, t);
+}
 
 
-#ifdef NTL_GMP_LIP
+// base case: Lehmer steps as long as they do not overshoot,
+// and single steps to finish
 
-void _ntl_ggcd(_ntl_gbigint m1, _ntl_gbigint m2, _ntl_gbigint *r)
-{
-   GRegister(s1);
-   GRegister(s2);
-   GRegister(res);
+static void
+hgcd_base(_ntl_hgcd_matrix& M,
+          _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b, long m)
+{
+   _ntl_gbigint_wrapped q, t, x, y;
+   long g[4] = { 1, 0, 0, 1 };
+
+   M.one();
+
+   while (_ntl_g2log(b) > m) {
+      if (lehmer_step(a, b, g)) {
+         _ntl_gsmul(a, g[0], &x);
+         _ntl_gsmul(b, g[1], &t);
+         _ntl_gsub(x, t, &x);
+         _ntl_gsmul(b, g[3], &y);
+         _ntl_gsmul(a, g[2], &t);
+         _ntl_gsub(y, t, &y);
+
+         if (_ntl_g2log(y) > m) {
+            _ntl_swap(a, x);
+            _ntl_swap(b, y);
+
+            // M = M * [[g3, g1], [g2, g0]]
+
+            _ntl_gsmul(M.m00, g[3], &x);
+            _ntl_gsmul(M.m01, g[2], &t);
+            _ntl_gadd(x, t, &x);
+            _ntl_gsmul(M.m00, g[1], &y);
+            _ntl_gsmul(M.m01, g[0], &t);
+            _ntl_gadd(y, t, &M.m01);
+            _ntl_swap(M.m00, x);
+
+            _ntl_gsmul(M.m10, g[3], &x);
+            _ntl_gsmul(M.m11, g[2], &t);
+            _ntl_gadd(x, t, &x);
+            _ntl_gsmul(M.m10, g[1], &y);
+            _ntl_gsmul(M.m11, g[0], &t);
+            _ntl_gadd(y, t, &M.m11);
+            _ntl_swap(M.m10, x);
+
+            continue;
+         }
+      }
 
-   long k1, k2, k_min, l1, l2, ss1, ss2, sres;
+      hgcd_step(M, a, b, q, t);
+   }
+}
 
-   _ntl_gcopy(m1, &s1);
-   _ntl_gabs(&s1);
 
-   _ntl_gcopy(m2, &s2);
-   _ntl_gabs(&s2);
+static void
+hgcd(_ntl_hgcd_matrix& M, _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b)
+{
+   long n = _ntl_g2log(a);
+   long m = (n+1)/2;
 
-   if (ZEROP(s1)) {
-      _ntl_gcopy(s2, r);
+   if (_ntl_g2log(b) <= m) {
+      M.one();
       return;
    }
 
-   if (ZEROP(s2)) {
-      _ntl_gcopy(s1, r);
+   if (SIZE(a) < HGCD_BASEX) {
+      hgcd_base(M, a, b, m);
       return;
    }
 
-   k1 = _ntl_gmakeodd(&s1);
-   k2 = _ntl_gmakeodd(&s2);
+   _ntl_gbigint_wrapped a0, b0, q, t1, t2;
+   _ntl_hgcd_matrix S;
+   long l, k;
 
-   if (k1 <= k2)
-      k_min = k1;
-   else
-      k_min = k2;
+   // first half: reduce the high-order n-m bits to half their size
 
-   l1 = _ntl_g2log(s1);
-   l2 = _ntl_g2log(s2);
+   _ntl_grshift(a, m, &a0);
+   _ntl_grshift(b, m, &b0);
+   hgcd(M, a0, b0);
+   hgcd_apply_inv(M, a, b, t1, t2);
+   hgcd_fix(M, a, b, q, t1);
 
-   ss1 = SIZE(s1);
-   ss2 = SIZE(s2);
+   if (_ntl_g2log(b) <= m) goto done;
 
-   if (ss1 >= ss2)
-      sres = ss1;
-   else
-      sres = ss2;
+   hgcd_step(M, a, b, q, t1);
 
-   /* set to max: gmp documentation is unclear on this point */
+   if (_ntl_g2log(b) <= m) goto done;
 
-   _ntl_gsetlength(&res, sres);
-   
-   // NOTE: older versions of GMP require first operand has
-   // at least as many bits as the second.
-   // It seems this requirement has been relaxed in more
-   // recent versions.
+   // second half: a now has l < n bits; its high-order 2(l-m) bits
+   // reduce to l-m bits, which brings a and b down to about m bits
 
-   if (l1 >= l2)
-      SIZE(res) = mpn_gcd(DATA(res), DATA(s1), ss1, DATA(s2), ss2);
-   else
-      SIZE(res) = mpn_gcd(DATA(res), DATA(s2), ss2, DATA(s1), ss1);
+   l = _ntl_g2log(a);
+   k = 2*m - l;
+   if (k < 0) k = 0;
 
-   _ntl_glshift(res, k_min, &res);
+   _ntl_grshift(a, k, &a0);
+   _ntl_grshift(b, k, &b0);
+   hgcd(S, a0, b0);
+   hgcd_apply_inv(S, a, b, t1, t2);
+   hgcd_fix(S, a, b, q, t1);
+   hgcd_mul(M, S, t1, t2);
 
-   _ntl_gcopy(res, r);
+done:
+   while (!M.is_one() && _ntl_g2log(a) <= m)
+      hgcd_backstep(M, a, b, q, t1);
+
+   while (_ntl_g2log(b) > m)
+      hgcd_step(M, a, b, q, t1);
 }
 
-void
-_ntl_ggcd_alt(_ntl_gbigint mm1, _ntl_gbigint mm2, _ntl_gbigint *rres)
+
+// reduces a >= b >= 0 along the remainder sequence until b has
+// fewer than lim limbs; if M != 0, the transformation is
+// accumulated in *M
+
+static void
+hgcd_reduce(_ntl_hgcd_matrix *M,
+            _ntl_gbigint_wrapped& a, _ntl_gbigint_wrapped& b, long lim)
 {
-   _ntl_ggcd(mm1, mm2, rres);
-}
+   _ntl_gbigint_wrapped q, t1, t2;
+   _ntl_hgcd_matrix S;
 
+   if (M) M->one();
 
-#else
+   while (SIZE(b) >= lim) {
+      hgcd(S, a, b);
+
+      if (!S.is_one()) {
+         if (M) hgcd_mul(*M, S, t1, t2);
+      }
+      else if (M)
+         hgcd_step(*M, a, b, q, t1);
+      else {
+         _ntl_gmod(a, b, &a);
+         _ntl_swap(a, b);
+      }
+   }
+}
 
 
 
@@ -3822,32 +6309,8 @@ gxxeucl_basic(
    GRegister(z);
 
 
-   long diff;
-   long ilo;
-   long sa;
-   long sn;
-   long temp;
    long e;
-   long fast;
-   long parity;
-   long gotthem;
-   _ntl_limb_t *p;
-   long try11;
-   long try12;
-   long try21;
-   long try22;
-   long got11;
-   long got12;
-   long got21;
-   long got22;
-   double hi;
-   double lo;
-   double dt;
-   double fhi, fhi1;
-   double flo, flo1;
-   double num;
-   double den;
-   double dirt;
+   long g[4];
 
    if (SIZE(ain) < SIZE(nin)) {
       _ntl_swap(ain, nin);
@@ -3861,104 +6324,18 @@ gxxeucl_basic(
    _ntl_gsetlength(&y, e);
    _ntl_gsetlength(&z, e);
 
-   fhi1 = double(1L) + double(32L)/NTL_FDOUBLE_PRECISION;
-   flo1 = double(1L) - double(32L)/NTL_FDOUBLE_PRECISION;
-
-   fhi = double(1L) + double(8L)/NTL_FDOUBLE_PRECISION;
-   flo = double(1L) - double(8L)/NTL_FDOUBLE_PRECISION;
-
    _ntl_gcopy(ain, &a);
    _ntl_gcopy(nin, &n);
 
 
    while (SIZE(n) > 0)
    {
-      gotthem = 0;
-      sa = SIZE(a);
-      sn = SIZE(n);
-      diff = sa - sn;
-      if (!diff || diff == 1)
-      {
-         sa = SIZE(a);
-         p = DATA(a) + (sa-1);
-         num = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sa > 1)
-            num += DBL(*(--p));
-         num *= NTL_ZZ_FRADIX;
-         if (sa > 2)
-            num += DBL(*(p - 1));
-
-         sn = SIZE(n);
-         p = DATA(n) + (sn-1);
-         den = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sn > 1)
-            den += DBL(*(--p));
-         den *= NTL_ZZ_FRADIX;
-         if (sn > 2)
-            den += DBL(*(p - 1));
-
-         hi = fhi1 * (num + double(1L)) / den;
-         lo = flo1 * num / (den + double(1L));
-         if (diff > 0)
-         {
-            hi *= NTL_ZZ_FRADIX;
-            lo *= NTL_ZZ_FRADIX;
-         }
-         try11 = 1;
-         try12 = 0;
-         try21 = 0;
-         try22 = 1;
-         parity = 1;
-         fast = 1; 
-         while (fast > 0)
-         {
-            parity = 1 - parity;
-            if (hi >= NTL_NSP_BOUND)
-               fast = 0;
-            else
-            {
-               ilo = (long)lo;
-               dirt = hi - double(ilo);
-               if (dirt < 1.0/NTL_FDOUBLE_PRECISION || !ilo || ilo < (long)hi)
-                  fast = 0;
-               else
-               {
-                  dt = lo-double(ilo);
-                  lo = flo / dirt;
-                  if (dt > 1.0/NTL_FDOUBLE_PRECISION)
-                     hi = fhi / dt;
-                  else
-                     hi = double(NTL_NSP_BOUND);
-                  temp = try11;
-                  try11 = try21;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try21)
-                     fast = 0;
-                  else
-                     try21 = temp + ilo * try21;
-                  temp = try12;
-                  try12 = try22;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try22)
-                     fast = 0;
-                  else
-                     try22 = temp + ilo * try22;
-                  if ((fast > 0) && (parity > 0))
-                  {
-                     gotthem = 1;
-                     got11 = try11;
-                     got12 = try12;
-                     got21 = try21;
-                     got22 = try22;
-                  }
-               }
-            }
-         }
-      }
-      if (gotthem)
+      if (lehmer_step(a, n, g))
       {
-         _ntl_gsmul(a, got11, &x);
-         _ntl_gsmul(n, got12, &y);
-         _ntl_gsmul(a, got21, &z);
-         _ntl_gsmul(n, got22, &n);
+         _ntl_gsmul(a, g[0], &x);
+         _ntl_gsmul(n, g[1], &y);
+         _ntl_gsmul(a, g[2], &z);
+         _ntl_gsmul(n, g[3], &n);
          _ntl_gsub(x, y, &a);
          _ntl_gsub(n, z, &n);
       }
@@ -4007,6 +6384,12 @@ _ntl_ggcd(_ntl_gbigint mm1, _ntl_gbigint mm2, _ntl_gbigint *rres)
    _ntl_gabs(&a);
    _ntl_gcopy(mm2, &b);
    _ntl_gabs(&b);
+
+   if (SIZE(a) >= HGCD_GCDX && SIZE(b) >= HGCD_GCDX) {
+      if (_ntl_gcompare(a, b) < 0) _ntl_swap(a, b);
+      hgcd_reduce(0, a, b, HGCD_GCDX);
+   }
+
    gxxeucl_basic(a, b, rres);
 }
 
@@ -4383,6 +6766,69 @@ long _ntl_ginv(_ntl_gbigint ain, _ntl_gbigint nin, _ntl_gbigint *invv)
 
 #else
 
+static long 
+gxxeucl(
+   _ntl_gbigint ain,
+   _ntl_gbigint nin,
+   _ntl_gbigint *invv,
+   _ntl_gbigint *uu
+   );
+
+// gxxeucl for large inputs: the half-GCD brings the remainders
+// down to HGCDX limbs, and the Lehmer code finishes.
+// If (a, b)^T = M (a', b')^T and s' a' + t' b' = d, then
+// (s, t) = (s', t') M^{-1}.
+
+static long
+gxxeucl_hgcd(
+   _ntl_gbigint ain,
+   _ntl_gbigint nin,
+   _ntl_gbigint *invv,
+   _ntl_gbigint *uu
+   )
+{
+   _ntl_gbigint_wrapped a, b, s, t, x, y;
+   _ntl_hgcd_matrix M;
+
+   long swapped = (_ntl_gcompare(ain, nin) < 0);
+
+   if (swapped) {
+      _ntl_gcopy(nin, &a);
+      _ntl_gcopy(ain, &b);
+   }
+   else {
+      _ntl_gcopy(ain, &a);
+      _ntl_gcopy(nin, &b);
+   }
+
+   hgcd_reduce(&M, a, b, HGCDX);
+
+   gxxeucl(a, b, &s, uu);
+
+   if (ZEROP(b))
+      _ntl_gzero(&t);
+   else {
+      _ntl_gmul(a, s, &t);
+      _ntl_gsub(*uu, t, &t);
+      _ntl_gdiv(t, b, &t, 0);
+   }
+
+   if (swapped) {
+      _ntl_gmul(t, M.m00, &x);
+      _ntl_gmul(s, M.m01, &y);
+      _ntl_gsub(x, y, invv);
+   }
+   else {
+      _ntl_gmul(s, M.m11, &x);
+      _ntl_gmul(t, M.m10, &y);
+      _ntl_gsub(x, y, invv);
+   }
+
+   if (M.det < 0) _ntl_gnegate(invv);
+
+   return _ntl_gscompare(*uu, 1) != 0;
+}
+
 static long 
 gxxeucl(
    _ntl_gbigint ain,
@@ -4391,6 +6837,10 @@ gxxeucl(
    _ntl_gbigint *uu
    )
 {
+   if (SIZE(ain) >= HGCDX && SIZE(nin) >= HGCDX && 
+       _ntl_gcompare(ain, nin) != 0) 
+      return gxxeucl_hgcd(ain, nin, invv, uu);
+
    GRegister(a);
    GRegister(n);
    GRegister(q);
@@ -4401,148 +6851,38 @@ gxxeucl(
 
    GRegister(inv);
 
-   long diff;
-   long ilo;
-   long sa;
-   long sn;
-   long temp;
    long e;
-   long fast;
-   long parity;
-   long gotthem;
-   _ntl_limb_t *p;
-   long try11;
-   long try12;
-   long try21;
-   long try22;
-   long got11;
-   long got12;
-   long got21;
-   long got22;
-   double hi;
-   double lo;
-   double dt;
-   double fhi, fhi1;
-   double flo, flo1;
-   double num;
-   double den;
-   double dirt;
+   long g[4];
 
    _ntl_gsetlength(&a, (e = 2 + (SIZE(ain) > SIZE(nin) ? SIZE(ain) : SIZE(nin))));
    _ntl_gsetlength(&n, e);
    _ntl_gsetlength(&q, e);
    _ntl_gsetlength(&w, e);
    _ntl_gsetlength(&x, e);
-   _ntl_gsetlength(&y, e);
-   _ntl_gsetlength(&z, e);
-   _ntl_gsetlength(&inv, e);
-
-   fhi1 = double(1L) + double(32L)/NTL_FDOUBLE_PRECISION;
-   flo1 = double(1L) - double(32L)/NTL_FDOUBLE_PRECISION;
-
-   fhi = double(1L) + double(8L)/NTL_FDOUBLE_PRECISION;
-   flo = double(1L) - double(8L)/NTL_FDOUBLE_PRECISION;
-
-   _ntl_gcopy(ain, &a);
-   _ntl_gcopy(nin, &n);
-
-   _ntl_gone(&inv);
-   _ntl_gzero(&w);
-
-   while (SIZE(n) > 0)
-   {
-      gotthem = 0;
-      sa = SIZE(a);
-      sn = SIZE(n);
-      diff = sa - sn;
-      if (!diff || diff == 1)
-      {
-         sa = SIZE(a);
-         p = DATA(a) + (sa-1);
-         num = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sa > 1)
-            num += DBL(*(--p));
-         num *= NTL_ZZ_FRADIX;
-         if (sa > 2)
-            num += DBL(*(p - 1));
-
-         sn = SIZE(n);
-         p = DATA(n) + (sn-1);
-         den = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sn > 1)
-            den += DBL(*(--p));
-         den *= NTL_ZZ_FRADIX;
-         if (sn > 2)
-            den += DBL(*(p - 1));
-
-         hi = fhi1 * (num + double(1L)) / den;
-         lo = flo1 * num / (den + double(1L));
-         if (diff > 0)
-         {
-            hi *= NTL_ZZ_FRADIX;
-            lo *= NTL_ZZ_FRADIX;
-         }
-         try11 = 1;
-         try12 = 0;
-         try21 = 0;
-         try22 = 1;
-         parity = 1;
-         fast = 1; 
-         while (fast > 0)
-         {
-            parity = 1 - parity;
-            if (hi >= NTL_NSP_BOUND)
-               fast = 0;
-            else
-            {
-               ilo = (long)lo;
-               dirt = hi - double(ilo);
-               if (dirt < 1.0/NTL_FDOUBLE_PRECISION || !ilo || ilo < (long)hi)
-                  fast = 0;
-               else
-               {
-                  dt = lo-double(ilo);
-                  lo = flo / dirt;
-                  if (dt > 1.0/NTL_FDOUBLE_PRECISION)
-                     hi = fhi / dt;
-                  else
-                     hi = double(NTL_NSP_BOUND);
-                  temp = try11;
-                  try11 = try21;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try21)
-                     fast = 0;
-                  else
-                     try21 = temp + ilo * try21;
-                  temp = try12;
-                  try12 = try22;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try22)
-                     fast = 0;
-                  else
-                     try22 = temp + ilo * try22;
-                  if ((fast > 0) && (parity > 0))
-                  {
-                     gotthem = 1;
-                     got11 = try11;
-                     got12 = try12;
-                     got21 = try21;
-                     got22 = try22;
-                  }
-               }
-            }
-         }
-      }
-      if (gotthem)
+   _ntl_gsetlength(&y, e);
+   _ntl_gsetlength(&z, e);
+   _ntl_gsetlength(&inv, e);
+
+   _ntl_gcopy(ain, &a);
+   _ntl_gcopy(nin, &n);
+
+   _ntl_gone(&inv);
+   _ntl_gzero(&w);
+
+   while (SIZE(n) > 0)
+   {
+      if (lehmer_step(a, n, g))
       {
-         _ntl_gsmul(inv, got11, &x);
-         _ntl_gsmul(w, got12, &y);
-         _ntl_gsmul(inv, got21, &z);
-         _ntl_gsmul(w, got22, &w);
+         _ntl_gsmul(inv, g[0], &x);
+         _ntl_gsmul(w, g[1], &y);
+         _ntl_gsmul(inv, g[2], &z);
+         _ntl_gsmul(w, g[3], &w);
          _ntl_gadd(x, y, &inv);
          _ntl_gadd(z, w, &w);
-         _ntl_gsmul(a, got11, &x);
-         _ntl_gsmul(n, got12, &y);
-         _ntl_gsmul(a, got21, &z);
-         _ntl_gsmul(n, got22, &n);
+         _ntl_gsmul(a, g[0], &x);
+         _ntl_gsmul(n, g[1], &y);
+         _ntl_gsmul(a, g[2], &z);
+         _ntl_gsmul(n, g[3], &n);
          _ntl_gsub(x, y, &a);
          _ntl_gsub(n, z, &n);
       }
@@ -5045,26 +7385,14 @@ _ntl_gxxratrecon(
    long sden;
    long e;
    long fast;
-   long temp;
-   long parity;
-   long gotthem;
-   long try11;
-   long try12;
-   long try21;
-   long try22;
-   long got11;
-   long got12;
-   long got21;
-   long got22;
+   long g[4];
 
    double hi;
    double lo;
-   double dt;
-   double fhi, fhi1;
-   double flo, flo1;
+   double fhi1;
+   double flo1;
    double num;
    double den;
-   double dirt;
 
    if (_ntl_gsign(num_bound) < 0)
       LogicError("rational reconstruction: bad numerator bound");
@@ -5105,9 +7433,6 @@ _ntl_gxxratrecon(
    fhi1 = double(1L) + double(32L)/NTL_FDOUBLE_PRECISION;
    flo1 = double(1L) - double(32L)/NTL_FDOUBLE_PRECISION;
 
-   fhi = double(1L) + double(8L)/NTL_FDOUBLE_PRECISION;
-   flo = double(1L) - double(8L)/NTL_FDOUBLE_PRECISION;
-
    _ntl_gcopy(ain, &a);
    _ntl_gcopy(nin, &n);
 
@@ -5124,99 +7449,18 @@ _ntl_gxxratrecon(
       _ntl_gcopy(w, &w_bak);
       _ntl_gcopy(inv, &inv_bak);
 
-      gotthem = 0;
-      sa = SIZE(a);
-      sn = SIZE(n);
-      diff = sa - sn;
-      if (!diff || diff == 1)
-      {
-         sa = SIZE(a);
-         p = DATA(a) + (sa-1);
-         num = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sa > 1)
-            num += DBL(*(--p));
-         num *= NTL_ZZ_FRADIX;
-         if (sa > 2)
-            num += DBL(*(p - 1));
-
-         sn = SIZE(n);
-         p = DATA(n) + (sn-1);
-         den = DBL(*p) * NTL_ZZ_FRADIX;
-         if (sn > 1)
-            den += DBL(*(--p));
-         den *= NTL_ZZ_FRADIX;
-         if (sn > 2)
-            den += DBL(*(p - 1));
-
-         hi = fhi1 * (num + double(1L)) / den;
-         lo = flo1 * num / (den + double(1L));
-         if (diff > 0)
-         {
-            hi *= NTL_ZZ_FRADIX;
-            lo *= NTL_ZZ_FRADIX;
-         }
-
-         try11 = 1;
-         try12 = 0;
-         try21 = 0;
-         try22 = 1;
-         parity = 1;
-         fast = 1; 
-         while (fast > 0)
-         {
-            parity = 1 - parity;
-            if (hi >= NTL_NSP_BOUND)
-               fast = 0;
-            else
-            {
-               ilo = (long)lo;
-               dirt = hi - double(ilo);
-               if (dirt < 1.0/NTL_FDOUBLE_PRECISION || !ilo || ilo < (long)hi)
-                  fast = 0;
-               else
-               {
-                  dt = lo-double(ilo);
-                  lo = flo / dirt;
-                  if (dt > 1.0/NTL_FDOUBLE_PRECISION)
-                     hi = fhi / dt;
-                  else
-                     hi = double(NTL_NSP_BOUND);
-                  temp = try11;
-                  try11 = try21;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try21)
-                     fast = 0;
-                  else
-                     try21 = temp + ilo * try21;
-                  temp = try12;
-                  try12 = try22;
-                  if ((NTL_WSP_BOUND - temp) / ilo < try22)
-                     fast = 0;
-                  else
-                     try22 = temp + ilo * try22;
-                  if ((fast > 0) && (parity > 0))
-                  {
-                     gotthem = 1;
-                     got11 = try11;
-                     got12 = try12;
-                     got21 = try21;
-                     got22 = try22;
-                  }
-               }
-            }
-         }
-      }
-      if (gotthem)
+      if (lehmer_step(a, n, g))
       {
-         _ntl_gsmul(inv, got11, &x);
-         _ntl_gsmul(w, got12, &y);
-         _ntl_gsmul(inv, got21, &z);
-         _ntl_gsmul(w, got22, &w);
+         _ntl_gsmul(inv, g[0], &x);
+         _ntl_gsmul(w, g[1], &y);
+         _ntl_gsmul(inv, g[2], &z);
+         _ntl_gsmul(w, g[3], &w);
          _ntl_gadd(x, y, &inv);
          _ntl_gadd(z, w, &w);
-         _ntl_gsmul(a, got11, &x);
-         _ntl_gsmul(n, got12, &y);
-         _ntl_gsmul(a, got21, &z);
-         _ntl_gsmul(n, got22, &n);
+         _ntl_gsmul(a, g[0], &x);
+         _ntl_gsmul(n, g[1], &y);
+         _ntl_gsmul(a, g[2], &z);
+         _ntl_gsmul(n, g[3], &n);
          _ntl_gsub(x, y, &a);
          _ntl_gsub(n, z, &n);
       }
@@ -5656,6 +7900,458 @@ _ntl_reduce_struct_build(_ntl_gbigint modulus, _ntl_gbigint excess)
 }
 
 
+// Special-form moduli N = k*2^n + c, with 1 <= k < NTL_SP_BOUND,
+// 0 < |c| < NTL_SP_BOUND, and c = N mod RADIX (up to sign).  These
+// include Mersenne numbers 2^p-1, pseudo-Mersenne numbers 2^n-c, and
+// Proth and Riesel numbers k*2^n+1 and k*2^n-1.  Since k*2^n = -c 
+// mod N, writing x = (q1*k + q0)*2^n + r gives x = q0*2^n + r - c*q1
+// mod N, which reduces x by about n bits using only linear-time
+// operations.
+
+// moduli with fewer limbs than SPECIALX are left to Montgomery
+// reduction; for k > 1, each reduction step also divides by k, and
+// the crossover is at SPECIALKX limbs
+#define SPECIALX (4)
+#define SPECIALKX (24)
+
+struct special_form {
+   long k, n, c;
+};
+
+// returns true if F has the special form, and sets sf
+static bool
+special_form_detect(_ntl_gbigint F, special_form& sf)
+{
+   long sF = SIZE(F);
+   if (sF < SPECIALX) return false;
+
+   const _ntl_limb_t *Fdata = DATA(F);
+   if (Fdata[0] == 0) return false;
+
+   // as F has at least SPECIALX limbs and k < NTL_SP_BOUND, the
+   // second limb lies below bit n, and is 0 if c > 0, or all ones
+   // if c < 0;  this rejects almost all other moduli in constant time
+   if (Fdata[1] != 0 && Fdata[1] != NTL_ZZ_RADIX-1) return false;
+
+   GRegister(G);
+   bool found = false;
+   long kbits = 0;
+
+   for (long neg = 0; neg <= 1; neg++) {
+      // G = F - c, where c is Fdata[0] or Fdata[0] - RADIX,
+      // so that the low limb of G is zero
+
+      _ntl_limb_t d = neg ? NTL_ZZ_RADIX - Fdata[0] : Fdata[0];
+      if (d >= _ntl_limb_t(NTL_SP_BOUND)) continue;
+
+      if (neg)
+         _ntl_gsadd(F, long(d), &G);
+      else
+         _ntl_gsadd(F, -long(d), &G);
+
+      long n = _ntl_gnumtwos(G);
+      _ntl_grshift(G, n, &G);
+      if (_ntl_g2log(G) > NTL_SP_NBITS) continue;
+
+      long bits = _ntl_g2log(G) + _ntl_g2logs(long(d));
+      if (!found || bits < kbits) {
+         sf.k = _ntl_gtoint(G);
+         sf.n = n;
+         sf.c = neg ? -long(d) : long(d);
+         kbits = bits;
+         found = true;
+      }
+   }
+
+   if (found && sf.k != 1 && sF < SPECIALKX) found = false;
+
+   return found;
+}
+
+// x = a mod F, for any a, where F has the special form sf
+static void
+special_form_rem(_ntl_gbigint *xx, _ntl_gbigint a, _ntl_gbigint F,
+                 const special_form& sf)
+{
+   GRegister(x);
+   GRegister(q);
+   GRegister(t);
+
+   // x = +/- a, and neg records the sign
+   long neg = _ntl_gsign(a) < 0;
+   _ntl_gcopy(a, &x);
+   if (neg) _ntl_gnegate(&x);
+
+   for (;;) {
+      _ntl_grshift(x, sf.n, &q);
+      if (_ntl_gscompare(q, sf.k) < 0) break;
+
+      _ntl_glowbits(x, sf.n, &x);
+
+      // q = q1*k + q0, and x = r + q0*2^n
+      if (sf.k != 1) {
+         long q0 = _ntl_gsdiv(q, sf.k, &q);
+         if (q0) {
+            _ntl_gintoz(q0, &t);
+            _ntl_glshift(t, sf.n, &t);
+            _ntl_gadd(x, t, &x);
+         }
+      }
+
+      // x = x - c*q1
+      if (sf.c != 1 && sf.c != -1) _ntl_gsmul(q, labs(sf.c), &q);
+
+      if (sf.c < 0)
+         _ntl_gadd(x, q, &x);
+      else {
+         _ntl_gsub(x, q, &x);
+         if (_ntl_gsign(x) < 0) {
+            _ntl_gnegate(&x);
+            neg = !neg;
+         }
+      }
+   }
+
+   // now 0 <= x < k*2^n < 2*F
+   if (_ntl_gcompare(x, F) >= 0) _ntl_gsubpos(x, F, &x);
+   if (neg && !ZEROP(x)) _ntl_gsubpos(F, x, &x);
+
+   _ntl_gcopy(x, xx);
+}
+
+
+// h = g^e mod F, for F of the special form sf, 0 < g < F, e > 1;
+// this is the sliding-window algorithm of _ntl_gpowermod below
+
+static void
+special_form_powermod(_ntl_gbigint g, _ntl_gbigint e, _ntl_gbigint F,
+                      const special_form& sf, _ntl_gbigint *h)
+{
+   long n = _ntl_g2log(e);
+   long k = OptWinSize(n);
+   if (k > 5) k = 5;
+
+   _ntl_gbigint_wrapped res, t;
+   UniqueArray<_ntl_gbigint_wrapped> v;
+
+   v.SetLength(1L << (k-1));
+   _ntl_gcopy(g, &v[0]);
+
+   if (k > 1) {
+      _ntl_gsq(g, &t);
+      special_form_rem(&res, t, F, sf);
+
+      for (long i = 1; i < (1L << (k-1)); i++) {
+         _ntl_gmul(v[i-1], res, &t);
+         special_form_rem(&v[i], t, F, sf);
+      }
+   }
+
+   _ntl_gcopy(g, &res);
+
+   long val = 0;
+   for (long i = n-2; i >= 0; i--) {
+      val = (val << 1) | _ntl_gbit(e, i);
+      if (val == 0) {
+         _ntl_gsq(res, &t);
+         special_form_rem(&res, t, F, sf);
+      }
+      else if (val >= (1L << (k-1)) || i == 0) {
+         long cnt = 0;
+         while ((val & 1) == 0) {
+            val = val >> 1;
+            cnt++;
+         }
+
+         long m = val;
+         while (m > 0) {
+            _ntl_gsq(res, &t);
+            special_form_rem(&res, t, F, sf);
+            m = m >> 1;
+         }
+
+         _ntl_gmul(res, v[val >> 1], &t);
+         special_form_rem(&res, t, F, sf);
+
+         while (cnt > 0) {
+            _ntl_gsq(res, &t);
+            special_form_rem(&res, t, F, sf);
+            cnt--;
+         }
+
+         val = 0;
+      }
+   }
+
+   _ntl_gcopy(res, h);
+}
+
+
+// Reduction by a fixed modulus, for external consumption.
+// Barrett reduction works for any modulus, and uses the precomputed 
+// value mu = floor(RADIX^{2k}/N), where N has k limbs.  Montgomery 
+// arithmetic (with R = RADIX^k) is available for odd moduli; for large
+// k, Montgomery reduction is done with two multiplications, using
+// the precomputed value Ninv = -1/N mod R.
+
+// for moduli with between BARRETTX1 and BARRETTX2 limbs, plain division
+// is a bit faster than Barrett reduction (as it only needs about one
+// multiplication's worth of work at these sizes)
+#define BARRETTX1 (24)
+#define BARRETTX2 (256)
+
+// below this many limbs, word-by-word Montgomery reduction is used
+#define REDCX (96)
+
+class _ntl_reducer_struct_impl : public _ntl_reducer_struct {
+public:
+   long k;
+   _ntl_gbigint_wrapped N;
+   _ntl_gbigint_wrapped mu;
+
+   bool mont;
+   _ntl_gbigint_wrapped R2;   // R^2 mod N
+   UniqueArray<_ntl_limb_t> Ninv;
+   _ntl_reduce_struct_montgomery mont_struct;
+
+   bool special;
+   special_form sf;
+
+   void barrett(_ntl_gbigint *x, _ntl_gbigint a);
+   void redc(_ntl_gbigint *x, _ntl_gbigint *T);
+
+   void rem(_ntl_gbigint *x, _ntl_gbigint a);
+   void mulmod(_ntl_gbigint *x, _ntl_gbigint a, _ntl_gbigint b);
+   void sqrmod(_ntl_gbigint *x, _ntl_gbigint a);
+
+   bool montgomery() { return mont; }
+   void to_mont(_ntl_gbigint *x, _ntl_gbigint a);
+   void from_mont(_ntl_gbigint *x, _ntl_gbigint a);
+   void mulmont(_ntl_gbigint *x, _ntl_gbigint a, _ntl_gbigint b);
+   void sqrmont(_ntl_gbigint *x, _ntl_gbigint a);
+};
+
+
+// assumes 0 <= a < RADIX^{2k}
+void _ntl_reducer_struct_impl::barrett(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   if (_ntl_gcompare(a, N) < 0) {
+      _ntl_gcopy(a, x);
+      return;
+   }
+
+   if (k >= BARRETTX1 && k < BARRETTX2) {
+      _ntl_gmod(a, N, x);
+      return;
+   }
+
+   GRegister(t);
+   GRegister(r);
+
+   long sa = SIZE(a);
+   long s1 = sa - (k-1);
+   long smu = SIZE(mu);
+
+   _ntl_gsetlength(&t, s1 + smu);
+   _ntl_gsetlength(&r, 2*k + 2);
+
+   const _ntl_limb_t *adata = DATA(a);
+   const _ntl_limb_t *Ndata = DATA(N);
+   _ntl_limb_t *tdata = DATA(t);
+   _ntl_limb_t *rdata = DATA(r);
+
+   // q = floor(floor(a/RADIX^{k-1})*mu/RADIX^{k+1}),
+   // which is too small by at most 2
+
+   if (s1 >= smu)
+      NTL_MPN(mul)(tdata, adata+k-1, s1, DATA(mu), smu);
+   else
+      NTL_MPN(mul)(tdata, DATA(mu), smu, adata+k-1, s1);
+
+   _ntl_limb_t *q = tdata + (k+1);
+   long sq = s1 + smu - (k+1);
+   STRIP(sq, q);
+
+   // r = a - q*N, computed mod RADIX^{k+1}
+
+   if (sq == 0) {
+      for (long i = 0; i <= k; i++) rdata[i] = 0;
+   }
+   else if (sq <= k) 
+      NTL_MPN(mul)(rdata, Ndata, k, q, sq);
+   else
+      NTL_MPN(mul)(rdata, q, sq, Ndata, k);
+
+   _ntl_limb_t borrow = NTL_MPN(sub_n)(rdata, adata, rdata, min(sa, k+1));
+   if (sa < k+1) rdata[k] = CLIP(-rdata[k] - borrow);
+
+   while (rdata[k] || NTL_MPN(cmp)(rdata, Ndata, k) >= 0)
+      rdata[k] -= NTL_MPN(sub_n)(rdata, rdata, Ndata, k);
+
+   long sr = k;
+   STRIP(sr, rdata);
+   SIZE(r) = sr;
+   _ntl_gcopy(r, x);
+}
+
+// computes x = T/R mod N, assuming 0 <= T < N*R;
+// T is destroyed
+void _ntl_reducer_struct_impl::redc(_ntl_gbigint *x, _ntl_gbigint *TT)
+{
+   if (k < REDCX) {
+      mont_struct.eval(x, TT);
+      return;
+   }
+
+   _ntl_gbigint T = *TT;
+   if (ZEROP(T)) {
+      _ntl_gzero(x);
+      return;
+   }
+
+   GRegister(t);
+   GRegister(q);
+
+   _ntl_gsetlength(&t, 2*k);
+   _ntl_gsetlength(&q, 2*k);
+
+   long sT = SIZE(T);
+   const _ntl_limb_t *Tdata = DATA(T);
+   const _ntl_limb_t *Ndata = DATA(N);
+   _ntl_limb_t *tdata = DATA(t);
+   _ntl_limb_t *qdata = DATA(q);
+
+   // q = T*Ninv mod R
+   NTL_MPN(mul)(qdata, Ninv.get(), k, Tdata, min(sT, k));
+
+   // t = (T + q*N)/R, which is less than 2*N
+   NTL_MPN(mul)(tdata, Ndata, k, qdata, k);
+   _ntl_limb_t c = NTL_MPN(add)(tdata, tdata, 2*k, Tdata, sT);
+
+   if (c || NTL_MPN(cmp)(tdata+k, Ndata, k) >= 0)
+      NTL_MPN(sub_n)(tdata, tdata+k, Ndata, k);
+   else
+      for (long i = 0; i < k; i++) tdata[i] = tdata[i+k];
+
+   long st = k;
+   STRIP(st, tdata);
+   SIZE(t) = st;
+   _ntl_gcopy(t, x);
+}
+
+void _ntl_reducer_struct_impl::rem(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   if (special)
+      special_form_rem(x, a, N, sf);
+   else if (_ntl_gsign(a) < 0 || _ntl_gsize(a) > 2*k) 
+      _ntl_gmod(a, N, x);
+   else
+      barrett(x, a);
+}
+
+void _ntl_reducer_struct_impl::mulmod(_ntl_gbigint *x, _ntl_gbigint a, 
+                                      _ntl_gbigint b)
+{
+   GRegister(t);
+   _ntl_gmul(a, b, &t);
+   rem(x, t);
+}
+
+void _ntl_reducer_struct_impl::sqrmod(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   GRegister(t);
+   _ntl_gsq(a, &t);
+   rem(x, t);
+}
+
+void _ntl_reducer_struct_impl::to_mont(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   if (!mont)
+      LogicError("ZZReducer: Montgomery arithmetic requires an odd modulus");
+
+   GRegister(t);
+   rem(&t, a);
+   _ntl_gmul(t, R2, &t);
+   redc(x, &t);
+}
+
+void _ntl_reducer_struct_impl::from_mont(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   if (!mont)
+      LogicError("ZZReducer: Montgomery arithmetic requires an odd modulus");
+
+   GRegister(t);
+   _ntl_gcopy(a, &t);
+   redc(x, &t);
+}
+
+void _ntl_reducer_struct_impl::mulmont(_ntl_gbigint *x, _ntl_gbigint a, 
+                                       _ntl_gbigint b)
+{
+   if (!mont)
+      LogicError("ZZReducer: Montgomery arithmetic requires an odd modulus");
+
+   GRegister(t);
+   _ntl_gmul(a, b, &t);
+   redc(x, &t);
+}
+
+void _ntl_reducer_struct_impl::sqrmont(_ntl_gbigint *x, _ntl_gbigint a)
+{
+   if (!mont)
+      LogicError("ZZReducer: Montgomery arithmetic requires an odd modulus");
+
+   GRegister(t);
+   _ntl_gsq(a, &t);
+   redc(x, &t);
+}
+
+
+// assumes modulus > 1
+
+_ntl_reducer_struct *
+_ntl_reducer_struct_build(_ntl_gbigint modulus)
+{
+   UniquePtr<_ntl_reducer_struct_impl> C;
+   C.make();
+
+   long k = _ntl_gsize(modulus);
+   C->k = k;
+   _ntl_gcopy(modulus, &C->N);
+
+   _ntl_gbigint_wrapped t;
+   _ntl_gone(&t);
+   _ntl_glshift(t, 2*k*NTL_ZZ_NBITS, &t);
+   _ntl_gdiv(t, modulus, &C->mu, 0);
+
+   C->special = special_form_detect(modulus, C->sf);
+
+   C->mont = _ntl_godd(modulus);
+   if (C->mont) {
+      _ntl_gmod(t, modulus, &C->R2);
+      C->mont_struct.m = k;
+      C->mont_struct.inv = neg_inv_mod_limb(DATA(modulus)[0]);
+      _ntl_gcopy(modulus, &C->mont_struct.N);
+
+      if (k >= REDCX) {
+         // Ninv = R - (1/N mod R)
+         _ntl_gbigint_wrapped R, inv;
+         _ntl_gone(&R);
+         _ntl_glshift(R, k*NTL_ZZ_NBITS, &R);
+         _ntl_ginv(modulus, R, &inv);
+         _ntl_gsub(R, inv, &inv);
+
+         C->Ninv.SetLength(k);
+         long sinv = SIZE(inv);
+         for (long i = 0; i < k; i++) 
+            C->Ninv[i] = (i < sinv) ? DATA(inv)[i] : 0;
+      }
+   }
+
+   return C.release();
+}
+
+
 #if (defined(NTL_GMP_LIP) && NTL_NAIL_BITS == 0)
 // DIRT: only works with empty nails
 // Assumes: F > 1,   0 < g < F,   e > 0
@@ -5773,6 +8469,12 @@ void _ntl_gpowermod(_ntl_gbigint g, _ntl_gbigint e, _ntl_gbigint F,
       return;
    }
 
+   special_form sf;
+   if (special_form_detect(F, sf)) {
+      special_form_powermod(g, e, F, sf, h);
+      return;
+   }
+
    long n = _ntl_g2log(e);
 
 #if (1 && defined(NTL_GMP_LIP) && NTL_NAIL_BITS == 0)
@@ -49,16 +49,22 @@ void mul_aux(mat_ZZ& X, const mat_ZZ& A, const mat_ZZ& B)
    X.SetDims(n, m);  
   
    long i, j, k;  
-   ZZ acc, tmp;  
   
-   for (i = 1; i <= n; i++) {  
-      for (j = 1; j <= m; j++) {  
-         clear(acc);  
-         for(k = 1; k <= l; k++) {  
-            mul(tmp, A(i,k), B(k,j));  
-            add(acc, acc, tmp);  
-         }  
-         X(i,j) = acc;  
+   // row i of X accumulates A(i,k) times row k of B, so that B is
+   // read along its rows, and zero entries of A are skipped
+
+   for (i = 0; i < n; i++) {  
+      ZZ *x = X[i].elts();
+      for (j = 0; j < m; j++)
+         clear(x[j]);
+
+      for (k = 0; k < l; k++) {  
+         const ZZ& a = A[i][k];
+         if (IsZero(a)) continue;
+
+         const ZZ *b = B[k].elts();
+         for (j = 0; j < m; j++)  
+            MulAddTo(x[j], a, b[j]);  
       }  
    }  
 }  
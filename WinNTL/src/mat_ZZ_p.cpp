@@ -1495,7 +1495,17 @@ void power(mat_ZZ_p& X, const mat_ZZ_p& A, const ZZ& e)
 void random(mat_ZZ_p& x, long n, long m)
 {
    x.SetDims(n, m);
-   for (long i = 0; i < n; i++) random(x[i], m);
+
+   // one call to VectorRandomBnd for the whole matrix, so that
+   // large matrices are generated in parallel
+
+   Vec<ZZ*> xp;
+   xp.SetLength(n*m);
+
+   for (long i = 0; i < n; i++)
+      for (long j = 0; j < m; j++) xp[i*m+j] = &x[i][j].LoopHole();
+
+   VectorRandomBnd(n*m, xp.elts(), ZZ_p::modulus());
 }
 
 NTL_END_IMPL
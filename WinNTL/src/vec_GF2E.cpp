@@ -1,5 +1,7 @@
 
 #include <NTL/vec_GF2E.h>
+#include <NTL/BasicThreadPool.h>
+#include <NTL/BatchInv_impl.h>
 
 
 NTL_START_IMPL
@@ -229,4 +231,37 @@ void random(vec_GF2E& x, long n)
 }
 
 
+// Batch inversion:  see BatchInv_impl.h
+
+#define BATCHINV_PAR_THRESH (4000.0)
+
+struct GF2EBatchInvContext {
+   GF2Context GF2_context;
+   GF2EContext GF2E_context;
+
+   void save() { GF2_context.save(); GF2E_context.save(); }
+   void restore() const { GF2_context.restore(); GF2E_context.restore(); }
+};
+
+static
+bool BatchInvBelowThresh(long n)
+{
+   double sz = GF2E::WordLength();
+   return double(n)*sz*sz < BATCHINV_PAR_THRESH;
+}
+
+void BatchInv(vec_GF2E& x, const vec_GF2E& a)
+{
+   bool seq = BatchInvBelowThresh(a.length());
+   BatchInvAux<GF2E, GF2EBatchInvContext>(x, 0, a, seq);
+}
+
+void BatchInv(vec_GF2E& x, Vec<long>& status, const vec_GF2E& a)
+{
+   status.SetLength(a.length());
+   bool seq = BatchInvBelowThresh(a.length());
+   BatchInvAux<GF2E, GF2EBatchInvContext>(x, status.elts(), a, seq);
+}
+
+
 NTL_END_IMPL
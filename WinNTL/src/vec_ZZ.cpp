@@ -1,5 +1,6 @@
 
 #include <NTL/vec_ZZ.h>
+#include <NTL/BasicThreadPool.h>
 
 NTL_START_IMPL
 
@@ -141,4 +142,226 @@ void VectorCopy(vec_ZZ& x, const vec_ZZ& a, long n)
 }
 
 
+/**********************************************************************
+
+   Simultaneous multi-exponentiation
+
+   All the bases share one chain of squarings.  For few bases, each
+   base gets a table of its first 2^w-1 powers, and the exponents are
+   scanned w bits at a time (Straus).  For many bases, the bases are
+   sorted into 2^c-1 buckets by their c-bit digit in each window, and
+   the buckets are combined with running products (Pippenger).  The
+   choice is made by comparing the multiplication counts.  The 
+   arithmetic is done in Montgomery form if n is odd.
+
+**********************************************************************/
+
+static
+void MultiPowerStraus(ZZ& res, const ZZReducer& red, const vec_ZZ& b,
+                      const vec_ZZ& e, long nbits, long w)
+{
+   long m = b.length();
+   long tsz = (1L << w) - 1;
+
+   // tab[i*tsz+d-1] = b[i]^d
+
+   vec_ZZ tab;
+   tab.SetLength(m*tsz);
+
+   NTL_EXEC_RANGE(m, first, last)
+
+      for (long i = first; i < last; i++) {
+         tab[i*tsz] = b[i];
+         for (long d = 2; d <= tsz; d++)
+            red.mul(tab[i*tsz+d-1], tab[i*tsz+d-2], b[i]);
+      }
+
+   NTL_EXEC_RANGE_END
+
+   long nwin = (nbits + w - 1)/w;
+   bool empty = true;
+
+   for (long j = nwin-1; j >= 0; j--) {
+      if (!empty) {
+         for (long k = 0; k < w; k++)
+            red.sqr(res, res);
+      }
+
+      for (long i = 0; i < m; i++) {
+         long d = bits(e[i], j*w, w);
+         if (d == 0) continue;
+
+         if (empty) {
+            res = tab[i*tsz+d-1];
+            empty = false;
+         }
+         else
+            red.mul(res, res, tab[i*tsz+d-1]);
+      }
+   }
+}
+
+static
+void MultiPowerPippenger(ZZ& res, const ZZReducer& red, const vec_ZZ& b,
+                         const vec_ZZ& e, long nbits, long c)
+{
+   long m = b.length();
+   long nbkt = (1L << c) - 1;
+   long nwin = (nbits + c - 1)/c;
+
+   // acc[j] = prod_i b[i]^(digit j of e[i]), for each window j; 
+   // the windows are independent, and are done in parallel
+
+   vec_ZZ acc;
+   acc.SetLength(nwin);
+   Vec<char> acc_set;
+   acc_set.SetLength(nwin);
+
+   NTL_EXEC_RANGE(nwin, first, last)
+
+      vec_ZZ bkt;
+      bkt.SetLength(nbkt);
+      Vec<char> bkt_set;
+      bkt_set.SetLength(nbkt);
+      ZZ run;
+
+      for (long j = first; j < last; j++) {
+         for (long d = 0; d < nbkt; d++) bkt_set[d] = 0;
+
+         for (long i = 0; i < m; i++) {
+            long d = bits(e[i], j*c, c);
+            if (d == 0) continue;
+
+            if (bkt_set[d-1])
+               red.mul(bkt[d-1], bkt[d-1], b[i]);
+            else {
+               bkt[d-1] = b[i];
+               bkt_set[d-1] = 1;
+            }
+         }
+
+         // prod_d bkt[d]^d = prod_d (prod_{d' >= d} bkt[d'])
+
+         bool run_set = false;
+         acc_set[j] = 0;
+
+         for (long d = nbkt; d >= 1; d--) {
+            if (bkt_set[d-1]) {
+               if (run_set)
+                  red.mul(run, run, bkt[d-1]);
+               else {
+                  run = bkt[d-1];
+                  run_set = true;
+               }
+            }
+
+            if (run_set) {
+               if (acc_set[j])
+                  red.mul(acc[j], acc[j], run);
+               else {
+                  acc[j] = run;
+                  acc_set[j] = 1;
+               }
+            }
+         }
+      }
+
+   NTL_EXEC_RANGE_END
+
+   bool empty = true;
+
+   for (long j = nwin-1; j >= 0; j--) {
+      if (!empty) {
+         for (long k = 0; k < c; k++)
+            red.sqr(res, res);
+      }
+
+      if (acc_set[j]) {
+         if (empty) {
+            res = acc[j];
+            empty = false;
+         }
+         else
+            red.mul(res, res, acc[j]);
+      }
+   }
+}
+
+
+void MultiPowerMod(ZZ& x, const vec_ZZ& g, const vec_ZZ& e, const ZZ& n)
+{
+   long k = g.length();
+
+   if (e.length() != k) LogicError("MultiPowerMod: length mismatch");
+   if (n <= 1) LogicError("MultiPowerMod: modulus must be > 1");
+
+   ZZReducer red(n);
+
+   // bases (in Montgomery form if n is odd) and exponents, 
+   // with negative exponents turned into inverses and zero ones dropped
+
+   vec_ZZ b, ee;
+   b.SetLength(k);
+   ee.SetLength(k);
+
+   long m = 0, nbits = 0;
+   ZZ t;
+
+   for (long i = 0; i < k; i++) {
+      if (IsZero(e[i])) continue;
+
+      rem(t, g[i], n);
+      if (sign(e[i]) < 0) InvMod(t, t, n);
+
+      red.ToRep(b[m], t);
+
+      abs(ee[m], e[i]);
+      nbits = max(nbits, NumBits(ee[m]));
+      m++;
+   }
+
+   if (m == 0) {
+      set(x);
+      return;
+   }
+
+   b.SetLength(m);
+   ee.SetLength(m);
+
+   // multiplication counts:  Straus with w-bit windows takes about
+   // m*(2^w-2) + nbits*m/w, Pippenger with c-bit windows about
+   // (nbits/c)*(m + 2^(c+1)), both besides nbits squarings
+
+   long w = 1, c = 1;
+   double straus_cost = 0, pippenger_cost = 0;
+
+   for (long w1 = 1; w1 <= 6; w1++) {
+      double cost = double(m)*double((1L << w1)-2) + double(nbits)*double(m)/w1;
+      if (w1 == 1 || cost < straus_cost) {
+         straus_cost = cost;
+         w = w1;
+      }
+   }
+
+   for (long c1 = 1; c1 <= 16; c1++) {
+      double cost = (double(nbits)/c1)*(double(m) + double(1L << (c1+1)));
+      if (c1 == 1 || cost < pippenger_cost) {
+         pippenger_cost = cost;
+         c = c1;
+      }
+   }
+
+   NTL_ZZRegister(res);
+
+   if (straus_cost <= pippenger_cost)
+      MultiPowerStraus(res, red, b, ee, nbits, w);
+   else
+      MultiPowerPippenger(res, red, b, ee, nbits, c);
+
+   red.FromRep(res, res);
+
+   x = res;
+}
+
+
 NTL_END_IMPL
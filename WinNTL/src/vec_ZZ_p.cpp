@@ -2,6 +2,7 @@
 
 #include <NTL/vec_ZZ_p.h>
 #include <NTL/BasicThreadPool.h>
+#include <NTL/BatchInv_impl.h>
 
 
 NTL_START_IMPL
@@ -257,7 +258,7 @@ void VectorCopy(vec_ZZ_p& x, const vec_ZZ_p& a, long n)
 void random(vec_ZZ_p& x, long n)
 {
    x.SetLength(n);
-   for (long i = 0; i < n; i++) random(x[i]);
+   VectorRandom(n, x.elts());
 }
 
 // thread-boosted conversion.
@@ -291,4 +292,21 @@ void conv(vec_ZZ_p& x, const vec_ZZ& a)
 
 }
 
+
+// Batch inversion:  see BatchInv_impl.h
+
+void BatchInv(vec_ZZ_p& x, const vec_ZZ_p& a)
+{
+   bool seq = BelowThresh(a.length());
+   BatchInvAux<ZZ_p, ZZ_pContext>(x, 0, a, seq);
+}
+
+void BatchInv(vec_ZZ_p& x, Vec<long>& status, const vec_ZZ_p& a)
+{
+   status.SetLength(a.length());
+   bool seq = BelowThresh(a.length());
+   BatchInvAux<ZZ_p, ZZ_pContext>(x, status.elts(), a, seq);
+}
+
+
 NTL_END_IMPL
@@ -1,5 +1,7 @@
 
 #include <NTL/vec_ZZ_pE.h>
+#include <NTL/BasicThreadPool.h>
+#include <NTL/BatchInv_impl.h>
 
 
 NTL_START_IMPL
@@ -181,4 +183,37 @@ void random(vec_ZZ_pE& x, long n)
 }
 
 
+// Batch inversion:  see BatchInv_impl.h
+
+#define BATCHINV_PAR_THRESH (4000.0)
+
+struct ZZ_pEBatchInvContext {
+   ZZ_pContext ZZ_p_context;
+   ZZ_pEContext ZZ_pE_context;
+
+   void save() { ZZ_p_context.save(); ZZ_pE_context.save(); }
+   void restore() const { ZZ_p_context.restore(); ZZ_pE_context.restore(); }
+};
+
+static
+bool BatchInvBelowThresh(long n)
+{
+   double sz = double(deg(ZZ_pE::modulus()))*double(ZZ_p::ModulusSize());
+   return double(n)*sz*sz < BATCHINV_PAR_THRESH;
+}
+
+void BatchInv(vec_ZZ_pE& x, const vec_ZZ_pE& a)
+{
+   bool seq = BatchInvBelowThresh(a.length());
+   BatchInvAux<ZZ_pE, ZZ_pEBatchInvContext>(x, 0, a, seq);
+}
+
+void BatchInv(vec_ZZ_pE& x, Vec<long>& status, const vec_ZZ_pE& a)
+{
+   status.SetLength(a.length());
+   bool seq = BatchInvBelowThresh(a.length());
+   BatchInvAux<ZZ_pE, ZZ_pEBatchInvContext>(x, status.elts(), a, seq);
+}
+
+
 NTL_END_IMPL
@@ -1,5 +1,7 @@
 
 #include <NTL/vec_lzz_p.h>
+#include <NTL/BasicThreadPool.h>
+#include <NTL/BatchInv_impl.h>
 
 NTL_START_IMPL
 
@@ -320,4 +322,24 @@ void random(vec_zz_p& x, long n)
    VectorRandom(n, x.elts());
 }
 
+
+// Batch inversion:  see BatchInv_impl.h;  the parallel version 
+// only pays off for quite long vectors
+
+#define BATCHINV_PAR_THRESH (20000)
+
+void BatchInv(vec_zz_p& x, const vec_zz_p& a)
+{
+   bool seq = a.length() < BATCHINV_PAR_THRESH;
+   BatchInvAux<zz_p, zz_pContext>(x, 0, a, seq);
+}
+
+void BatchInv(vec_zz_p& x, Vec<long>& status, const vec_zz_p& a)
+{
+   status.SetLength(a.length());
+   bool seq = a.length() < BATCHINV_PAR_THRESH;
+   BatchInvAux<zz_p, zz_pContext>(x, status.elts(), a, seq);
+}
+
+
 NTL_END_IMPL
@@ -0,0 +1,106 @@
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// BatchGCD against GCD(a[i], product of the a[j] for j != i), for n
+// numbers of about l bits, some of which share prime factors
+
+long Check(long n, long l)
+{
+   Vec<ZZ> a, g;
+   a.SetLength(n);
+
+   Vec<ZZ> primes;
+   for (long i = 0; i < 8; i++) {
+      ZZ p;
+      GenPrime(p, l/2 + 1);
+      append(primes, p);
+   }
+
+   for (long i = 0; i < n; i++) {
+      RandomLen(a[i], l);
+      if (RandomBnd(4) == 0) {
+         RandomLen(a[i], l/2 + 1);
+         mul(a[i], a[i], primes[RandomBnd(8)]);
+      }
+   }
+
+   if (n > 2) {
+      a[n-1] = a[0];    // a repeated number
+      set(a[n-2]);      // and 1
+   }
+
+   BatchGCD(g, a);
+
+   if (g.length() != n) {
+      cerr << "BatchGCD: wrong length\n";
+      return 0;
+   }
+
+   // the product of the other numbers mod a[i], from prefix and
+   // suffix products
+   Vec<ZZ> pre, suf;
+   pre.SetLength(n+1);
+   suf.SetLength(n+1);
+   set(pre[0]);
+   set(suf[n]);
+   for (long i = 0; i < n; i++) mul(pre[i+1], pre[i], a[i]);
+   for (long i = n-1; i >= 0; i--) mul(suf[i], suf[i+1], a[i]);
+
+   for (long i = 0; i < n; i++) {
+      ZZ t, t1;
+      rem(t, pre[i], a[i]);
+      rem(t1, suf[i+1], a[i]);
+      MulMod(t, t, t1, a[i]);
+      GCD(t, a[i], t);
+      if (g[i] != t) {
+         cerr << "BatchGCD wrong at " << i << " of " << n << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+
+   long ok = 1;
+
+   ok = ok && Check(1, 100);
+   ok = ok && Check(2, 100);
+   ok = ok && Check(3, 64);
+   ok = ok && Check(17, 500);
+   ok = ok && Check(300, 256);
+   ok = ok && Check(1000, 1024);
+
+   // a tiny threshold, so that the levels of the product tree go
+   // through temporary files
+   double save = BatchGCDFileThresh;
+   BatchGCDFileThresh = 1;
+   ok = ok && Check(300, 256);
+   ok = ok && Check(1000, 1024);
+   BatchGCDFileThresh = save;
+
+   return ok;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   if (Test(1) && Test(4)) {
+      cerr << "BatchGCDTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "BatchGCDTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,99 @@
+
+#include <NTL/vec_ZZ_p.h>
+#include <NTL/vec_lzz_p.h>
+#include <NTL/vec_ZZ_pE.h>
+#include <NTL/vec_GF2E.h>
+#include <NTL/ZZ_pXFactoring.h>
+#include <NTL/GF2XFactoring.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// BatchInv against inv, entry by entry, with zero entries in the
+// second form;  n = 5000 is long enough for the parallel version
+
+template<class T>
+long CheckBatchInv(const char *name, long n)
+{
+   Vec<T> a, x, y;
+   Vec<long> status;
+
+   a.SetLength(n);
+   for (long i = 0; i < n; i++) {
+      do random(a[i]); while (IsZero(a[i]));
+   }
+
+   BatchInv(x, a);
+   for (long i = 0; i < n; i++) {
+      T t;
+      inv(t, a[i]);
+      if (x[i] != t) {
+         cerr << name << ": BatchInv wrong at " << i << "\n";
+         return 0;
+      }
+   }
+
+   // zeros, and x aliasing a
+   for (long i = 0; i < n; i += 7) clear(a[i]);
+   y = a;
+   BatchInv(y, status, y);
+
+   for (long i = 0; i < n; i++) {
+      T t;
+      if (IsZero(a[i])) 
+         clear(t);
+      else
+         inv(t, a[i]);
+
+      if (y[i] != t || status[i] != !IsZero(a[i])) {
+         cerr << name << ": BatchInv with status wrong at " << i << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+
+   long ok = 1;
+
+   ZZ p;
+   GenPrime(p, 256);
+   ZZ_p::init(p);
+   ok = ok && CheckBatchInv<ZZ_p>("ZZ_p", 5000);
+
+   zz_p::FFTInit(0);
+   ok = ok && CheckBatchInv<zz_p>("zz_p", 30000);
+
+   ZZ_pX f;
+   BuildIrred(f, 8);
+   ZZ_pE::init(f);
+   ok = ok && CheckBatchInv<ZZ_pE>("ZZ_pE", 1000);
+
+   GF2X g;
+   BuildSparseIrred(g, 300);
+   GF2E::init(g);
+   ok = ok && CheckBatchInv<GF2E>("GF2E", 5000);
+
+   return ok;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   if (Test(1) && Test(4)) {
+      cerr << "BatchInvTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "BatchInvTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,208 @@
+
+#include <NTL/DiscreteLog.h>
+#include <NTL/GF2XFactoring.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// the least x >= 0 with g^x = a, or -1 if there is none
+
+long BruteLog(const ZZ_p& a, const ZZ_p& g)
+{
+   ZZ_p t;
+   set(t);
+   long x = 0;
+
+   do {
+      if (t == a) return x;
+      mul(t, t, g);
+      x++;
+   } while (!IsOne(t));
+
+   return -1;
+}
+
+
+long BruteLog(const GF2E& a, const GF2E& g)
+{
+   GF2E t;
+   set(t);
+   long x = 0;
+
+   do {
+      if (t == a) return x;
+      mul(t, t, g);
+      x++;
+   } while (!IsOne(t));
+
+   return -1;
+}
+
+
+// p - 1 = 2^9 * 3 * 5, so the giant steps of every subgroup fall into
+// only a few intervals, and the candidates x and x+q are often found
+// by different threads at the same time
+
+long TestSmallSubgroups(long nthreads)
+{
+   SetNumThreads(nthreads);
+   ZZ_p::init(conv<ZZ>(7681));
+
+   SetSeed(conv<ZZ>(nthreads));
+
+   for (long i = 0; i < 2000; i++) {
+      ZZ_p a, g;
+      do random(g); while (IsZero(g));
+      random(a);
+
+      // also make a a power of g half the time
+      if (i & 1) power(a, g, RandomBnd(7680));
+
+      long x0 = BruteLog(a, g);
+
+      ZZ x;
+      long res = DiscreteLog(x, a, g);
+
+      if (res != (x0 >= 0) || (res && x != x0)) {
+         cerr << "DiscreteLog(" << a << ", " << g << ") = " << res
+              << " " << x << ", expected " << x0 << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+// a subgroup of prime order q = 1000003, solved by baby-step
+// giant-step with many giant steps per thread
+
+long TestLargeSubgroup(long nthreads)
+{
+   SetNumThreads(nthreads);
+
+   ZZ q, p;
+   conv(q, 1000003);
+
+   // p = 2 k q + 1
+   long k = 1;
+   for (;;) {
+      mul(p, q, 2*k);
+      add(p, p, 1);
+      if (ProbPrime(p)) break;
+      k++;
+   }
+
+   ZZ_p::init(p);
+
+   ZZ u;
+   div(u, p-1, q);
+
+   SetSeed(conv<ZZ>(17));
+
+   for (long i = 0; i < 20; i++) {
+      ZZ_p g, a;
+      do {
+         random(g);
+         power(g, g, u);
+      } while (IsOne(g) || IsZero(g));
+
+      ZZ x0, x;
+      RandomBnd(x0, q);
+      power(a, g, x0);
+
+      vec_pair_ZZ_long N;
+      append(N, cons(q, 1L));
+
+      if (!DiscreteLog(x, a, g, N) || x != x0) {
+         cerr << "DiscreteLog in order " << q << ": " << x
+              << ", expected " << x0 << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+// GF(2^k) against brute force, for 2^k-1 = 255 = 3*5*17,
+// 2047 = 23*89 and 4095 = 3^2*5*7*13, and in GF(2^31), where
+// 2^31-1 is prime
+
+long TestGF2E(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(conv<ZZ>(nthreads));
+
+   static const long deg[] = { 8, 11, 12 };
+
+   for (long j = 0; j < 3; j++) {
+      GF2X f;
+      BuildIrred(f, deg[j]);
+      GF2E::init(f);
+
+      for (long i = 0; i < 300; i++) {
+         GF2E a, g;
+         do random(g); while (IsZero(g));
+         random(a);
+
+         if (i & 1) power(a, g, RandomBnd(1L << deg[j]));
+
+         long x0 = BruteLog(a, g);
+
+         ZZ x;
+         long res = DiscreteLog(x, a, g);
+
+         if (res != (x0 >= 0) || (res && x != x0)) {
+            cerr << "DiscreteLog(" << a << ", " << g << ") in GF(2^"
+                 << deg[j] << ") = " << res << " " << x << ", expected "
+                 << x0 << "\n";
+            return 0;
+         }
+      }
+   }
+
+   GF2X f;
+   BuildSparseIrred(f, 31);
+   GF2E::init(f);
+
+   for (long i = 0; i < 10; i++) {
+      GF2E a, g;
+      do random(g); while (IsZero(g) || IsOne(g));
+
+      ZZ x0, x;
+      RandomBnd(x0, power2_ZZ(31) - 1);
+      power(a, g, x0);
+
+      if (!DiscreteLog(x, a, g) || x != x0) {
+         cerr << "DiscreteLog in GF(2^31): " << x << ", expected "
+              << x0 << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   long ok = 1;
+
+   ok = ok && TestSmallSubgroups(1);
+   ok = ok && TestSmallSubgroups(4);
+   ok = ok && TestLargeSubgroup(1);
+   ok = ok && TestLargeSubgroup(4);
+   ok = ok && TestGF2E(1);
+   ok = ok && TestGF2E(4);
+
+   if (ok) {
+      cerr << "DiscreteLogTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "DiscreteLogTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,178 @@
+
+#include <NTL/ZZFactoring.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// factor(n) against the known factorization ref of n: the same
+// pairs, sorted by p, with every p passing ProbPrime
+
+long CheckFactor(const ZZ& n, vec_pair_ZZ_long ref)
+{
+   // sort ref by p, merging repeated primes
+   for (long i = 0; i < ref.length(); i++)
+      for (long j = i+1; j < ref.length(); j++)
+         if (ref[j].a < ref[i].a) swap(ref[i], ref[j]);
+
+   vec_pair_ZZ_long r;
+   for (long i = 0; i < ref.length(); i++) {
+      if (r.length() > 0 && r[r.length()-1].a == ref[i].a)
+         r[r.length()-1].b += ref[i].b;
+      else
+         append(r, ref[i]);
+   }
+
+   vec_pair_ZZ_long f;
+   factor(f, n);
+
+   if (f != r) {
+      cerr << "factor(" << n << ") = " << f << ", expected " << r << "\n";
+      return 0;
+   }
+
+   for (long i = 0; i < f.length(); i++)
+      if (!ProbPrime(f[i].a)) {
+         cerr << "factor(" << n << "): " << f[i].a << " not prime\n";
+         return 0;
+      }
+
+   ZZ t;
+   mul(t, f);
+   if (t != abs(n)) {
+      cerr << "factor(" << n << "): wrong product\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+// products of random primes of the given lengths, with exponents
+
+long CheckProduct(const Vec<long>& len, long maxe, long neg)
+{
+   vec_pair_ZZ_long ref;
+   ZZ n;
+   set(n);
+
+   for (long i = 0; i < len.length(); i++) {
+      ZZ p;
+      GenPrime(p, len[i]);
+      long e = 1 + RandomBnd(maxe);
+      append(ref, cons(p, e));
+      mul(n, n, power(p, e));
+   }
+
+   if (neg) NTL::negate(n, n);
+
+   return CheckFactor(n, ref);
+}
+
+
+// PollardRho and ECM return proper divisors
+
+long CheckSplit(long l1, long l2, long ecm)
+{
+   ZZ p, q, n, d;
+   GenPrime(p, l1);
+   GenPrime(q, l2);
+   mul(n, p, q);
+
+   long res;
+   if (ecm)
+      res = ECM(d, n, 2000, 200000, 200);
+   else
+      res = PollardRho(d, n, 1L << 20);
+
+   if (!res || d <= 1 || d >= n || !divide(n, d)) {
+      cerr << (ecm ? "ECM" : "PollardRho") << "(" << n << ") = " << res
+           << " " << d << "\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(ZZ(nthreads));
+
+   long ok = 1;
+
+   // 1, -1, small numbers and prime powers
+   ok = ok && CheckFactor(ZZ(1), vec_pair_ZZ_long());
+   ok = ok && CheckFactor(ZZ(-1), vec_pair_ZZ_long());
+
+   for (long i = 2; ok && i < 2000; i++) {
+      vec_pair_ZZ_long ref;
+      long m = i;
+      for (long p = 2; p <= m; p++) {
+         long e = 0;
+         while (m % p == 0) { m /= p; e++; }
+         if (e) append(ref, cons(ZZ(p), e));
+      }
+      ok = CheckFactor(ZZ(i), ref) && CheckFactor(ZZ(-i), ref);
+   }
+
+   Vec<long> len;
+
+   // small primes, taken by trial division, and primes just above
+   // the trial division bound
+   len.SetLength(3);
+   len[0] = 10; len[1] = 16; len[2] = 17;
+   for (long i = 0; ok && i < 10; i++)
+      ok = CheckProduct(len, 3, i & 1);
+
+   // perfect powers of large primes, and of products
+   len.SetLength(1);
+   len[0] = 100;
+   for (long i = 0; ok && i < 5; i++)
+      ok = CheckProduct(len, 6, i & 1);
+
+   for (long i = 0; ok && i < 3; i++) {
+      ZZ p, q, n;
+      GenPrime(p, 60);
+      GenPrime(q, 60);
+      vec_pair_ZZ_long ref;
+      append(ref, cons(p, 3L));
+      append(ref, cons(q, 3L));
+      power(n, p*q, 3);
+      ok = CheckFactor(n, ref);
+   }
+
+   // factors found by PollardRho, and by ECM
+   len.SetLength(3);
+   len[0] = 30; len[1] = 40; len[2] = 200;
+   for (long i = 0; ok && i < 5; i++)
+      ok = CheckProduct(len, 2, i & 1);
+
+   len.SetLength(3);
+   len[0] = 56; len[1] = 60; len[2] = 100;
+   ok = ok && CheckProduct(len, 1, 0);
+
+   // rho needs about 2^16 iterations for a 32-bit factor, well
+   // within its bound of 2^20
+   for (long i = 0; ok && i < 10; i++)
+      ok = CheckSplit(20 + RandomBnd(12), 40 + RandomBnd(100), 0);
+
+   for (long i = 0; ok && i < 3; i++)
+      ok = CheckSplit(40 + RandomBnd(10), 100, 1);
+
+   return ok;
+}
+
+
+int main()
+{
+   if (Test(1) && Test(4)) {
+      cerr << "FactorTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "FactorTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,235 @@
+
+#include <NTL/ZZ.h>
+
+NTL_CLIENT
+
+
+// gcd(|a|, |b|) by the plain Euclidean algorithm
+
+void RefGCD(ZZ& d, const ZZ& a, const ZZ& b)
+{
+   ZZ x, y, r;
+   abs(x, a);
+   abs(y, b);
+
+   while (!IsZero(y)) {
+      rem(r, x, y);
+      x = y;
+      y = r;
+   }
+
+   d = x;
+}
+
+
+// the extended Euclidean algorithm on |a|, |b|, with the signs
+// of s and t then adjusted to those of a and b
+
+void RefXGCD(ZZ& d, ZZ& s, ZZ& t, const ZZ& a, const ZZ& b)
+{
+   ZZ r0, r1, s0, s1, t0, t1, q, tmp;
+
+   abs(r0, a);
+   abs(r1, b);
+   set(s0); clear(s1);
+   clear(t0); set(t1);
+
+   while (!IsZero(r1)) {
+      DivRem(q, tmp, r0, r1);
+      r0 = r1; r1 = tmp;
+
+      mul(tmp, q, s1); sub(tmp, s0, tmp);
+      s0 = s1; s1 = tmp;
+
+      mul(tmp, q, t1); sub(tmp, t0, tmp);
+      t0 = t1; t1 = tmp;
+   }
+
+   d = r0;
+   s = s0;
+   t = t0;
+   if (sign(a) < 0) NTL::negate(s, s);
+   if (sign(b) < 0) NTL::negate(t, t);
+}
+
+
+// a pair with a known common factor of l0 bits, and cofactors of
+// la and lb bits
+
+void RandomPair(ZZ& a, ZZ& b, long la, long lb, long l0)
+{
+   ZZ g;
+   RandomLen(g, l0);
+   RandomLen(a, la);
+   RandomLen(b, lb);
+   mul(a, a, g);
+   mul(b, b, g);
+   if (RandomBnd(2)) NTL::negate(a, a);
+   if (RandomBnd(2)) NTL::negate(b, b);
+}
+
+
+long CheckGCD(const ZZ& a, const ZZ& b)
+{
+   ZZ d, d1, s, t, x;
+
+   RefGCD(d1, a, b);
+
+   GCD(d, a, b);
+   if (d != d1) {
+      cerr << "GCD wrong: " << NumBits(a) << ", " << NumBits(b) << " bits\n";
+      return 0;
+   }
+
+   XGCD(d, s, t, a, b);
+   mul(x, a, s);
+   MulAddTo(x, b, t);
+   if (d != d1 || x != d) {
+      cerr << "XGCD wrong: " << NumBits(a) << ", " << NumBits(b) << " bits\n";
+      return 0;
+   }
+
+   // the cofactors are those of the Euclidean algorithm, which
+   // satisfy |s| <= |b|/d and |t| <= |a|/d
+   if (!IsZero(a) && !IsZero(b) && abs(a) != abs(b)) {
+      ZZ d2, s2, t2;
+      RefXGCD(d2, s2, t2, a, b);
+      if (s != s2 || t != t2) {
+         cerr << "XGCD cofactors wrong: " << NumBits(a) << ", "
+              << NumBits(b) << " bits\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long CheckInvMod(long l)
+{
+   ZZ n, a, x, t;
+
+   RandomLen(n, l);
+   RandomBnd(a, n);
+
+   // sometimes with a common factor
+   if (RandomBnd(4) == 0) {
+      ZZ g;
+      RandomLen(g, 20);
+      mul(n, n, g);
+      mul(a, a, g);
+   }
+
+   RefGCD(t, a, n);
+
+   if (InvModStatus(x, a, n) == 0) {
+      MulMod(t, a, x, n);
+      if (!IsOne(t) || sign(x) < 0 || x >= n) {
+         cerr << "InvMod wrong: " << l << " bits\n";
+         return 0;
+      }
+   }
+   else if (IsOne(t) || x != t) {
+      cerr << "InvModStatus wrong: " << l << " bits\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+// a0/b0 from its residue a0*b0^{-1} mod m, with m > 2*A*B
+
+long CheckRecon(long l)
+{
+   ZZ A, B, a0, b0, m, u, a, b;
+
+   RandomLen(A, l);
+   RandomLen(B, l + RandomBnd(20));
+
+   do {
+      RandomBnd(a0, A + 1);
+      RandomBnd(b0, B);
+      add(b0, b0, 1);
+   } while (GCD(a0, b0) != 1);
+
+   if (RandomBnd(2)) NTL::negate(a0, a0);
+
+   do {
+      mul(m, A, B);
+      mul(m, m, 2);
+      RandomLen(u, 30);
+      mul(m, m, u);
+      add(m, m, 1);
+   } while (GCD(b0, m) != 1);
+
+   InvMod(u, b0 % m, m);
+   MulMod(u, u, a0 % m, m);
+
+   if (!ReconstructRational(a, b, u, m, A, B) || a != a0 || b != b0) {
+      cerr << "ReconstructRational wrong: " << l << " bits\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = 1;
+
+   // across the crossovers of half-GCD, for XGCD and InvMod (about
+   // 3000 bits) and for GCD (about 15000 bits)
+   static const long len[] =
+      { 10, 100, 1000, 2500, 3500, 6000, 12000, 16000, 25000, 40000 };
+   const long nlen = sizeof(len)/sizeof(len[0]);
+
+   for (long i = 0; ok && i < nlen; i++) {
+      long l = len[i];
+      for (long j = 0; ok && j < 4; j++) {
+         ZZ a, b;
+
+         RandomPair(a, b, l, l, 1 + RandomBnd(l/4 + 1));
+         ok = ok && CheckGCD(a, b);
+
+         RandomPair(a, b, l, l/3 + 1, 1 + RandomBnd(100));
+         ok = ok && CheckGCD(a, b);
+         ok = ok && CheckGCD(b, a);
+      }
+
+      for (long j = 0; ok && j < 4; j++)
+         ok = CheckInvMod(l);
+
+      for (long j = 0; ok && j < 2; j++)
+         ok = CheckRecon(l/2 + 1);
+   }
+
+   // a few degenerate cases
+   if (ok) {
+      ZZ a, b;
+      RandomLen(a, 20000);
+      ok = CheckGCD(a, b) && CheckGCD(b, a) && CheckGCD(a, a) &&
+           CheckGCD(a, -a) && CheckGCD(b, b);
+
+      // consecutive Fibonacci numbers, the worst case of Euclid
+      ZZ f0, f1(1), t;
+      for (long i = 0; i < 30000; i++) {
+         add(t, f0, f1);
+         f0 = f1;
+         f1 = t;
+      }
+      ok = ok && CheckGCD(f1, f0) && CheckGCD(f0, f1);
+   }
+
+   if (ok) {
+      cerr << "GCDTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "GCDTest BAD\n";
+      return 1;
+   }
+}
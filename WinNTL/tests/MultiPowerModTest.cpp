@@ -0,0 +1,101 @@
+
+#include <NTL/vec_ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// a modulus of l bits, odd, even, or of the form k*2^m + c
+
+void RandomModulus(ZZ& n, long l, long kind)
+{
+   switch (kind) {
+   case 0:
+      RandomLen(n, l);
+      SetBit(n, 0);
+      break;
+
+   case 1:
+      RandomLen(n, l);
+      SetBit(n, 1);
+      mul(n, n, 1L << RandomBnd(10));
+      if (IsOdd(n)) add(n, n, 1);
+      break;
+
+   default:
+      // k*2^m + c, with small k and c
+      power2(n, l);
+      mul(n, n, RandomBnd(100) + 1);
+      add(n, n, RandomBnd(2001) - 1000);
+      break;
+   }
+
+   if (n < 2) conv(n, 3);
+}
+
+
+// MultiPowerMod against a product of PowerMods, for 1 to 80 bases
+
+long TestMulti()
+{
+   static const long nbases[] = { 1, 2, 3, 5, 8, 16, 40, 80 };
+
+   for (long i = 0; i < 8; i++)
+      for (long j = 0; j < 6; j++) {
+         long k = nbases[i];
+         ZZ n;
+         long l = 2 + RandomBnd(j < 5 ? 500 : 2000);
+         RandomModulus(n, l, j % 3);
+
+         vec_ZZ g, e;
+         g.SetLength(k);
+         e.SetLength(k);
+
+         ZZ x, x1, t;
+         set(x1);
+
+         for (long m = 0; m < k; m++) {
+            RandomBnd(g[m], n);
+            if (GCD(g[m], n) != 1) set(g[m]);
+
+            // exponents of different lengths, a few negative or zero
+            RandomLen(e[m], 1 + RandomBnd(l + 50));
+            if (m % 7 == 3) NTL::negate(e[m], e[m]);
+            if (m % 11 == 5) clear(e[m]);
+
+            PowerMod(t, g[m], e[m], n);
+            MulMod(x1, x1, t, n);
+         }
+
+         MultiPowerMod(x, g, e, n);
+         if (x != x1) {
+            cerr << "MultiPowerMod wrong: " << k << " bases, " << l
+                 << "-bit modulus\n";
+            return 0;
+         }
+      }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(ZZ(nthreads));
+
+   return TestMulti();
+}
+
+
+int main()
+{
+   if (Test(1) && Test(4)) {
+      cerr << "MultiPowerModTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "MultiPowerModTest BAD\n";
+      return 1;
+   }
+}
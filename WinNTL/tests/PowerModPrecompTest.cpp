@@ -0,0 +1,102 @@
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// a modulus of l bits, odd, even, or of the form k*2^m + c
+
+void RandomModulus(ZZ& n, long l, long kind)
+{
+   switch (kind) {
+   case 0:
+      RandomLen(n, l);
+      SetBit(n, 0);
+      break;
+
+   case 1:
+      RandomLen(n, l);
+      SetBit(n, 1);
+      mul(n, n, 1L << RandomBnd(10));
+      if (IsOdd(n)) add(n, n, 1);
+      break;
+
+   default:
+      // k*2^m + c, with small k and c
+      power2(n, l);
+      mul(n, n, RandomBnd(100) + 1);
+      add(n, n, RandomBnd(2001) - 1000);
+      break;
+   }
+
+   if (n < 2) conv(n, 3);
+}
+
+
+// PowerModPrecomp against PowerMod, for exponents up to and beyond
+// ebits, of either sign, and for several window sizes
+
+long TestPrecomp()
+{
+   for (long i = 0; i < 60; i++) {
+      ZZ n, g;
+      long l = 2 + RandomBnd(i < 50 ? 600 : 3000);
+      RandomModulus(n, l, i % 3);
+
+      RandomBnd(g, n);
+
+      // g must be invertible for the negative exponents
+      if (GCD(g, n) != 1) set(g);
+
+      long ebits = 1 + RandomBnd(2*l);
+      long w = (i % 4 == 0) ? 0 : RandomBnd(7);
+
+      PowerModPrecomp P(g, n, ebits, w);
+
+      for (long j = 0; j < 20; j++) {
+         ZZ e, x, x1;
+         RandomLen(e, 1 + RandomBnd(j < 15 ? ebits : ebits + 100));
+         if (j == 0) clear(e);
+         if (j % 5 == 4) NTL::negate(e, e);
+
+         PowerMod(x, P, e);
+         PowerMod(x1, g, e, n);
+         if (x != x1) {
+            cerr << "PowerModPrecomp wrong: n = " << n << ", g = " << g
+                 << ", e = " << e << ", w = " << P.window() << "\n";
+            return 0;
+         }
+      }
+
+      long e = RandomBnd(1000);
+      if (PowerMod(P, e) != PowerMod(g, e, n)) {
+         cerr << "PowerModPrecomp wrong for long exponent\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(ZZ(nthreads));
+
+   return TestPrecomp();
+}
+
+
+int main()
+{
+   if (Test(1) && Test(4)) {
+      cerr << "PowerModPrecompTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "PowerModPrecompTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,249 @@
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// primality by strong pseudoprime tests to the first 12 prime bases,
+// which is correct below 3.1*10^23
+
+long RefPrime(const ZZ& n)
+{
+   static const long base[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+   if (n < 2) return 0;
+
+   for (long i = 0; i < 12; i++) {
+      if (n == base[i]) return 1;
+      if (divide(n, base[i])) return 0;
+   }
+
+   for (long i = 0; i < 12; i++)
+      if (MillerWitness(n, ZZ(base[i]))) return 0;
+
+   return 1;
+}
+
+
+long CheckPrime(const ZZ& n, long expected)
+{
+   if (ProbPrime(n) != expected || ProbPrimeBPSW(n) != expected) {
+      cerr << "primality of " << n << " wrong, expected "
+           << expected << "\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+// random numbers below 2^64, where both tests are exact
+
+long TestSmall()
+{
+   for (long i = 0; i < 20000; i++) {
+      ZZ n;
+      RandomLen(n, 1 + RandomBnd(64));
+      if (i & 1) SetBit(n, 0);
+
+      if (!CheckPrime(n, RefPrime(n))) return 0;
+   }
+
+   for (long n = -10; n < 3000; n++)
+      if (!CheckPrime(ZZ(n), RefPrime(ZZ(n)))) return 0;
+
+   return 1;
+}
+
+
+long TestPseudoprimes()
+{
+   // strong pseudoprimes to base 2, to the bases 2, 3, 5, 7, to the
+   // bases up to 23, and to the bases up to 37
+   static const char *spsp[] = {
+      "2047", "3215031751", "3825123056546413051",
+      "318665857834031151167461"
+   };
+
+   for (long i = 0; i < 4; i++) {
+      ZZ n = conv<ZZ>(spsp[i]);
+      if (MillerWitness(n, ZZ(2)) || !CheckPrime(n, 0)) {
+         cerr << "strong pseudoprime " << n << "\n";
+         return 0;
+      }
+   }
+
+   // strong Lucas pseudoprimes, which pass StrongLucasTest
+   static const long slpsp[] = { 5459, 5777, 10877, 16109, 18971 };
+
+   for (long i = 0; i < 5; i++) {
+      ZZ n(slpsp[i]);
+      if (!StrongLucasTest(n) || !CheckPrime(n, 0)) {
+         cerr << "strong Lucas pseudoprime " << n << "\n";
+         return 0;
+      }
+   }
+
+   // Carmichael numbers, including (6k+1)(12k+1)(18k+1) with large
+   // prime factors
+   static const long carm[] = { 561, 1105, 41041, 825265, 321197185 };
+   for (long i = 0; i < 5; i++)
+      if (!CheckPrime(ZZ(carm[i]), 0)) return 0;
+
+   for (long i = 0, found = 0; found < 3; i++) {
+      ZZ k, p1, p2, p3;
+      RandomLen(k, 60 + 30*found);
+      p1 = 6*k + 1;
+      p2 = 12*k + 1;
+      p3 = 18*k + 1;
+      if (!ProbPrime(p1) || !ProbPrime(p2) || !ProbPrime(p3)) continue;
+      if (!CheckPrime(p1*p2*p3, 0)) return 0;
+      found++;
+   }
+
+   // products of two primes, and the primes themselves
+   for (long i = 0; i < 40; i++) {
+      ZZ p, q;
+      long l = 20 + RandomBnd(300);
+      GenPrime(p, l);
+      GenPrime(q, l + RandomBnd(20));
+      if (!CheckPrime(p, 1) || !CheckPrime(q, 1) || !CheckPrime(p*q, 0))
+         return 0;
+   }
+
+   // Mersenne primes, and 2^p-1 composite for p prime
+   static const long mexp[] = { 61, 89, 107, 127, 521, 607, 1279, 2203 };
+   for (long i = 0; i < 8; i++) {
+      ZZ n;
+      power2(n, mexp[i]);
+      if (!CheckPrime(n - 1, 1)) return 0;
+   }
+
+   for (long p = 67; p < 500; p += 2)
+      if (ProbPrime(p) && p != 89 && p != 107 && p != 127) {
+         ZZ n;
+         power2(n, p);
+         if (!CheckPrime(n - 1, 0)) return 0;
+      }
+
+   return 1;
+}
+
+
+// the vector forms of ProbPrime against the scalar form
+
+long TestBatch()
+{
+   Vec<ZZ> n;
+
+   // primes, random numbers and products, and a few large primes
+   for (long i = 0; i < 300; i++) {
+      ZZ t;
+      long l = 2 + RandomBnd(300);
+      if (i % 3 == 0) {
+         GenPrime(t, l);
+      }
+      else {
+         RandomLen(t, l);
+         if (i % 3 == 2) mul(t, t, RandomBnd(5000));
+      }
+      append(n, t);
+   }
+
+   append(n, power2_ZZ(1279) - 1);
+   append(n, power2_ZZ(607) - 1);
+
+   Vec<long> res, res1;
+   Vec<double> tm;
+
+   ProbPrime(res, tm, n);
+   ProbPrime(res1, n);
+   if (res.length() != n.length() || tm.length() != n.length() ||
+       res1 != res) {
+      cerr << "ProbPrime(Vec): wrong lengths or results\n";
+      return 0;
+   }
+
+   for (long i = 0; i < n.length(); i++)
+      if (res[i] != ProbPrime(n[i]) || tm[i] < 0) {
+         cerr << "ProbPrime(Vec) wrong at " << i << "\n";
+         return 0;
+      }
+
+   return 1;
+}
+
+
+// numbers of 1024 bits or more, where the witnesses of ProbPrime
+// and the two tests of ProbPrimeBPSW run concurrently:  the two
+// agree, and the result and the random numbers consumed do not
+// depend on the number of threads
+
+long TestLarge()
+{
+   Vec<ZZ> n;
+   ZZ t;
+
+   static const long mexp[] = { 1279, 2203 };
+   for (long i = 0; i < 2; i++) {
+      power2(t, mexp[i]);
+      append(n, t - 1);
+   }
+
+   // 2^1277-1 is composite, and so is (2^521-1)(2^607-1)
+   power2(t, 1277);
+   append(n, t - 1);
+   append(n, (power2_ZZ(521) - 1)*(power2_ZZ(607) - 1));
+
+   for (long i = 0; i < 10; i++) {
+      RandomLen(t, 1024 + RandomBnd(500));
+      SetBit(t, 0);
+      append(n, t);
+   }
+
+   for (long i = 0; i < n.length(); i++) {
+      long res[2];
+      unsigned long w[2];
+
+      for (long j = 0; j < 2; j++) {
+         SetNumThreads(j == 0 ? 1 : 4);
+         SetSeed(ZZ(i));
+         res[j] = ProbPrime(n[i]);
+         w[j] = RandomWord();
+      }
+
+      if (res[0] != res[1] || w[0] != w[1] ||
+          res[0] != ProbPrimeBPSW(n[i]) || res[0] != (i < 2)) {
+         cerr << "ProbPrime wrong or thread-dependent for a "
+              << NumBits(n[i]) << "-bit number\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(ZZ(nthreads));
+
+   return TestSmall() && TestPseudoprimes() && TestBatch();
+}
+
+
+int main()
+{
+   long ok = Test(1) && Test(4) && TestLarge();
+
+   if (ok) {
+      cerr << "PrimalityTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "PrimalityTest BAD\n";
+      return 1;
+   }
+}
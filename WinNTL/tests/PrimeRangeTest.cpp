@@ -0,0 +1,208 @@
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// the sieve of Eratosthenes up to n, one byte per number
+
+void SimpleSieve(Vec<char>& isp, long n)
+{
+   isp.SetLength(n+1);
+   for (long i = 0; i <= n; i++) isp[i] = (i >= 2);
+
+   for (long i = 2; i*i <= n; i++) {
+      if (!isp[i]) continue;
+      for (long j = i*i; j <= n; j += i) isp[j] = 0;
+   }
+}
+
+
+// the number of primes in [lo, hi], by sieving the interval with
+// the primes up to sqrt(hi), for 2 <= lo <= hi
+
+unsigned long long SegmentCount(long lo, long hi)
+{
+   long r = SqrRoot(hi);
+   Vec<char> small;
+   SimpleSieve(small, r);
+
+   Vec<char> seg;
+   seg.SetLength(hi-lo+1);
+   for (long i = 0; i <= hi-lo; i++) seg[i] = 1;
+
+   for (long p = 2; p <= r; p++) {
+      if (!small[p]) continue;
+      long j = max(p*p, ((lo + p - 1)/p)*p);
+      for (; j <= hi; j += p) seg[j-lo] = 0;
+   }
+
+   unsigned long long c = 0;
+   for (long i = 0; i <= hi-lo; i++) c += seg[i];
+   return c;
+}
+
+
+// primality below 2^64, by strong pseudoprime tests to the first
+// 12 prime bases, which suffice below 3.1*10^23
+
+long RefPrime(unsigned long long n)
+{
+   if (n < 2) return 0;
+
+   static const long base[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+   ZZ N;
+   conv(N, (unsigned long) (n >> 32));
+   LeftShift(N, N, 32);
+   add(N, N, (unsigned long) (n & 0xffffffffUL));
+
+   for (long i = 0; i < 12; i++) {
+      if (n == (unsigned long long) base[i]) return 1;
+      if (n % base[i] == 0) return 0;
+   }
+
+   for (long i = 0; i < 12; i++)
+      if (MillerWitness(N, ZZ(base[i]))) return 0;
+
+   return 1;
+}
+
+
+// PrimeSeq against the simple sieve, from the start and after reset
+
+long TestPrimeSeq()
+{
+   const long n = 2000000;
+   Vec<char> isp;
+   SimpleSieve(isp, n);
+
+   PrimeSeq s;
+   long p = s.next();
+   for (long i = 0; i <= n; i++) {
+      if (!isp[i]) continue;
+      if (p != i) {
+         cerr << "PrimeSeq: " << p << ", expected " << i << "\n";
+         return 0;
+      }
+      p = s.next();
+   }
+
+   s.reset(1000);
+   for (long i = 1000; i <= 100000; i++) {
+      if (!isp[i]) continue;
+      p = s.next();
+      if (p != i) {
+         cerr << "PrimeSeq after reset: " << p << ", expected " << i << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+// PrimeRange, PrimeList and CountPrimes on [lo, hi], against RefPrime
+
+long CheckRange(unsigned long long lo, unsigned long long hi)
+{
+   Vec<unsigned long long> ref;
+   for (unsigned long long n = lo; ; n++) {
+      if (RefPrime(n)) append(ref, n);
+      if (n == hi) break;
+   }
+
+   PrimeRange r(lo, hi);
+   for (long i = 0; i < ref.length(); i++) {
+      unsigned long long p = r.next();
+      if (p != ref[i]) {
+         cerr << "PrimeRange(" << lo << ", " << hi << "): " << p
+              << ", expected " << ref[i] << "\n";
+         return 0;
+      }
+   }
+
+   if (r.next() != 0) {
+      cerr << "PrimeRange(" << lo << ", " << hi << "): too many primes\n";
+      return 0;
+   }
+
+   Vec<unsigned long long> v;
+   PrimeList(v, lo, hi);
+   if (v != ref) {
+      cerr << "PrimeList(" << lo << ", " << hi << ") wrong\n";
+      return 0;
+   }
+
+   unsigned long long c = CountPrimes(lo, hi);
+   if (c != (unsigned long long) ref.length()) {
+      cerr << "CountPrimes(" << lo << ", " << hi << ") = " << c
+           << ", expected " << ref.length() << "\n";
+      return 0;
+   }
+
+   PrimeRange r1(lo, hi);
+   r1.next();
+   if (ref.length() > 0 && r1.count() != (unsigned long long) ref.length()-1) {
+      cerr << "PrimeRange::count wrong after next\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+
+   long ok = 1;
+
+   // small ranges, including the wheel primes and empty ranges
+   ok = ok && CheckRange(0, 1);
+   ok = ok && CheckRange(0, 100);
+   ok = ok && CheckRange(7, 7);
+   ok = ok && CheckRange(24, 28);
+   ok = ok && CheckRange(1000, 200000);
+
+   // around 2^32 and 2^40, where the method changes
+   const unsigned long long two32 = 1ULL << 32;
+   const unsigned long long two40 = 1ULL << 40;
+   ok = ok && CheckRange(two32 - 50000, two32 + 50000);
+   ok = ok && CheckRange(two40 - 30000, two40 + 30000);
+
+   // near the top of the range
+   const unsigned long long top = ~0ULL;
+   ok = ok && CheckRange(top - 20000, top);
+   ok = ok && CheckRange((1ULL << 62) - 5000, (1ULL << 62) + 5000);
+
+   // known values of pi(x)
+   if (ok && CountPrimes(0, 100000000) != 5761455) {
+      cerr << "CountPrimes(0, 10^8) wrong\n";
+      ok = 0;
+   }
+
+   if (ok && CountPrimes(1000000000, 1010000000) !=
+             SegmentCount(1000000000, 1010000000)) {
+      cerr << "CountPrimes(10^9, 10^9+10^7) wrong\n";
+      ok = 0;
+   }
+
+   return ok;
+}
+
+
+int main()
+{
+   long ok = TestPrimeSeq() && Test(1) && Test(4);
+
+   if (ok) {
+      cerr << "PrimeRangeTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "PrimeRangeTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,206 @@
+
+#include <NTL/vec_ZZ_p.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// the vector forms of RandomBnd, RandomBits and RandomWord against
+// k single calls from the same seed, followed by one more call to
+// check that the stream is left in the same state
+
+long CheckSmall(long k, long nbits)
+{
+   ZZ seed;
+   RandomLen(seed, 64);
+
+   ZZ n;
+   RandomLen(n, nbits);
+
+   long ln = RandomBnd(NTL_MAX_LONG) + 1;
+   if (k & 1) ln = 1 + RandomBnd(1000);
+
+   Vec<ZZ> x, y;
+   Vec<long> lx, ly;
+   Vec<unsigned long> wx, wy;
+   unsigned long t, t1;
+
+   x.SetLength(k);
+   y.SetLength(k);
+   lx.SetLength(k);
+   ly.SetLength(k);
+   wx.SetLength(k);
+   wy.SetLength(k);
+
+   SetSeed(seed);
+   VectorRandomBnd(k, x.elts(), n);
+   t = RandomWord();
+   SetSeed(seed);
+   for (long i = 0; i < k; i++) RandomBnd(y[i], n);
+   t1 = RandomWord();
+   if (x != y || t != t1) {
+      cerr << "VectorRandomBnd(ZZ) wrong: k = " << k << ", n = " << n
+           << "\n";
+      return 0;
+   }
+
+   // the pointer form, writing into the reps of ZZ_p's
+   ZZ_p::init(n + 2);
+   Vec<ZZ_p> px;
+   px.SetLength(k);
+   Vec<ZZ*> ptr;
+   ptr.SetLength(k);
+   for (long i = 0; i < k; i++) ptr[i] = &px[i].LoopHole();
+
+   SetSeed(seed);
+   VectorRandomBnd(k, ptr.elts(), n);
+   t = RandomWord();
+   long same = 1;
+   for (long i = 0; i < k; i++)
+      if (rep(px[i]) != y[i]) same = 0;
+   if (!same || t != t1) {
+      cerr << "VectorRandomBnd(ZZ*) wrong: k = " << k << "\n";
+      return 0;
+   }
+
+   SetSeed(seed);
+   VectorRandomBits(k, x.elts(), nbits);
+   t = RandomWord();
+   SetSeed(seed);
+   for (long i = 0; i < k; i++) RandomBits(y[i], nbits);
+   t1 = RandomWord();
+   if (x != y || t != t1) {
+      cerr << "VectorRandomBits wrong: k = " << k << ", bits = " << nbits
+           << "\n";
+      return 0;
+   }
+
+   SetSeed(seed);
+   VectorRandomBnd(k, lx.elts(), ln);
+   t = RandomWord();
+   SetSeed(seed);
+   for (long i = 0; i < k; i++) ly[i] = RandomBnd(ln);
+   t1 = RandomWord();
+   if (lx != ly || t != t1) {
+      cerr << "VectorRandomBnd(long) wrong: k = " << k << ", n = " << ln
+           << "\n";
+      return 0;
+   }
+
+   SetSeed(seed);
+   VectorRandomWord(k, wx.elts());
+   t = RandomWord();
+   SetSeed(seed);
+   for (long i = 0; i < k; i++) wy[i] = RandomWord();
+   t1 = RandomWord();
+   if (wx != wy || t != t1) {
+      cerr << "VectorRandomWord wrong: k = " << k << "\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+// outputs of 256KB or more, generated in blocks from substreams:
+// the same for 1 and 4 threads, and in range
+
+long CheckLarge(long k, long nbits)
+{
+   ZZ seed, n;
+   RandomLen(seed, 64);
+   RandomLen(n, nbits);
+
+   Vec<ZZ> x, y, bx, by;
+   unsigned long t, t1;
+
+   x.SetLength(k);
+   y.SetLength(k);
+   bx.SetLength(k);
+   by.SetLength(k);
+
+   SetNumThreads(1);
+   SetSeed(seed);
+   VectorRandomBnd(k, x.elts(), n);
+   VectorRandomBits(k, bx.elts(), nbits);
+   t = RandomWord();
+
+   SetNumThreads(4);
+   SetSeed(seed);
+   VectorRandomBnd(k, y.elts(), n);
+   VectorRandomBits(k, by.elts(), nbits);
+   t1 = RandomWord();
+
+   if (x != y || bx != by || t != t1) {
+      cerr << "VectorRandomBnd/Bits depend on the number of threads: k = "
+           << k << ", bits = " << nbits << "\n";
+      return 0;
+   }
+
+   // in range
+   ZZ sum;
+   for (long i = 0; i < k; i++) {
+      if (sign(x[i]) < 0 || x[i] >= n || NumBits(bx[i]) > nbits) {
+         cerr << "VectorRandomBnd/Bits out of range\n";
+         return 0;
+      }
+      add(sum, sum, x[i]);
+   }
+
+   // the mean is close to n/2
+   ZZ lo, hi;
+   mul(lo, n, 2*k/5);
+   mul(hi, n, 3*k/5);
+   if (sum < lo || sum > hi) {
+      cerr << "VectorRandomBnd: mean out of range\n";
+      return 0;
+   }
+
+   // random(vec_ZZ_p&, n) goes through the same path
+   ZZ_p::init(n + 1);
+   vec_ZZ_p a, b;
+   SetNumThreads(1);
+   SetSeed(seed);
+   random(a, k);
+   SetNumThreads(4);
+   SetSeed(seed);
+   random(b, k);
+   if (a != b) {
+      cerr << "random(vec_ZZ_p) depends on the number of threads\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = 1;
+
+   static const long bits[] = { 1, 2, 7, 8, 9, 31, 63, 64, 65, 100, 257 };
+
+   for (long j = 0; ok && j < 11; j++)
+      for (long k = 0; ok && k < 40; k += 1 + k/4)
+         ok = CheckSmall(k, bits[j]);
+
+   // below 256KB
+   for (long i = 0; ok && i < 20; i++)
+      ok = CheckSmall(RandomBnd(1000), 1 + RandomBnd(2000));
+
+   // 256KB and up
+   ok = ok && CheckLarge(40000, 64);
+   ok = ok && CheckLarge(5000, 1000);
+   ok = ok && CheckLarge(300, 20000);
+
+   if (ok) {
+      cerr << "RandomTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "RandomTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,89 @@
+
+#include <NTL/ZZ.h>
+
+NTL_CLIENT
+
+
+// MersenneTest against the known exponents below 2500, and at 26003
+// and 44497, which use the IBDWT squarings
+
+long TestMersenne()
+{
+   static const long mexp[] = {
+      2, 3, 5, 7, 13, 17, 19, 31, 61, 89, 107, 127, 521, 607, 1279, 2203,
+      2281
+   };
+   const long nexp = sizeof(mexp)/sizeof(mexp[0]);
+
+   long j = 0;
+   for (long p = 2; p < 2500; p++) {
+      long expected = (j < nexp && p == mexp[j]);
+      if (expected) j++;
+      if (MersenneTest(p) != expected) {
+         cerr << "MersenneTest(" << p << ") wrong\n";
+         return 0;
+      }
+   }
+
+   if (MersenneTest(26003) != 0 || MersenneTest(44497) != 1) {
+      cerr << "MersenneTest wrong for large p\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+// ProthTest and LLRTest against ProbPrime, for k below and above 2^n
+
+long TestProthLLR()
+{
+   for (long k = 1; k < 64; k++)
+      for (long n = 0; n < 80; n++) {
+         ZZ N;
+         LeftShift(N, ZZ(k), n);
+
+         if (ProthTest(ZZ(k), n) != ProbPrime(N + 1)) {
+            cerr << "ProthTest(" << k << ", " << n << ") wrong\n";
+            return 0;
+         }
+
+         if (LLRTest(ZZ(k), n) != ProbPrime(N - 1)) {
+            cerr << "LLRTest(" << k << ", " << n << ") wrong\n";
+            return 0;
+         }
+      }
+
+   // larger n, for a few k
+   for (long i = 0; i < 200; i++) {
+      long k = 2*RandomBnd(500) + 1;
+      long n = 200 + RandomBnd(1000);
+      ZZ N;
+      LeftShift(N, ZZ(k), n);
+
+      if (ProthTest(ZZ(k), n) != ProbPrime(N + 1) ||
+          LLRTest(ZZ(k), n) != ProbPrime(N - 1)) {
+         cerr << "ProthTest/LLRTest(" << k << ", " << n << ") wrong\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = TestProthLLR() && TestMersenne();
+
+   if (ok) {
+      cerr << "SpecialPrimeTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "SpecialPrimeTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,90 @@
+
+#include <NTL/ZZ.h>
+#include <NTL/BasicThreadPool.h>
+
+NTL_CLIENT
+
+
+// 1 if n has a prime factor p < bnd with p != n
+
+long RefTrialDivision(const ZZ& n, long bnd)
+{
+   PrimeSeq s;
+   long p;
+   while ((p = s.next()) && p < bnd) {
+      if (n == p) return 0;
+      if (divide(n, p)) return 1;
+   }
+   return 0;
+}
+
+
+// the vector form of TrialDivision against the scalar form, and
+// both against plain trial division
+
+long Check(long bnd)
+{
+   Vec<ZZ> n;
+
+   // primes, random numbers and multiples of small numbers, with a
+   // few of 8192 bits or more
+   for (long i = 0; i < 300; i++) {
+      ZZ t;
+      long l = 2 + RandomBnd(300);
+      if (i % 3 == 0) {
+         GenPrime(t, l);
+      }
+      else {
+         RandomLen(t, i < 290 ? l : 8192 + l);
+         if (i % 3 == 2) mul(t, t, RandomBnd(bnd));
+      }
+      append(n, t);
+   }
+
+   // the primes below bnd themselves
+   PrimeSeq s;
+   long p;
+   while ((p = s.next()) && p < bnd)
+      if (RandomBnd(50) == 0) append(n, ZZ(p));
+
+   Vec<long> res;
+   TrialDivision(res, n, bnd);
+   if (res.length() != n.length()) {
+      cerr << "TrialDivision(Vec): wrong length\n";
+      return 0;
+   }
+
+   for (long i = 0; i < n.length(); i++) {
+      long t = RefTrialDivision(n[i], bnd);
+      if (res[i] != t || TrialDivision(n[i], bnd) != t) {
+         cerr << "TrialDivision wrong at " << i << ", bnd = " << bnd << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+long Test(long nthreads)
+{
+   SetNumThreads(nthreads);
+   SetSeed(ZZ(nthreads));
+
+   return Check(100) && Check(5000) && Check(70000);
+}
+
+
+int main()
+{
+   long ok = Test(1) && Test(4);
+
+   if (ok) {
+      cerr << "TrialDivisionTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "TrialDivisionTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,89 @@
+
+#include <NTL/ZZ.h>
+
+NTL_CLIENT
+
+
+// quotients and remainders of numbers of la+lb limbs by numbers of
+// lb limbs:  c = a*b + r0, with 0 <= r0 < b, gives q = a and r = r0
+
+long Check(long la, long lb)
+{
+   ZZ a, b, c, c1, q, r, r0;
+
+   RandomLen(a, la*NTL_ZZ_NBITS);
+   RandomLen(b, lb*NTL_ZZ_NBITS);
+   RandomBnd(r0, b);
+   mul(c, a, b);
+   add(c, c, r0);
+
+   DivRem(q, r, c, b);
+   if (q != a || r != r0) {
+      cerr << "DivRem wrong: " << la+lb << " / " << lb << " limbs\n";
+      return 0;
+   }
+
+   div(q, c, b);
+   rem(r, c, b);
+   if (q != a || r != r0) {
+      cerr << "div/rem wrong: " << la+lb << " / " << lb << " limbs\n";
+      return 0;
+   }
+
+   // the same, with floor rounding for a negative divisor
+   NTL::negate(b, b);
+   DivRem(q, r, c, b);
+   mul(c1, q, b);
+   add(c1, c1, r);
+   if (c1 != c || sign(r) > 0 || r <= b) {
+      cerr << "DivRem wrong with negative divisor: " << la+lb << " / "
+           << lb << " limbs\n";
+      return 0;
+   }
+
+   // and for a negative dividend
+   NTL::negate(c, c);
+   DivRem(q, r, c, b);
+   mul(c1, q, b);
+   add(c1, c1, r);
+   if (c1 != c || sign(r) > 0 || r <= b) {
+      cerr << "DivRem wrong with negative operands: " << la+lb << " / "
+           << lb << " limbs\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   // across the thresholds of divide-and-conquer and Newton division,
+   // for quotients shorter and longer than the divisor
+   static const long len[] =
+      { 1, 2, 5, 20, 33, 65, 150, 400, 1100, 2100, 3000 };
+   const long nlen = sizeof(len)/sizeof(len[0]);
+
+   long ok = 1;
+
+   for (long i = 0; ok && i < nlen; i++)
+      for (long j = 0; ok && j < nlen; j++) {
+         // keep the largest cases few
+         if (len[i] + len[j] > 4000 && (i + j) % 3 != 0) continue;
+         ok = Check(len[i], len[j]);
+      }
+
+   for (long i = 0; ok && i < 50; i++)
+      ok = Check(RandomBnd(3000) + 1, RandomBnd(3000) + 1);
+
+   if (ok) {
+      cerr << "ZZDivTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "ZZDivTest BAD\n";
+      return 1;
+   }
+}
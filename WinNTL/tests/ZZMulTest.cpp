@@ -0,0 +1,107 @@
+
+#include <NTL/ZZ.h>
+
+NTL_CLIENT
+
+
+// a*b as a sum of shifted products of a by 30-bit pieces of |b|;
+// this only uses single-limb multiplication
+
+void RefMul(ZZ& c, const ZZ& a, const ZZ& b)
+{
+   ZZ acc, t;
+   long n = NumBits(b);
+
+   for (long i = 0; i < n; i += 30) {
+      long d = 0;
+      for (long j = min(n, i+30) - 1; j >= i; j--)
+         d = 2*d + bit(b, j);
+
+      mul(t, a, d);
+      LeftShift(t, t, i);
+      add(acc, acc, t);
+   }
+
+   if (sign(b) < 0) NTL::negate(acc, acc);
+   c = acc;
+}
+
+
+void RandomSigned(ZZ& a, long l)
+{
+   RandomLen(a, l);
+   if (RandomBnd(2)) NTL::negate(a, a);
+}
+
+
+// products and squares of numbers of la and lb limbs
+
+long Check(long la, long lb)
+{
+   ZZ a, b, c, c1;
+
+   RandomSigned(a, la*NTL_ZZ_NBITS);
+   RandomSigned(b, lb*NTL_ZZ_NBITS);
+
+   RefMul(c1, a, b);
+
+   mul(c, a, b);
+   if (c != c1) {
+      cerr << "mul wrong: " << la << " x " << lb << " limbs\n";
+      return 0;
+   }
+
+   mul(c, b, a);
+   if (c != c1) {
+      cerr << "mul wrong: " << lb << " x " << la << " limbs\n";
+      return 0;
+   }
+
+   c = a;
+   mul(c, c, b);
+   if (c != c1) {
+      cerr << "mul wrong with aliasing: " << la << " x " << lb << " limbs\n";
+      return 0;
+   }
+
+   RefMul(c1, a, a);
+   sqr(c, a);
+   if (c != c1) {
+      cerr << "sqr wrong: " << la << " limbs\n";
+      return 0;
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   // across the Karatsuba, Toom-3, Toom-4 and FFT thresholds
+   static const long len[] =
+      { 1, 2, 5, 17, 33, 65, 150, 170, 200, 390, 460, 1100, 1600, 2500 };
+   const long nlen = sizeof(len)/sizeof(len[0]);
+
+   long ok = 1;
+
+   for (long i = 0; ok && i < nlen; i++)
+      for (long j = 0; ok && j <= i; j++) {
+         // keep the largest unbalanced cases few
+         if (len[i] >= 1100 && j < i - 2 && j % 3 != 0) continue;
+         ok = Check(len[i], len[j]);
+      }
+
+   for (long i = 0; ok && i < 50; i++)
+      ok = Check(RandomBnd(3000) + 1, RandomBnd(3000) + 1);
+
+   if (ok) {
+      cerr << "ZZMulTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "ZZMulTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,138 @@
+
+#include <NTL/ZZ.h>
+
+NTL_CLIENT
+
+
+// a modulus of l bits, odd, even, or of the form k*2^m + c
+
+void RandomModulus(ZZ& n, long l, long kind)
+{
+   switch (kind) {
+   case 0:
+      RandomLen(n, l);
+      SetBit(n, 0);
+      break;
+
+   case 1:
+      RandomLen(n, l);
+      SetBit(n, 1);
+      mul(n, n, 1L << RandomBnd(10));
+      if (IsOdd(n)) add(n, n, 1);
+      break;
+
+   default:
+      // k*2^m + c, with small k and c
+      power2(n, l);
+      mul(n, n, RandomBnd(100) + 1);
+      add(n, n, RandomBnd(2001) - 1000);
+      break;
+   }
+
+   if (n < 2) conv(n, 3);
+}
+
+
+// ZZReducer against MulMod, SqrMod and rem, and its Montgomery and
+// preferred-form arithmetic against a chain of plain MulMods
+
+long Check(long l, long kind)
+{
+   ZZ n;
+   RandomModulus(n, l, kind);
+
+   ZZReducer red(n);
+
+   if (red.modulus() != n || red.montgomery() != IsOdd(n)) {
+      cerr << "ZZReducer: wrong modulus data, n = " << n << "\n";
+      return 0;
+   }
+
+   for (long j = 0; j < 10; j++) {
+      ZZ a, b, x, x1;
+
+      RandomBnd(a, n);
+      RandomBnd(b, n);
+
+      MulMod(x, a, b, red);
+      MulMod(x1, a, b, n);
+      if (x != x1) {
+         cerr << "ZZReducer::MulMod wrong: n = " << n << "\n";
+         return 0;
+      }
+
+      SqrMod(x, a, red);
+      SqrMod(x1, a, n);
+      if (x != x1) {
+         cerr << "ZZReducer::SqrMod wrong: n = " << n << "\n";
+         return 0;
+      }
+
+      // reduction of numbers of up to twice the length of n, and of
+      // negative numbers
+      RandomLen(x, 1 + RandomBnd(2*NumBits(n)));
+      if (j & 1) NTL::negate(x, x);
+      rem(x1, x, n);
+      rem(x, x, red);
+      if (x != x1) {
+         cerr << "ZZReducer::rem wrong: n = " << n << "\n";
+         return 0;
+      }
+
+      // a^2 * b in the reducer's preferred form
+      ZZ ra, rb, r;
+      red.ToRep(ra, a);
+      red.ToRep(rb, b);
+      red.sqr(r, ra);
+      red.mul(r, r, rb);
+      red.FromRep(x, r);
+
+      SqrMod(x1, a, n);
+      MulMod(x1, x1, b, n);
+      if (x != x1) {
+         cerr << "ZZReducer ToRep/mul/sqr/FromRep wrong: n = " << n << "\n";
+         return 0;
+      }
+
+      if (!IsOdd(n)) continue;
+
+      // a^5 * b in Montgomery form
+      ZZ ma, mb, m;
+      red.ToMont(ma, a);
+      red.ToMont(mb, b);
+      red.SqrMont(m, ma);
+      red.SqrMont(m, m);
+      red.MulMont(m, m, ma);
+      red.MulMont(m, m, mb);
+      red.FromMont(x, m);
+
+      PowerMod(x1, a, 5, n);
+      MulMod(x1, x1, b, n);
+      if (x != x1) {
+         cerr << "ZZReducer Montgomery arithmetic wrong: n = " << n << "\n";
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = 1;
+
+   for (long i = 0; ok && i < 300; i++)
+      ok = Check(2 + RandomBnd(i < 250 ? 1000 : 5000), i % 3);
+
+   if (ok) {
+      cerr << "ZZReducerTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "ZZReducerTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,225 @@
+
+#include <NTL/ZZ_pFixed.h>
+#include <NTL/ZZ_pX.h>
+
+NTL_CLIENT
+
+
+// ZZ_pFixed<N> against ZZ_p, for an odd modulus of l bits,
+// l <= N*NTL_BITS_PER_LONG
+
+template<long N>
+long Check(long l)
+{
+   typedef ZZ_pFixed<N> F;
+
+   ZZ p;
+   RandomLen(p, l);
+   SetBit(p, 0);
+   if (p < 3) conv(p, 3);
+
+   // for inv and div, p is prime half the time
+   if (l > 2 && RandomBnd(2)) GenPrime(p, l);
+
+   ZZ_p::init(p);
+   F::init(p);
+
+   if (F::modulus() != p) {
+      cerr << "ZZ_pFixed<" << N << ">::modulus wrong\n";
+      return 0;
+   }
+
+   for (long i = 0; i < 100; i++) {
+      ZZ_p a, b, c, x;
+      random(a);
+      random(b);
+
+      // values near p stress the final subtractions
+      if (i % 10 == 0) conv(a, p - 1 - RandomBnd(3));
+      if (i % 10 == 1) conv(b, p - 1);
+
+      F fa(a), fb(b), fx;
+
+      conv(c, fa);
+      if (c != a || rep(fa) != rep(a)) {
+         cerr << "ZZ_pFixed<" << N << "> conv wrong, p = " << p << "\n";
+         return 0;
+      }
+
+      add(x, a, b); conv(c, fa + fb);
+      if (c != x) { cerr << "ZZ_pFixed add wrong\n"; return 0; }
+
+      sub(x, a, b); conv(c, fa - fb);
+      if (c != x) { cerr << "ZZ_pFixed sub wrong\n"; return 0; }
+
+      NTL::negate(x, a); conv(c, -fa);
+      if (c != x) { cerr << "ZZ_pFixed negate wrong\n"; return 0; }
+
+      mul(x, a, b); conv(c, fa * fb);
+      if (c != x) { cerr << "ZZ_pFixed mul wrong\n"; return 0; }
+
+      sqr(x, a); conv(c, sqr(fa));
+      if (c != x) { cerr << "ZZ_pFixed sqr wrong\n"; return 0; }
+
+      fx = fa;
+      fx *= fb;
+      fx *= fx;
+      mul(x, a, b); sqr(x, x); conv(c, fx);
+      if (c != x) { cerr << "ZZ_pFixed mul with aliasing wrong\n"; return 0; }
+
+      ZZ e;
+      RandomLen(e, 1 + RandomBnd(2*l));
+      power(x, a, e); conv(c, power(fa, e));
+      if (c != x) { cerr << "ZZ_pFixed power wrong\n"; return 0; }
+
+      long s = RandomBnd(1000);
+      power(x, a, s); conv(c, power(fa, s));
+      if (c != x) { cerr << "ZZ_pFixed power by long wrong\n"; return 0; }
+
+      if (GCD(rep(b), p) == 1) {
+         inv(x, b); conv(c, inv(fb));
+         if (c != x) { cerr << "ZZ_pFixed inv wrong\n"; return 0; }
+
+         div(x, a, b); conv(c, fa / fb);
+         if (c != x) { cerr << "ZZ_pFixed div wrong\n"; return 0; }
+      }
+
+      // conversion from integers of either sign and of any size
+      ZZ z;
+      RandomLen(z, 1 + RandomBnd(3*l));
+      if (RandomBnd(2)) NTL::negate(z, z);
+      fx = z; conv(c, fx);
+      if (c != conv<ZZ_p>(z)) {
+         cerr << "ZZ_pFixed conv from ZZ wrong\n";
+         return 0;
+      }
+
+      fx = -s; conv(c, fx);
+      if (c != conv<ZZ_p>(-s)) {
+         cerr << "ZZ_pFixed conv from long wrong\n";
+         return 0;
+      }
+
+      set(fx);
+      if (!IsOne(fx) || IsZero(fx) || rep(fx) != 1 || IsOne(fa) != IsOne(a) ||
+          IsZero(fa) != IsZero(a)) {
+         cerr << "ZZ_pFixed set/IsOne/IsZero wrong\n";
+         return 0;
+      }
+
+      if ((fa == fb) != (a == b) || (fa != fa)) {
+         cerr << "ZZ_pFixed comparison wrong\n";
+         return 0;
+      }
+   }
+
+   // vectors and polynomials, against vec_ZZ_p and ZZ_pX
+   long n = 1 + RandomBnd(60);
+   vec_ZZ_p a, b;
+   random(a, n);
+   random(b, n + RandomBnd(3));
+
+   Vec<F> fa, fb, fx;
+   conv(fa, a);
+   conv(fb, b);
+
+   ZZ_p t, t1;
+   F ft;
+   InnerProduct(t, a, b);
+   InnerProduct(ft, fa, fb);
+   conv(t1, ft);
+   if (t1 != t) {
+      cerr << "ZZ_pFixed InnerProduct wrong\n";
+      return 0;
+   }
+
+   ZZ_pX f, g, h;
+   conv(f, a);
+   conv(g, b);
+
+   random(t);
+   eval(t1, f, t);
+   eval(ft, fa, F(t));
+   if (rep(ft) != rep(t1)) {
+      cerr << "ZZ_pFixed eval wrong\n";
+      return 0;
+   }
+
+   mul(h, f, g);
+   PlainMul(fx, fa, fb);
+   vec_ZZ_p y;
+   conv(y, fx);
+   if (y.length() != n + b.length() - 1) {
+      cerr << "ZZ_pFixed PlainMul length wrong\n";
+      return 0;
+   }
+   for (long i = 0; i < y.length(); i++)
+      if (y[i] != coeff(h, i)) {
+         cerr << "ZZ_pFixed PlainMul wrong\n";
+         return 0;
+      }
+
+   return 1;
+}
+
+
+// ZZ_pFixedContext saves and restores the modulus
+
+long CheckContext()
+{
+   ZZ p, q;
+   GenPrime(p, 100);
+   GenPrime(q, 120);
+
+   ZZ_pFixed<2>::init(p);
+   ZZ_pFixedContext<2> cp;
+   cp.save();
+
+   ZZ_pFixedContext<2> cq(q);
+   cq.restore();
+   if (ZZ_pFixed<2>::modulus() != q) return 0;
+
+   ZZ_pFixed<2> x(-1L);
+   if (rep(x) != q - 1) return 0;
+
+   cp.restore();
+   if (ZZ_pFixed<2>::modulus() != p) return 0;
+
+   x = -1;
+   if (rep(x) != p - 1) return 0;
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = 1;
+
+   // moduli of every length, including full-width ones
+   for (long l = 2; ok && l <= NTL_BITS_PER_LONG; l++)
+      ok = Check<1>(l);
+
+   for (long i = 0; ok && i < 30; i++) {
+      ok = ok && Check<2>(i < 5 ? 2*NTL_BITS_PER_LONG - i :
+                          2 + RandomBnd(2*NTL_BITS_PER_LONG - 1));
+      ok = ok && Check<4>(i < 5 ? 4*NTL_BITS_PER_LONG - i :
+                          2 + RandomBnd(4*NTL_BITS_PER_LONG - 1));
+   }
+
+   if (ok && !CheckContext()) {
+      cerr << "ZZ_pFixedContext wrong\n";
+      ok = 0;
+   }
+
+   if (ok) {
+      cerr << "ZZ_pFixedTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "ZZ_pFixedTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,162 @@
+
+#include <NTL/ZZ_pMont.h>
+
+NTL_CLIENT
+
+
+// each ZZ_pMont operation against the same operation on ZZ_p, for
+// an odd modulus of l bits
+
+long Check(long l)
+{
+   ZZ p;
+   RandomLen(p, l);
+   SetBit(p, 0);
+   if (p < 3) conv(p, 3);
+
+   // for inv and div, p is prime half the time
+   if (l > 2 && l <= 1000 && RandomBnd(2)) GenPrime(p, l);
+
+   ZZ_p::init(p);
+
+   for (long i = 0; i < 50; i++) {
+      ZZ_p a, b, c, x;
+      random(a);
+      random(b);
+      long s = RandomBnd(2000) - 1000;
+
+      ZZ_pMont ma(a), mb(b), mx;
+
+      conv(c, ma);
+      if (c != a || rep(ma) != rep(a)) {
+         cerr << "ZZ_pMont conv wrong, p = " << p << "\n";
+         return 0;
+      }
+
+      add(x, a, b); conv(c, ma + mb);
+      if (c != x) { cerr << "ZZ_pMont add wrong\n"; return 0; }
+
+      sub(x, a, b); conv(c, ma - mb);
+      if (c != x) { cerr << "ZZ_pMont sub wrong\n"; return 0; }
+
+      NTL::negate(x, a); conv(c, -ma);
+      if (c != x) { cerr << "ZZ_pMont negate wrong\n"; return 0; }
+
+      mul(x, a, b); conv(c, ma * mb);
+      if (c != x) { cerr << "ZZ_pMont mul wrong\n"; return 0; }
+
+      mul(x, a, s); conv(c, ma * s);
+      if (c != x) { cerr << "ZZ_pMont mul by long wrong\n"; return 0; }
+
+      sqr(x, a); conv(c, sqr(ma));
+      if (c != x) { cerr << "ZZ_pMont sqr wrong\n"; return 0; }
+
+      mx = ma;
+      mx *= mb;
+      mx *= mx;
+      mul(x, a, b); sqr(x, x); conv(c, mx);
+      if (c != x) { cerr << "ZZ_pMont mul with aliasing wrong\n"; return 0; }
+
+      ZZ e;
+      RandomLen(e, 1 + RandomBnd(2*l));
+      power(x, a, e); conv(c, power(ma, e));
+      if (c != x) { cerr << "ZZ_pMont power wrong\n"; return 0; }
+
+      power(x, a, s + 1000); conv(c, power(ma, s + 1000));
+      if (c != x) { cerr << "ZZ_pMont power by long wrong\n"; return 0; }
+
+      if (GCD(rep(b), p) == 1) {
+         inv(x, b); conv(c, inv(mb));
+         if (c != x) { cerr << "ZZ_pMont inv wrong\n"; return 0; }
+
+         div(x, a, b); conv(c, ma / mb);
+         if (c != x) { cerr << "ZZ_pMont div wrong\n"; return 0; }
+
+         NTL::negate(e, e);
+         power(x, b, e); conv(c, power(mb, e));
+         if (c != x) { cerr << "ZZ_pMont negative power wrong\n"; return 0; }
+      }
+
+      // conversion from integers of either sign and of any size
+      ZZ z;
+      RandomLen(z, 1 + RandomBnd(3*l));
+      if (RandomBnd(2)) NTL::negate(z, z);
+      conv(mx, z); conv(c, mx);
+      if (c != conv<ZZ_p>(z)) {
+         cerr << "ZZ_pMont conv from ZZ wrong\n";
+         return 0;
+      }
+
+      conv(mx, s); conv(c, mx);
+      if (c != conv<ZZ_p>(s)) {
+         cerr << "ZZ_pMont conv from long wrong\n";
+         return 0;
+      }
+
+      set(mx);
+      if (!IsOne(mx) || IsZero(mx) || rep(mx) != 1 || IsOne(ma) != IsOne(a)) {
+         cerr << "ZZ_pMont set/IsOne wrong\n";
+         return 0;
+      }
+
+      if ((ma == mb) != (a == b) || (ma != ma)) {
+         cerr << "ZZ_pMont comparison wrong\n";
+         return 0;
+      }
+   }
+
+   // vectors, and InnerProduct with its single reduction
+   long n = 1 + RandomBnd(300);
+   vec_ZZ_p a, b, x;
+   random(a, n);
+   random(b, n + RandomBnd(3));
+
+   vec_ZZ_pMont ma, mb, mx;
+   conv(ma, a);
+   conv(mb, b);
+
+   ZZ_p t, t1;
+   ZZ_pMont mt;
+   InnerProduct(t, a, b);
+   InnerProduct(mt, ma, mb);
+   conv(t1, mt);
+   if (t1 != t) {
+      cerr << "ZZ_pMont InnerProduct wrong, n = " << n << "\n";
+      return 0;
+   }
+
+   b.SetLength(n);
+   mb.SetLength(n);
+   add(x, a, b); add(mx, ma, mb);
+   vec_ZZ_p y;
+   conv(y, mx);
+   if (y != x) { cerr << "vec_ZZ_pMont add wrong\n"; return 0; }
+
+   sub(x, a, b); sub(mx, ma, mb); conv(y, mx);
+   if (y != x) { cerr << "vec_ZZ_pMont sub wrong\n"; return 0; }
+
+   mul(x, a, b[0]); mul(mx, ma, mb[0]); conv(y, mx);
+   if (y != x) { cerr << "vec_ZZ_pMont mul wrong\n"; return 0; }
+
+   return 1;
+}
+
+
+int main()
+{
+   SetSeed(ZZ(1));
+
+   long ok = 1;
+
+   for (long i = 0; ok && i < 40; i++)
+      ok = Check(2 + RandomBnd(i < 30 ? 300 : 3000));
+
+   if (ok) {
+      cerr << "ZZ_pMontTest OK\n";
+      return 0;
+   }
+   else {
+      cerr << "ZZ_pMontTest BAD\n";
+      return 1;
+   }
+}
@@ -0,0 +1,20 @@
+# primebatch のスモークテスト
+#
+#   cmake -DPRIMEBATCH=<primebatch> -DINPUT=<入力> -DEXPECTED=<期待値> -P PrimeBatchTest.cmake
+#
+# 各行の「行番号・判定」を期待値と比べる（所要時間の列は比べない）。
+# スレッド数とバッチサイズを変えて2回実行し、結果が変わらないことも確かめる。
+
+foreach(args "-t;1;-b;4096" "-t;4;-b;3")
+	execute_process(COMMAND ${PRIMEBATCH} ${args} ${INPUT}
+		OUTPUT_VARIABLE out RESULT_VARIABLE rc)
+	if(NOT rc EQUAL 0)
+		message(FATAL_ERROR "primebatch ${args} failed: ${rc}")
+	endif()
+
+	string(REGEX REPLACE "\t[^\t\n]*\n" "\n" got "${out}")
+	file(READ ${EXPECTED} want)
+	if(NOT got STREQUAL want)
+		message(FATAL_ERROR "primebatch ${args}: got\n${got}expected\n${want}")
+	endif()
+endforeach()